@@ -0,0 +1,1137 @@
+// DigitalFiltersBenchmarks.cpp
+//
+// Google Benchmark suite: every IIR:: designer (exact, Fast, batch, cascade
+// and SOS), the Eval:: evaluators (single point and span) and the
+// IIRfreqResponse batch APIs from 1 point up to --max_points with OpenMP
+// thread scaling.
+//
+// Every benchmark reports
+//   ns/point   time per evaluated point (or designed filter)
+//   points/s   throughput
+//   bytes/s    input plus output bytes touched per second
+//
+// JSON output for diffing runs:
+//   DigitalFiltersBenchmarks --benchmark_out=run.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <span>
+#include <array>
+#include <random>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <complex>
+#include <type_traits>
+#include <utility>
+#include <filesystem>
+
+#include "Biquad.h"
+#include "Utils.h"
+#include "Evaluator.h"
+#include "IIRDesign.h"
+#include "IIRDesignFast.h"
+#include "IIRBatchDesign.h"
+#include "IIRSosDesign.h"
+#include "IIREqFit.h"
+#include "IIRDesignCache.h"
+#include "IIRJacobian.h"
+#include "BiquadBank.h"
+#include "BiquadStability.h"
+#include "BiquadCascade.h"
+#include "IIRParallelForm.h"
+#include "IIREqBank.h"
+#include "IIRCrossover.h"
+#include "Multirate.h"
+#include "GoertzelBank.h"
+#include "IIRfreqResponse.h"
+#include "Datasets.h"
+#include "Parallel.h"
+#include "ResponseTable.h"
+#include "FilterBankFile.h"
+
+using namespace DigitalFilters;
+
+namespace
+{
+	constexpr double Fs = 48000.0;
+	constexpr size_t ParameterCount = 1024;
+	constexpr int FilterTypes = static_cast<int>(IIR::FilterType::PeakEq) + 1;
+
+	size_t maxPoints = DIGITALFILTERS_BENCH_MAX_POINTS;
+
+	const char* const typeNames[FilterTypes] = {
+		"AllPass1stOrder", "AllPassQ", "BandPass", "HighPass", "HighPass12dbOct",
+		"HighPass1stOrder", "HighShelf", "HighShelf1stOrder", "HighShelfQ", "LowPass",
+		"LowPass12dbOct", "LowPass1stOrder", "LowShelf", "LowShelf1stOrder", "LowShelfQ",
+		"Notch", "OnePoleHighPass", "OnePoleLowPass", "PeakEq" };
+
+	struct DesignParameters
+	{
+		std::vector<double> gain, Fc, Q, Fs;
+	};
+
+	// Fixed seed, so every run designs the same filters.
+	const DesignParameters& Parameters( size_t count = ParameterCount )
+	{
+		static std::vector<DesignParameters> cache;
+		for (const DesignParameters& parameters : cache)
+		{
+			if (parameters.Fc.size() == count) return parameters;
+		}
+
+		std::mt19937 generator( 1234 );
+		std::uniform_real_distribution<double> gain( -24.0, 24.0 );
+		std::uniform_real_distribution<double> logFc( std::log( 20.0 ), std::log( 20000.0 ) );
+		std::uniform_real_distribution<double> Q( 0.3, 8.0 );
+
+		DesignParameters parameters;
+		for (size_t i = 0; i < count; i++)
+		{
+			parameters.gain.push_back( gain( generator ) );
+			parameters.Fc.push_back( std::exp( logFc( generator ) ) );
+			parameters.Q.push_back( Q( generator ) );
+			parameters.Fs.push_back( Fs );
+		}
+
+		cache.push_back( std::move( parameters ) );
+		return cache.back();
+	}
+
+	// Log spaced frequencies in (0, Fs / 2), generated in parallel.
+	std::vector<double> Frequencies( size_t count )
+	{
+		return Datasets::Generate<double>( Datasets::LogSweep( count, 10.0, 0.49 * Fs ) );
+	}
+
+	std::vector<double> Omegas( size_t count )
+	{
+		std::vector<double> omegas = Frequencies( count );
+		for (double& omega : omegas)
+		{
+			omega = Utils::HzToOmega( omega ) / Fs;
+		}
+		return omegas;
+	}
+
+	void SetPointCounters( benchmark::State& state, double points, double bytesPerPoint )
+	{
+		using benchmark::Counter;
+		state.counters["points/s"] = Counter( points, Counter::kIsIterationInvariantRate );
+		state.counters["ns/point"] = Counter( points * 1e-9,
+			Counter::kIsIterationInvariantRate | Counter::kInvert );
+		state.counters["bytes/s"] = Counter( points * bytesPerPoint,
+			Counter::kIsIterationInvariantRate, Counter::kIs1024 );
+	}
+
+	Biquad<double> FastDesign( IIR::FilterType type, double peakGain, double Fc, double Q, double fs )
+	{
+		using IIR::FilterType;
+		namespace F = IIR::Fast;
+
+		switch (type)
+		{
+		case FilterType::AllPass1stOrder:   return F::AllPass1stOrder( Fc, fs );
+		case FilterType::AllPassQ:          return F::AllPassQ( Fc, Q, fs );
+		case FilterType::BandPass:          return F::BandPass( Fc, Q, fs );
+		case FilterType::HighPass:          return F::HighPass( Fc, Q, fs );
+		case FilterType::HighPass12dbOct:   return F::HighPass12dbOct( Fc, fs );
+		case FilterType::HighPass1stOrder:  return F::HighPass1stOrder( Fc, fs );
+		case FilterType::HighShelf:         return F::HighShelf( peakGain, Fc, fs );
+		case FilterType::HighShelf1stOrder: return F::HighShelf1stOrder( peakGain, Fc, fs );
+		case FilterType::HighShelfQ:        return F::HighShelfQ( peakGain, Fc, Q, fs );
+		case FilterType::LowPass:           return F::LowPass( Fc, Q, fs );
+		case FilterType::LowPass12dbOct:    return F::LowPass12dbOct( Fc, fs );
+		case FilterType::LowPass1stOrder:   return F::LowPass1stOrder( Fc, fs );
+		case FilterType::LowShelf:          return F::LowShelf( peakGain, Fc, fs );
+		case FilterType::LowShelf1stOrder:  return F::LowShelf1stOrder( peakGain, Fc, fs );
+		case FilterType::LowShelfQ:         return F::LowShelfQ( peakGain, Fc, Q, fs );
+		case FilterType::Notch:             return F::Notch( Fc, Q, fs );
+		case FilterType::OnePoleHighPass:   return F::OnePoleHighPass( Fc, fs );
+		case FilterType::OnePoleLowPass:    return F::OnePoleLowPass( Fc, fs );
+		default:                            return F::PeakEq( peakGain, Fc, Q, fs );
+		}
+	}
+
+	// Inputs (gain, Fc, Q) and the five stored coefficients.
+	constexpr double DesignBytes = 8 * sizeof( double );
+
+	// ------------------------------------------------------------------
+	// Designers
+
+	void BM_Design( benchmark::State& state )
+	{
+		const auto type = static_cast<IIR::FilterType>(state.range( 0 ));
+		const DesignParameters& p = Parameters();
+		state.SetLabel( typeNames[state.range( 0 )] );
+
+		for (auto _ : state)
+		{
+			for (size_t i = 0; i < ParameterCount; i++)
+			{
+				benchmark::DoNotOptimize( IIR::Design( type, p.gain[i], p.Fc[i], p.Q[i], Fs ) );
+			}
+		}
+
+		SetPointCounters( state, ParameterCount, DesignBytes );
+	}
+
+	void BM_DesignFast( benchmark::State& state )
+	{
+		const auto type = static_cast<IIR::FilterType>(state.range( 0 ));
+		const DesignParameters& p = Parameters();
+		state.SetLabel( typeNames[state.range( 0 )] );
+
+		for (auto _ : state)
+		{
+			for (size_t i = 0; i < ParameterCount; i++)
+			{
+				benchmark::DoNotOptimize( FastDesign( type, p.gain[i], p.Fc[i], p.Q[i], Fs ) );
+			}
+		}
+
+		SetPointCounters( state, ParameterCount, DesignBytes );
+	}
+
+	void BM_DesignCacheHit( benchmark::State& state )
+	{
+		const DesignParameters& p = Parameters();
+		IIR::DesignCache<double> cache;
+		for (size_t i = 0; i < ParameterCount; i++)
+		{
+			cache.Design( IIR::FilterType::PeakEq, p.gain[i], p.Fc[i], p.Q[i], Fs );
+		}
+
+		for (auto _ : state)
+		{
+			for (size_t i = 0; i < ParameterCount; i++)
+			{
+				benchmark::DoNotOptimize( cache.Design( IIR::FilterType::PeakEq, p.gain[i], p.Fc[i], p.Q[i], Fs ) );
+			}
+		}
+
+		SetPointCounters( state, ParameterCount, DesignBytes );
+	}
+
+	const char* const batchNames[] = {
+		"PeakEqBatch", "HighShelfQBatch", "LowShelfQBatch", "LowPassBatch",
+		"HighPassBatch", "BandPassBatch", "NotchBatch", "AllPassQBatch" };
+
+	// The scalar IIR:: designers looped over the parameters of BM_DesignBatch,
+	// storing into the same structure of arrays: the baseline of the batch
+	// designers.
+	void BM_DesignScalar( benchmark::State& state )
+	{
+		const int designer = static_cast<int>(state.range( 0 ));
+		const size_t count = static_cast<size_t>(state.range( 1 ));
+		const DesignParameters& p = Parameters( count );
+		state.SetLabel( batchNames[designer] );
+
+		IIR::BiquadBank<double> bank( count );
+
+		for (auto _ : state)
+		{
+			const IIR::BiquadSpans<double> out = bank.Spans();
+			for (size_t i = 0; i < count; i++)
+			{
+				Biquad<double> biquad;
+				switch (designer)
+				{
+				case 0: biquad = IIR::PeakEq( p.gain[i], p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				case 1: biquad = IIR::HighShelfQ( p.gain[i], p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				case 2: biquad = IIR::LowShelfQ( p.gain[i], p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				case 3: biquad = IIR::LowPass( p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				case 4: biquad = IIR::HighPass( p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				case 5: biquad = IIR::BandPass( p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				case 6: biquad = IIR::Notch( p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				default: biquad = IIR::AllPassQ( p.Fc[i], p.Q[i], p.Fs[i] ); break;
+				}
+				out.a0[i] = biquad.a0;
+				out.a1[i] = biquad.a1;
+				out.a2[i] = biquad.a2;
+				out.b1[i] = biquad.b1;
+				out.b2[i] = biquad.b2;
+			}
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, static_cast<double>(count), 9 * sizeof( double ) );
+	}
+
+	void BM_DesignBatch( benchmark::State& state )
+	{
+		const int designer = static_cast<int>(state.range( 0 ));
+		const size_t count = static_cast<size_t>(state.range( 1 ));
+		const DesignParameters& p = Parameters( count );
+		state.SetLabel( batchNames[designer] );
+
+		IIR::BiquadBank<double> bank( count );
+		const std::span<const double> gain( p.gain ), Fc( p.Fc ), Q( p.Q ), fs( p.Fs );
+
+		for (auto _ : state)
+		{
+			const IIR::BiquadSpans<double> out = bank.Spans();
+			switch (designer)
+			{
+			case 0: IIR::PeakEqBatch( gain, Fc, Q, fs, out ); break;
+			case 1: IIR::HighShelfQBatch( gain, Fc, Q, fs, out ); break;
+			case 2: IIR::LowShelfQBatch( gain, Fc, Q, fs, out ); break;
+			case 3: IIR::LowPassBatch( Fc, Q, fs, out ); break;
+			case 4: IIR::HighPassBatch( Fc, Q, fs, out ); break;
+			case 5: IIR::BandPassBatch( Fc, Q, fs, out ); break;
+			case 6: IIR::NotchBatch( Fc, Q, fs, out ); break;
+			default: IIR::AllPassQBatch( Fc, Q, fs, out ); break;
+			}
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, static_cast<double>(count), 9 * sizeof( double ) );
+	}
+
+	void BM_LowPassCascadeAsButterworth( benchmark::State& state )
+	{
+		const int order = static_cast<int>(state.range( 0 ));
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize( IIR::LowPassCascadeAsButterworth( order, 1000.0, Fs ) );
+		}
+		SetPointCounters( state, 1, (order + 1) / 2 * 5 * sizeof( double ) );
+	}
+
+	void BM_HighPassCascadeAsButterworth( benchmark::State& state )
+	{
+		const int order = static_cast<int>(state.range( 0 ));
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize( IIR::HighPassCascadeAsButterworth( order, 1000.0, Fs ) );
+		}
+		SetPointCounters( state, 1, (order + 1) / 2 * 5 * sizeof( double ) );
+	}
+
+	const char* const sosNames[] = { "Butterworth", "ChebyshevI", "ChebyshevII", "Elliptic" };
+
+	void BM_SosDesign( benchmark::State& state )
+	{
+		const int prototype = static_cast<int>(state.range( 0 ));
+		const int order = static_cast<int>(state.range( 1 ));
+		state.SetLabel( sosNames[prototype] );
+
+		for (auto _ : state)
+		{
+			switch (prototype)
+			{
+			case 0: benchmark::DoNotOptimize( IIR::ButterworthSos( IIR::SosBand::LowPass, order, 1000.0, Fs ) ); break;
+			case 1: benchmark::DoNotOptimize( IIR::ChebyshevISos( IIR::SosBand::LowPass, order, 1.0, 1000.0, Fs ) ); break;
+			case 2: benchmark::DoNotOptimize( IIR::ChebyshevIISos( IIR::SosBand::LowPass, order, 60.0, 1000.0, Fs ) ); break;
+			default: benchmark::DoNotOptimize( IIR::EllipticSos( IIR::SosBand::LowPass, order, 1.0, 60.0, 1000.0, Fs ) ); break;
+			}
+		}
+
+		SetPointCounters( state, 1, (order + 1) / 2 * 5 * sizeof( double ) );
+	}
+
+	// Fitting state.range( 0 ) bands to 1000 points of a smooth curve plus a
+	// random walk (in dB).
+	void BM_EqFit( benchmark::State& state )
+	{
+		const std::vector<double> frequencies = Datasets::Generate<double>( Datasets::LogSweep( 1000, 20.0, 20000.0 ) );
+		const std::vector<double> steps = Datasets::Generate<double>( Datasets::Gaussian( 5, frequencies.size(), 0.0, 0.5 ) );
+		std::vector<double> target( frequencies.size() );
+		double walk = 0;
+		for (size_t i = 0; i < target.size(); i++)
+		{
+			walk = 0.97 * walk + steps[i];
+			target[i] = walk + 3.0 * std::sin( static_cast<double>(i) / 60.0 );
+		}
+
+		IIR::EqFitOptions<double> options;
+		options.bands = static_cast<int>(state.range( 0 ));
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize( IIR::FitEq<double>( frequencies, target, options ) );
+		}
+
+		SetPointCounters( state, static_cast<double>(frequencies.size()), 2 * sizeof( double ) );
+	}
+
+	// ------------------------------------------------------------------
+	// Eval:: single point evaluators, ParameterCount points per iteration.
+
+	const Biquad<double> peak = IIR::PeakEq( 6.0, 1000.0, 1.0, Fs );
+
+	void BM_CalcFreqResponseTrigBiquad( benchmark::State& state )
+	{
+		const std::vector<double> omegas = Omegas( ParameterCount );
+		for (auto _ : state)
+		{
+			for (double omega : omegas)
+			{
+				benchmark::DoNotOptimize( Eval::CalcFreqResponseTrig( peak, omega ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	void BM_CalcFreqResponseBiquad( benchmark::State& state )
+	{
+		const std::vector<double> omegas = Omegas( ParameterCount );
+		for (auto _ : state)
+		{
+			for (double omega : omegas)
+			{
+				benchmark::DoNotOptimize( Eval::CalcFreqResponse( peak, omega ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	// Coefficient spans of state.range( 0 ) coefficients (order + 1).
+	struct Polynomials
+	{
+		std::vector<double> numerator, denominator;
+
+		explicit Polynomials( size_t count )
+		{
+			std::mt19937 generator( 99 );
+			std::uniform_real_distribution<double> value( -0.5, 0.5 );
+			for (size_t i = 0; i < count; i++)
+			{
+				numerator.push_back( value( generator ) );
+				denominator.push_back( i == 0 ? 1.0 : value( generator ) / (i + 1) );
+			}
+		}
+	};
+
+	void BM_CalcFreqResponseTrigSpan( benchmark::State& state )
+	{
+		const Polynomials polynomials( static_cast<size_t>(state.range( 0 )) );
+		const std::span<const double> numerator( polynomials.numerator ), denominator( polynomials.denominator );
+		const std::vector<double> omegas = Omegas( ParameterCount );
+
+		for (auto _ : state)
+		{
+			for (double omega : omegas)
+			{
+				benchmark::DoNotOptimize( Eval::CalcFreqResponseTrig( numerator, denominator, omega ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	void BM_CalcFreqResponseSpan( benchmark::State& state )
+	{
+		const Polynomials polynomials( static_cast<size_t>(state.range( 0 )) );
+		const std::span<const double> numerator( polynomials.numerator ), denominator( polynomials.denominator );
+		const std::vector<double> omegas = Omegas( ParameterCount );
+
+		for (auto _ : state)
+		{
+			for (double omega : omegas)
+			{
+				benchmark::DoNotOptimize( Eval::CalcFreqResponse( numerator, denominator, omega ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	void BM_EvalCoeffsBiquad( benchmark::State& state )
+	{
+		const Polynomials polynomials( static_cast<size_t>(state.range( 0 )) );
+		const std::span<const double> numerator( polynomials.numerator );
+		const std::vector<double> omegas = Omegas( ParameterCount );
+
+		for (auto _ : state)
+		{
+			for (double omega : omegas)
+			{
+				benchmark::DoNotOptimize( Eval::EvalCoeffsBiquad( numerator, omega ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	// ------------------------------------------------------------------
+	// Eval:: span evaluators
+
+	// |H| of state.range( 0 ) filters at one frequency.
+	template <typename T>
+	void BM_CalcMagnitudeResponse( benchmark::State& state )
+	{
+		const size_t count = static_cast<size_t>(state.range( 0 ));
+		const DesignParameters& p = Parameters( count );
+		IIR::BiquadBank<double> designed( count );
+		IIR::PeakEqBatch<double>( p.gain, p.Fc, p.Q, p.Fs, designed.Spans() );
+		const IIR::BiquadBank<T> bank( designed.ToBiquads() );
+		std::vector<T> magnitude( count );
+
+		for (auto _ : state)
+		{
+			Eval::CalcMagnitudeResponse( bank, T( 0.1 ), std::span<T>( magnitude ) );
+			benchmark::ClobberMemory();
+		}
+		SetPointCounters( state, static_cast<double>(count), 5 * sizeof( T ) + sizeof( T ) );
+	}
+
+	// The same kernel over a std::vector<Biquad<double>>, the array of
+	// structures BiquadBank replaces.
+	void BM_CalcMagnitudeResponseAoS( benchmark::State& state )
+	{
+		const size_t count = static_cast<size_t>(state.range( 0 ));
+		const DesignParameters& p = Parameters( count );
+		std::vector<Biquad<double>> biquads( count );
+		for (size_t i = 0; i < count; i++)
+		{
+			biquads[i] = IIR::PeakEq( p.gain[i], p.Fc[i], p.Q[i], p.Fs[i] );
+		}
+		std::vector<double> magnitude( count );
+		const double omega = 0.1;
+
+		for (auto _ : state)
+		{
+			const double c1 = std::cos( omega ), s1 = std::sin( omega );
+			const double c2 = std::cos( 2 * omega ), s2 = std::sin( 2 * omega );
+			for (size_t i = 0; i < count; i++)
+			{
+				const Biquad<double>& b = biquads[i];
+				const double nRe = b.a0 + b.a1 * c1 + b.a2 * c2, nIm = b.a1 * s1 + b.a2 * s2;
+				const double dRe = b.b0 + b.b1 * c1 + b.b2 * c2, dIm = b.b1 * s1 + b.b2 * s2;
+				magnitude[i] = std::sqrt( (nRe * nRe + nIm * nIm) / (dRe * dRe + dIm * dIm) );
+			}
+			benchmark::ClobberMemory();
+		}
+		SetPointCounters( state, static_cast<double>(count), sizeof( Biquad<double> ) + sizeof( double ) );
+	}
+
+	// Jacobian of state.range( 0 ) sections over state.range( 1 ) points.
+	void BM_CalcResponseJacobian( benchmark::State& state )
+	{
+		const size_t sections = static_cast<size_t>(state.range( 0 ));
+		const size_t points = static_cast<size_t>(state.range( 1 ));
+		const DesignParameters& p = Parameters();
+		std::vector<IIR::BiquadSensitivity<double>> sensitivities;
+		for (size_t i = 0; i < sections; i++)
+		{
+			sensitivities.push_back( IIR::DesignSensitivity( IIR::FilterType::PeakEq, p.gain[i], p.Fc[i], p.Q[i], Fs ) );
+		}
+		const std::vector<double> omegas = Omegas( points );
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize( Eval::CalcResponseJacobian(
+				std::span<const IIR::BiquadSensitivity<double>>( sensitivities ),
+				std::span<const double>( omegas ), Eval::MagnitudeScale::Decibels ) );
+		}
+
+		// Magnitude, phase and their 2 * 3 * sections derivatives per point.
+		SetPointCounters( state, static_cast<double>(points), (3 + 6 * sections) * sizeof( double ) );
+	}
+
+	// Stability triangle test of state.range( 0 ) random denominators.
+	void BM_CheckStability( benchmark::State& state )
+	{
+		const size_t count = static_cast<size_t>(state.range( 0 ));
+		const std::vector<double> b1 = Datasets::Generate<double>( Datasets::Uniform( 4, count, -2.0, 2.0 ) );
+		const std::vector<double> b2 = Datasets::Generate<double>( Datasets::Uniform( 5, count, -2.0, 2.0 ) );
+		std::vector<std::uint8_t> stable( count );
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize( CheckStability<double>( b1, b2, stable ) );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, static_cast<double>(count), 2 * sizeof( double ) + 1 );
+	}
+
+	// ------------------------------------------------------------------
+	// Processors, Frames samples of Gaussian noise per iteration.
+
+	constexpr size_t Frames = 4096;
+
+	std::vector<double> Noise( size_t count )
+	{
+		return Datasets::Generate<double>( Datasets::Gaussian( 9, count, 0.0, 1.0 ) );
+	}
+
+	// Butterworth low pass of order state.range( 0 ) as a cascade of
+	// sections, and the same filter in parallel form.
+	void BM_CascadeProcess( benchmark::State& state )
+	{
+		const int order = static_cast<int>(state.range( 0 ));
+		IIR::CascadeProcessor<double> processor( IIR::LowPassCascadeAsButterworth<double>( order, 4000.0, Fs ) );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> output( Frames );
+
+		for (auto _ : state)
+		{
+			processor.Process( input, output );
+			benchmark::DoNotOptimize( output.data() );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 2 * sizeof( double ) );
+	}
+
+	void BM_ParallelFormProcess( benchmark::State& state )
+	{
+		const int order = static_cast<int>(state.range( 0 ));
+		const auto cascade = IIR::LowPassCascadeAsButterworth<double>( order, 4000.0, Fs );
+		IIR::ParallelProcessor<double> processor( IIR::ToParallelForm<double>( cascade ) );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> output( Frames );
+
+		for (auto _ : state)
+		{
+			processor.Process( input, output );
+			benchmark::DoNotOptimize( output.data() );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 2 * sizeof( double ) );
+	}
+
+	std::vector<Biquad<double>> PeakEqSections( size_t count )
+	{
+		std::vector<Biquad<double>> sections;
+		for (size_t i = 0; i < count; i++)
+		{
+			sections.push_back( IIR::PeakEq( 3.0, 100.0 * static_cast<double>(i + 1), 2.0, Fs ) );
+		}
+		return sections;
+	}
+
+	// state.range( 0 ) PeakEq sections in a CascadeProcessor, and the same
+	// sections in a Cascade<double, N> (N = state.range( 0 )).
+	void BM_CascadeRuntime( benchmark::State& state )
+	{
+		IIR::CascadeProcessor<double> processor( PeakEqSections( static_cast<size_t>(state.range( 0 )) ) );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> output( Frames );
+
+		for (auto _ : state)
+		{
+			processor.Process( input, output );
+			benchmark::DoNotOptimize( output.data() );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 2 * sizeof( double ) );
+	}
+
+	template <size_t N>
+	void BM_CascadeFixed( benchmark::State& state )
+	{
+		IIR::Cascade<double, N> processor( PeakEqSections( N ) );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> output( Frames );
+
+		for (auto _ : state)
+		{
+			processor.Process( input, output );
+			benchmark::DoNotOptimize( output.data() );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 2 * sizeof( double ) );
+	}
+
+	// 31 band ISO graphic EQ on state.range( 0 ) channels, every
+	// state.range( 1 )'th band boosted or cut and the others flat (dropped
+	// from the chain). One point is one band on one channel for one frame
+	// (its two state values).
+	void BM_EqBankProcess( benchmark::State& state )
+	{
+		const size_t channels = static_cast<size_t>(state.range( 0 ));
+		const int activeEvery = static_cast<int>(state.range( 1 ));
+
+		std::vector<IIR::EqBandSettings<double>> bands;
+		for (int band = 0; band < 31; band++)
+		{
+			const double gain = band % activeEvery == 0 ? ((band * 7) % 13 - 6.0) : 0.0;
+			bands.push_back( { IIR::FilterType::PeakEq, gain, 20.0 * std::pow( 2.0, band / 3.0 ), 4.32, false } );
+		}
+		IIR::EqBankProcessor<double> processor( bands, Fs, channels );
+
+		std::vector<std::vector<double>> planar( channels, Noise( Frames ) );
+		std::vector<const double*> inputs;
+		std::vector<double*> outputs;
+		for (std::vector<double>& channel : planar)
+		{
+			inputs.push_back( channel.data() );
+			outputs.push_back( channel.data() );
+		}
+
+		for (auto _ : state)
+		{
+			processor.Process( inputs, outputs, Frames );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, static_cast<double>(Frames * channels * processor.ActiveBands()), 2 * sizeof( double ) );
+	}
+
+	// 8 band Linkwitz-Riley split of Frames samples: the crossover tree, and
+	// one full cascade per band (its LR4 low / high passes plus the allpass
+	// compensation of the other crossovers).
+	const std::vector<double> crossoverFrequencies{ 60.0, 120.0, 250.0, 500.0, 1000.0, 4000.0, 12000.0 };
+
+	void BM_CrossoverTree( benchmark::State& state )
+	{
+		IIR::LinkwitzRileyCrossover<double> crossover( crossoverFrequencies, Fs );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<std::vector<double>> bands( crossoverFrequencies.size() + 1, std::vector<double>( Frames ) );
+		const std::vector<std::span<double>> outputs( bands.begin(), bands.end() );
+
+		for (auto _ : state)
+		{
+			crossover.Process( input, outputs );
+			benchmark::ClobberMemory();
+		}
+
+		state.counters["sections"] = static_cast<double>(crossover.Sections());
+		SetPointCounters( state, Frames, static_cast<double>((bands.size() + 1) * sizeof( double )) );
+	}
+
+	void BM_CrossoverChains( benchmark::State& state )
+	{
+		const std::vector<double>& frequencies = crossoverFrequencies;
+		std::vector<IIR::CascadeProcessor<double>> chains;
+		size_t sections = 0;
+		for (size_t k = 0; k <= frequencies.size(); k++)
+		{
+			std::vector<Biquad<double>> chain;
+			for (size_t j = 0; j < frequencies.size(); j++)
+			{
+				if (j < k)
+				{
+					chain.push_back( IIR::HighPass12dbOct( frequencies[j], Fs ) );
+					chain.push_back( IIR::HighPass12dbOct( frequencies[j], Fs ) );
+				}
+				else if (j == k)
+				{
+					chain.push_back( IIR::LowPass12dbOct( frequencies[j], Fs ) );
+					chain.push_back( IIR::LowPass12dbOct( frequencies[j], Fs ) );
+				}
+				else
+				{
+					chain.push_back( IIR::AllPassQ( frequencies[j], Constants::one_over_sqrt2<double>(), Fs ) );
+				}
+			}
+			sections += chain.size();
+			chains.emplace_back( chain );
+		}
+		const std::vector<double> input = Noise( Frames );
+		std::vector<std::vector<double>> bands( chains.size(), std::vector<double>( Frames ) );
+
+		for (auto _ : state)
+		{
+			for (size_t k = 0; k < chains.size(); k++)
+			{
+				chains[k].Process( input, bands[k] );
+			}
+			benchmark::ClobberMemory();
+		}
+
+		state.counters["sections"] = static_cast<double>(sections);
+		SetPointCounters( state, Frames, static_cast<double>((bands.size() + 1) * sizeof( double )) );
+	}
+
+	// 16th order 8 kHz low pass of Frames samples at 192 kHz: at the input
+	// rate, and at 48 kHz after two halfband or one 48 tap polyphase 4x
+	// decimation. Points are input samples in all three.
+	constexpr double MultirateFs = 192000.0;
+
+	void BM_DecimateFullRate( benchmark::State& state )
+	{
+		IIR::CascadeProcessor<double> filter( IIR::LowPassCascadeAsButterworth( 16, 8000.0, MultirateFs ) );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> output( Frames );
+
+		for (auto _ : state)
+		{
+			filter.Process( input, output );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 2 * sizeof( double ) );
+	}
+
+	void BM_DecimateHalfband( benchmark::State& state )
+	{
+		IIR::CascadeProcessor<double> filter( IIR::LowPassCascadeAsButterworth( 16, 8000.0, MultirateFs / 4 ) );
+		const auto coefficients = Multirate::HalfbandCoefficients( 6, 0.1 );
+		Multirate::HalfbandDecimator<double> first( coefficients ), second( coefficients );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> half( Frames / 2 ), quarter( Frames / 4 );
+
+		for (auto _ : state)
+		{
+			first.Process( input, half );
+			second.Process( half, quarter );
+			filter.Process( quarter, quarter );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 1.75 * sizeof( double ) );
+	}
+
+	void BM_DecimatePolyphase( benchmark::State& state )
+	{
+		IIR::CascadeProcessor<double> filter( IIR::LowPassCascadeAsButterworth( 16, 8000.0, MultirateFs / 4 ) );
+		Multirate::PolyphaseDecimator<double> decimator( Multirate::LowPassTaps( 48, 20000.0, MultirateFs ), 4 );
+		const std::vector<double> input = Noise( Frames );
+		std::vector<double> quarter( Frames / 4 );
+
+		for (auto _ : state)
+		{
+			decimator.Process( input, quarter );
+			filter.Process( quarter, quarter );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, Frames, 1.25 * sizeof( double ) );
+	}
+
+	// Goertzel bank of range(0) frequencies 300 Hz apart on Frames samples,
+	// in 4800 sample blocks.
+	void BM_GoertzelBank( benchmark::State& state )
+	{
+		const auto count = static_cast<size_t>(state.range( 0 ));
+		std::vector<double> frequencies( count );
+		for (size_t k = 0; k < count; k++)
+		{
+			frequencies[k] = 100.0 + k * 300.0;
+		}
+		Eval::GoertzelBank<double> bank( frequencies, Fs, 4800 );
+		const std::vector<double> input = Noise( Frames );
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize( bank.Process( input ) );
+		}
+
+		SetPointCounters( state, Frames, sizeof( double ) );
+	}
+
+	// ------------------------------------------------------------------
+	// IIRfreqResponse
+
+	void BM_IIRfreqResponseEvalBicuad( benchmark::State& state )
+	{
+		const std::vector<double> frequencies = Frequencies( ParameterCount );
+		for (auto _ : state)
+		{
+			for (double f : frequencies)
+			{
+				benchmark::DoNotOptimize( IIRfreqResponse::EvalBicuad( peak, f, Fs ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	void BM_IIRfreqResponseEvalBicuadTrig( benchmark::State& state )
+	{
+		const std::vector<double> frequencies = Frequencies( ParameterCount );
+		for (auto _ : state)
+		{
+			for (double f : frequencies)
+			{
+				benchmark::DoNotOptimize( IIRfreqResponse::EvalBicuadTrig( peak, f, Fs ) );
+			}
+		}
+		SetPointCounters( state, ParameterCount, 3 * sizeof( double ) );
+	}
+
+	// Batch APIs over state.range( 0 ) frequencies with state.range( 1 )
+	// threads of backend state.range( 2 ) (Parallel::Backend: 0 OpenMP,
+	// 1 work stealing pool, 2 serial), writing to a first touched
+	// Parallel::Buffer.
+	template <bool Trig>
+	void BM_IIRfreqResponseBatch( benchmark::State& state )
+	{
+		const size_t points = static_cast<size_t>(state.range( 0 ));
+		const Parallel::Options options{ static_cast<Parallel::Backend>(state.range( 2 )),
+			static_cast<size_t>(state.range( 1 )) };
+		const std::vector<double> frequencies = Frequencies( points );
+		// Numerator() and Denominator() return by value, bind them before
+		// taking iterators.
+		const auto numerator = peak.Numerator();
+		const auto denominator = peak.Denominator();
+		const std::vector<double> zeros( numerator.begin(), numerator.end() );
+		const std::vector<double> poles( denominator.begin(), denominator.end() );
+
+		using Result = std::conditional_t<Trig, FrequencyResponseDouble, std::complex<double>>;
+		Parallel::Buffer<Result> result( points, options );
+
+		for (auto _ : state)
+		{
+			if constexpr (Trig)
+			{
+				IIRfreqResponse::FrequencyResponseTrig( zeros, poles, frequencies, Fs, result, options );
+			}
+			else
+			{
+				IIRfreqResponse::FrequencyResponse( zeros, poles, frequencies, Fs, result, options );
+			}
+			benchmark::DoNotOptimize( result.data() );
+			benchmark::ClobberMemory();
+		}
+
+		state.counters["threads"] = static_cast<double>(options.threads);
+		SetPointCounters( state, static_cast<double>(points), 3 * sizeof( double ) );
+	}
+
+	// 16 filters by state.range( 0 ) frequencies into a memory mapped
+	// response table (layout state.range( 1 )) in the temporary directory,
+	// through 16 MiB windows.
+	void BM_ResponseTableWrite( benchmark::State& state )
+	{
+		const size_t frequencies = static_cast<size_t>(state.range( 0 ));
+		const std::vector<double> grid = Frequencies( frequencies );
+
+		ResponseTable::FilterSet filters;
+		for (int i = 0; i < 16; i++)
+		{
+			filters.Add( IIR::PeakEq( 6.0, 100.0 * (i + 1), 1.0, Fs ) );
+		}
+
+		ResponseTable::WriteSettings settings;
+		settings.layout = static_cast<ResponseTable::Layout>(state.range( 1 ));
+		settings.windowBytes = 16 << 20;
+		const auto path = std::filesystem::temp_directory_path() / "DigitalFiltersBenchmarkTable.bin";
+
+		for (auto _ : state)
+		{
+			ResponseTable::Write( path, filters, grid, Fs, settings );
+		}
+
+		std::filesystem::remove( path );
+		SetPointCounters( state, 16.0 * frequencies, 2 * sizeof( double ) );
+	}
+
+	// count PeakEq sections and their design parameters.
+	struct PeakEqBank
+	{
+		std::vector<Biquad<double>> sections;
+		std::vector<IIR::SectionDesign> designs;
+	};
+
+	PeakEqBank MakePeakEqBank( size_t count )
+	{
+		PeakEqBank bank{ std::vector<Biquad<double>>( count ), std::vector<IIR::SectionDesign>( count ) };
+		for (size_t i = 0; i < count; i++)
+		{
+			const double fc = 20.0 + 0.2 * static_cast<double>(i);
+			bank.sections[i] = IIR::PeakEq( 6.0, fc, 1.0, Fs );
+			bank.designs[i] = { static_cast<int32_t>(IIR::FilterType::PeakEq), 6.0, fc, 1.0, Fs };
+		}
+		return bank;
+	}
+
+	// Writing a filter bank file of state.range( 0 ) PeakEq sections with
+	// design parameters.
+	void BM_FilterBankWrite( benchmark::State& state )
+	{
+		const size_t count = static_cast<size_t>(state.range( 0 ));
+		const PeakEqBank bank = MakePeakEqBank( count );
+		const auto path = std::filesystem::temp_directory_path() / "DigitalFiltersBenchmarkBankWrite.dfb";
+
+		for (auto _ : state)
+		{
+			IIR::WriteFilterBank( path, bank.sections, {}, bank.designs );
+		}
+
+		std::filesystem::remove( path );
+		SetPointCounters( state, static_cast<double>(count), 10 * sizeof( double ) );
+	}
+
+	// Opening a filter bank file of state.range( 0 ) PeakEq sections (with
+	// design parameters); state.range( 1 ) also verifies the payload
+	// checksum.
+	void BM_FilterBankOpen( benchmark::State& state )
+	{
+		const size_t count = static_cast<size_t>(state.range( 0 ));
+		const bool verify = state.range( 1 ) != 0;
+
+		const PeakEqBank source = MakePeakEqBank( count );
+		const auto path = std::filesystem::temp_directory_path() / "DigitalFiltersBenchmarkBank.dfb";
+		IIR::WriteFilterBank( path, source.sections, {}, source.designs );
+
+		for (auto _ : state)
+		{
+			const IIR::FilterBankFile bank = IIR::FilterBankFile::Open( path );
+			benchmark::DoNotOptimize( bank.Sections().a0.data() );
+			if (verify && !bank.Verify())
+			{
+				state.SkipWithError( "checksum mismatch" );
+			}
+		}
+
+		std::filesystem::remove( path );
+		SetPointCounters( state, static_cast<double>(count), 10 * sizeof( double ) );
+	}
+
+	// ------------------------------------------------------------------
+	// Datasets
+
+	// Filling state.range( 1 ) values of distribution state.range( 0 )
+	// (Datasets::Distribution: 0 Uniform, 1 LogUniform, 2 Gaussian,
+	// 3 LogSweep).
+	void BM_DatasetsFill( benchmark::State& state )
+	{
+		const size_t count = static_cast<size_t>(state.range( 1 ));
+		const Datasets::Dataset dataset{ static_cast<Datasets::Distribution>(state.range( 0 )), 20.0, 20000.0, 1, count };
+		std::vector<double> values( count );
+
+		for (auto _ : state)
+		{
+			Datasets::Fill<double>( dataset, 0, values );
+			benchmark::DoNotOptimize( values.data() );
+			benchmark::ClobberMemory();
+		}
+
+		SetPointCounters( state, static_cast<double>(count), sizeof( double ) );
+	}
+
+	void RegisterBenchmarks()
+	{
+		benchmark::RegisterBenchmark( "BM_Design", BM_Design )->DenseRange( 0, FilterTypes - 1 );
+		benchmark::RegisterBenchmark( "BM_DesignFast", BM_DesignFast )->DenseRange( 0, FilterTypes - 1 );
+		benchmark::RegisterBenchmark( "BM_DesignCacheHit", BM_DesignCacheHit );
+		for (auto* batch : { benchmark::RegisterBenchmark( "BM_DesignScalar", BM_DesignScalar ),
+			benchmark::RegisterBenchmark( "BM_DesignBatch", BM_DesignBatch ) })
+		{
+			batch->ArgsProduct( { benchmark::CreateDenseRange( 0, 7, 1 ), { 1, 64, 4096, 1 << 18 } } )
+				->ArgNames( { "designer", "filters" } );
+		}
+		benchmark::RegisterBenchmark( "BM_LowPassCascadeAsButterworth", BM_LowPassCascadeAsButterworth )
+			->Arg( 2 )->Arg( 8 )->Arg( 16 );
+		benchmark::RegisterBenchmark( "BM_HighPassCascadeAsButterworth", BM_HighPassCascadeAsButterworth )
+			->Arg( 2 )->Arg( 8 )->Arg( 16 );
+		benchmark::RegisterBenchmark( "BM_SosDesign", BM_SosDesign )
+			->ArgsProduct( { benchmark::CreateDenseRange( 0, 3, 1 ), { 2, 8, 16, 32 } } );
+		benchmark::RegisterBenchmark( "BM_EqFit", BM_EqFit )
+			->Arg( 5 )->Arg( 20 )->ArgName( "bands" )->Unit( benchmark::kMillisecond );
+
+		benchmark::RegisterBenchmark( "BM_CalcFreqResponseTrigBiquad", BM_CalcFreqResponseTrigBiquad );
+		benchmark::RegisterBenchmark( "BM_CalcFreqResponseBiquad", BM_CalcFreqResponseBiquad );
+		benchmark::RegisterBenchmark( "BM_CalcFreqResponseTrigSpan", BM_CalcFreqResponseTrigSpan )
+			->Arg( 3 )->Arg( 9 )->Arg( 33 );
+		benchmark::RegisterBenchmark( "BM_CalcFreqResponseSpan", BM_CalcFreqResponseSpan )
+			->Arg( 3 )->Arg( 9 )->Arg( 33 );
+		benchmark::RegisterBenchmark( "BM_EvalCoeffsBiquad", BM_EvalCoeffsBiquad )
+			->Arg( 3 )->Arg( 9 )->Arg( 33 );
+
+		for (auto* magnitude : { benchmark::RegisterBenchmark( "BM_CalcMagnitudeResponse", BM_CalcMagnitudeResponse<double> ),
+			benchmark::RegisterBenchmark( "BM_CalcMagnitudeResponseFloat", BM_CalcMagnitudeResponse<float> ),
+			benchmark::RegisterBenchmark( "BM_CalcMagnitudeResponseAoS", BM_CalcMagnitudeResponseAoS ) })
+		{
+			magnitude->RangeMultiplier( 8 )->Range( 8, 1 << 21 );
+		}
+		benchmark::RegisterBenchmark( "BM_CalcResponseJacobian", BM_CalcResponseJacobian )
+			->ArgsProduct( { { 1, 10, 31 }, { 64, 1024 } } );
+
+		benchmark::RegisterBenchmark( "BM_CheckStability", BM_CheckStability )
+			->Arg( 4096 )->Arg( 1 << 20 )->ArgName( "biquads" );
+
+		for (auto* processor : { benchmark::RegisterBenchmark( "BM_CascadeProcess", BM_CascadeProcess ),
+			benchmark::RegisterBenchmark( "BM_ParallelFormProcess", BM_ParallelFormProcess ) })
+		{
+			processor->Arg( 4 )->Arg( 16 )->Arg( 32 )->ArgName( "order" );
+		}
+
+		benchmark::RegisterBenchmark( "BM_CascadeRuntime", BM_CascadeRuntime )
+			->DenseRange( 1, 16 )->ArgName( "sections" );
+		[]<size_t... I>( std::index_sequence<I...> )
+		{
+			(benchmark::RegisterBenchmark( "BM_CascadeFixed", BM_CascadeFixed<I + 1> )
+				->Arg( I + 1 )->ArgName( "sections" ), ...);
+		}( std::make_index_sequence<16>{} );
+
+		benchmark::RegisterBenchmark( "BM_EqBankProcess", BM_EqBankProcess )
+			->ArgsProduct( { { 1, 2, 8 }, { 1, 3 } } )->ArgNames( { "channels", "activeEvery" } );
+
+		benchmark::RegisterBenchmark( "BM_CrossoverTree", BM_CrossoverTree );
+		benchmark::RegisterBenchmark( "BM_CrossoverChains", BM_CrossoverChains );
+
+		benchmark::RegisterBenchmark( "BM_DecimateFullRate", BM_DecimateFullRate );
+		benchmark::RegisterBenchmark( "BM_DecimateHalfband", BM_DecimateHalfband );
+		benchmark::RegisterBenchmark( "BM_DecimatePolyphase", BM_DecimatePolyphase );
+		benchmark::RegisterBenchmark( "BM_GoertzelBank", BM_GoertzelBank )
+			->Arg( 8 )->Arg( 32 )->Arg( 64 )->ArgName( "frequencies" );
+
+		benchmark::RegisterBenchmark( "BM_IIRfreqResponseEvalBicuad", BM_IIRfreqResponseEvalBicuad );
+		benchmark::RegisterBenchmark( "BM_IIRfreqResponseEvalBicuadTrig", BM_IIRfreqResponseEvalBicuadTrig );
+
+		// Sizes 1, 10, ... maxPoints; threads 1, 2, 4, ... up to all the
+		// hardware threads (and all of them when not a power of two), every
+		// backend.
+		std::vector<int64_t> sizes, threads;
+		for (int64_t size = 1; size <= static_cast<int64_t>(maxPoints); size *= 10)
+		{
+			sizes.push_back( size );
+		}
+		const int64_t cores = std::max<int64_t>( 1, std::thread::hardware_concurrency() );
+		for (int64_t count = 1; count < cores; count *= 2)
+		{
+			threads.push_back( count );
+		}
+		threads.push_back( cores );
+
+		for (auto* batch : { benchmark::RegisterBenchmark( "BM_IIRfreqResponseFrequencyResponse",
+				BM_IIRfreqResponseBatch<false> ),
+			benchmark::RegisterBenchmark( "BM_IIRfreqResponseFrequencyResponseTrig",
+				BM_IIRfreqResponseBatch<true> ) })
+		{
+			batch->ArgsProduct( { sizes, threads, { 0, 1, 2 } } )->ArgNames( { "points", "threads", "backend" } )
+				->UseRealTime()->Unit( benchmark::kMillisecond );
+		}
+
+		benchmark::RegisterBenchmark( "BM_DatasetsFill", BM_DatasetsFill )
+			->ArgsProduct( { benchmark::CreateDenseRange( 0, 3, 1 ), { 4096, 1 << 20 } } )
+			->ArgNames( { "distribution", "values" } );
+		benchmark::RegisterBenchmark( "BM_FilterBankWrite", BM_FilterBankWrite )
+			->Arg( 1000 )->Arg( 100000 )->ArgName( "sections" )->UseRealTime();
+		benchmark::RegisterBenchmark( "BM_FilterBankOpen", BM_FilterBankOpen )
+			->ArgsProduct( { { 1000, 100000 }, { 0, 1 } } )->ArgNames( { "sections", "verify" } );
+
+		benchmark::RegisterBenchmark( "BM_ResponseTableWrite", BM_ResponseTableWrite )
+			->ArgsProduct( { { 1000, 100000 }, { 0, 1 } } )->ArgNames( { "frequencies", "layout" } )
+			->UseRealTime()->Unit( benchmark::kMillisecond );
+	}
+}
+
+// --max_points=N limits the batch sizes (default
+// DIGITALFILTERS_BENCH_MAX_POINTS); all other flags go to Google Benchmark.
+int main( int argc, char** argv )
+{
+	std::vector<char*> arguments;
+	for (int i = 0; i < argc; i++)
+	{
+		constexpr const char* flag = "--max_points=";
+		if (std::strncmp( argv[i], flag, std::strlen( flag ) ) == 0)
+		{
+			maxPoints = std::strtoull( argv[i] + std::strlen( flag ), nullptr, 10 );
+		}
+		else
+		{
+			arguments.push_back( argv[i] );
+		}
+	}
+
+	int count = static_cast<int>(arguments.size());
+	benchmark::Initialize( &count, arguments.data() );
+	if (benchmark::ReportUnrecognizedArguments( count, arguments.data() ))
+	{
+		return 1;
+	}
+
+	RegisterBenchmarks();
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,172 @@
+// DigitalFiltersShards.cpp
+//
+// Sharded response table jobs (see include/Sharding.h):
+//
+//   DigitalFiltersShards split  job.txt N directory      shard-<i>.txt specs
+//   DigitalFiltersShards run    shard.txt output.bin     one shard, any host
+//   DigitalFiltersShards merge  job.txt output.bin shard-0.bin ... shard-<N-1>.bin
+//   DigitalFiltersShards launch job.txt N directory output.bin
+//
+// launch splits the job, runs every shard as a separate local process,
+// merges the shard tables and removes them. On a cluster, run the shard
+// specs written by split with the scheduler and merge their outputs.
+//
+//   DigitalFiltersShards demo directory [N]
+//
+// writes a job of PeakEq filters, launches it on N processes (default 4) and
+// checks that the merged table is identical to the table of one process.
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+#include <exception>
+
+#include "Sharding.h"
+#include "IIRDesign.h"
+
+using namespace DigitalFilters;
+
+namespace
+{
+	std::filesystem::path ShardPath( const std::filesystem::path& directory, size_t index, const char* extension )
+	{
+		return directory / ("shard-" + std::to_string( index ) + extension);
+	}
+
+	std::vector<std::filesystem::path> Split( const std::filesystem::path& jobPath, size_t count,
+		const std::filesystem::path& directory )
+	{
+		std::filesystem::create_directories( directory );
+		std::vector<std::filesystem::path> specs;
+		for (const Sharding::Shard& shard : Sharding::Split( Sharding::LoadJob( jobPath ), count ))
+		{
+			specs.push_back( ShardPath( directory, shard.index, ".txt" ) );
+			Sharding::Save( shard, specs.back() );
+		}
+		return specs;
+	}
+
+	// Runs every shard spec in its own process of this executable.
+	void Launch( const char* self, const std::filesystem::path& jobPath, size_t count,
+		const std::filesystem::path& directory, const std::filesystem::path& output )
+	{
+		const std::vector<std::filesystem::path> specs = Split( jobPath, count, directory );
+
+		std::vector<std::filesystem::path> tables;
+		std::vector<std::future<int>> processes;
+		for (size_t s = 0; s < specs.size(); s++)
+		{
+			tables.push_back( ShardPath( directory, s, ".bin" ) );
+			std::string command = "\"" + std::string( self ) + "\" run \"" + specs[s].string() + "\" \""
+				+ tables.back().string() + "\"";
+#if defined(_WIN32)
+			// cmd.exe strips the outer quotes of a command starting with one.
+			command = "\"" + command + "\"";
+#endif
+			processes.push_back( std::async( std::launch::async, [command] { return std::system( command.c_str() ); } ) );
+		}
+
+		for (size_t s = 0; s < processes.size(); s++)
+		{
+			if (processes[s].get() != 0)
+			{
+				throw std::runtime_error( "Shard " + std::to_string( s ) + " failed." );
+			}
+		}
+
+		Sharding::Merge( Sharding::LoadJob( jobPath ), tables, output );
+		for (const std::filesystem::path& table : tables)
+		{
+			std::filesystem::remove( table );
+		}
+	}
+
+	bool SameFiles( const std::filesystem::path& a, const std::filesystem::path& b )
+	{
+		std::ifstream first( a, std::ios::binary ), second( b, std::ios::binary );
+		return std::equal( std::istreambuf_iterator<char>( first ), std::istreambuf_iterator<char>(),
+			std::istreambuf_iterator<char>( second ), std::istreambuf_iterator<char>() );
+	}
+
+	int Demo( const char* self, const std::filesystem::path& directory, size_t count )
+	{
+		std::filesystem::create_directories( directory );
+
+		Sharding::Job job;
+		job.grid = Datasets::LogSweep( 20000, 10.0, 23000.0 );
+		job.layout = ResponseTable::Layout::MagnitudePhase;
+		for (int i = 0; i < 10; i++)
+		{
+			job.filters.Add( IIR::PeakEq( -12.0 + 2.5 * i, 40.0 * (i + 1) * (i + 1), 0.7 + 0.1 * i, job.fs ) );
+		}
+		const std::filesystem::path jobPath = directory / "job.txt";
+		Sharding::Save( job, jobPath );
+
+		const std::filesystem::path merged = directory / "merged.bin", single = directory / "single.bin";
+		Launch( self, jobPath, count, directory, merged );
+		ResponseTable::Write( single, job.filters, Datasets::Generate<double>( job.grid ), job.fs,
+			{ job.layout } );
+
+		const bool same = SameFiles( merged, single );
+		std::printf( "%zu shards of %zu filters x %zu frequencies: merged table %s the single process table\n",
+			count, job.filters.Size(), job.grid.size, same ? "identical to" : "DIFFERENT from" );
+		return same ? 0 : 1;
+	}
+
+	int Usage()
+	{
+		std::fprintf( stderr, "usage: DigitalFiltersShards split|run|merge|launch|demo ... (see the source)\n" );
+		return 2;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	if (argc < 2)
+	{
+		return Usage();
+	}
+
+	const std::string command = argv[1];
+	try
+	{
+		if (command == "split" && argc == 5)
+		{
+			Split( argv[2], std::strtoull( argv[3], nullptr, 10 ), argv[4] );
+		}
+		else if (command == "run" && argc == 4)
+		{
+			Sharding::Run( Sharding::LoadShard( argv[2] ), argv[3] );
+		}
+		else if (command == "merge" && argc >= 5)
+		{
+			const std::vector<std::filesystem::path> tables( argv + 4, argv + argc );
+			Sharding::Merge( Sharding::LoadJob( argv[2] ), tables, argv[3] );
+		}
+		else if (command == "launch" && argc == 6)
+		{
+			Launch( argv[0], argv[2], std::strtoull( argv[3], nullptr, 10 ), argv[4], argv[5] );
+		}
+		else if (command == "demo" && (argc == 3 || argc == 4))
+		{
+			return Demo( argv[0], argv[2], argc == 4 ? std::strtoull( argv[3], nullptr, 10 ) : 4 );
+		}
+		else
+		{
+			return Usage();
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf( stderr, "%s\n", error.what() );
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,304 @@
+#!/usr/bin/env python3
+"""Performance regression gate for DigitalFiltersBenchmarks.
+
+Runs the benchmark binary with several repetitions (randomly interleaved),
+keeps the time of every repetition and compares each benchmark against a
+baseline recorded on the same machine:
+
+  - statistic: median of the repetitions, with a distribution free
+    confidence interval from order statistics (binomial ranks);
+  - regression: the candidate median is slower than the baseline median by
+    more than --threshold AND the two confidence intervals do not overlap.
+
+Usage:
+  perf_gate.py record  --binary build/Benchmarks/DigitalFiltersBenchmarks
+  perf_gate.py check   --binary build/Benchmarks/DigitalFiltersBenchmarks
+  perf_gate.py compare baseline.json candidate.json
+
+Baselines are stored per machine (host name, CPU model and core count) in
+--baseline-dir, by default a baselines directory next to --binary so they
+stay out of the source tree. check exits with 1 when a benchmark regresses, 2 when there
+is no baseline for this machine and 0 otherwise.
+
+By default only the kernels of Evaluator.h and IIRDesignImpl.h, the batch
+and IIR::Fast designers against them and the parallel form processor
+against the cascade are gated (see DEFAULT_FILTER); --filter selects other
+benchmarks.
+
+SPEEDUPS pairs a fast path with the code it replaces. When both ran, the
+speed-up (reference median / fast median) is printed and the gate also fails
+when it shrank by more than --threshold compared with the baseline, so a
+change that slows the fast path and the reference alike does not hide the
+loss of the speed-up.
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import platform
+import re
+import statistics
+import subprocess
+import sys
+
+# Benchmarks exercising Evaluator.h (Eval:: evaluators and the IIRfreqResponse
+# APIs built on them) and IIRDesignImpl.h (exact designers).
+DEFAULT_FILTER = (
+    "^BM_Design/|^BM_CalcFreqResponse|^BM_EvalCoeffsBiquad|"
+    "^BM_IIRfreqResponse(EvalBicuad|EvalBicuadTrig)$|"
+    "^BM_IIRfreqResponseFrequencyResponse(Trig)?/points:(1|1000|100000)/threads:1/backend:0/|"
+    "^BM_Design(Scalar|Batch)/designer:[03]/filters:4096$|"
+    "^BM_DesignFast/(9|18)$|"
+    "^BM_(Cascade|ParallelForm)Process/order:32$|"
+    "^BM_Cascade(Runtime|Fixed)/sections:2$|"
+    "^BM_CalcMagnitudeResponse(Float|AoS)/262144$|"
+    "^BM_Crossover(Tree|Chains)$|"
+    "^BM_Decimate(FullRate|Halfband)$"
+)
+
+# (fast, reference) benchmark pairs whose speed-up is tracked.
+SPEEDUPS = [
+    ("BM_DesignBatch/designer:0/filters:4096", "BM_DesignScalar/designer:0/filters:4096"),
+    ("BM_DesignBatch/designer:3/filters:4096", "BM_DesignScalar/designer:3/filters:4096"),
+    ("BM_DesignFast/9", "BM_Design/9"),
+    ("BM_DesignFast/18", "BM_Design/18"),
+    ("BM_ParallelFormProcess/order:32", "BM_CascadeProcess/order:32"),
+    ("BM_CascadeFixed/sections:2", "BM_CascadeRuntime/sections:2"),
+    ("BM_CalcMagnitudeResponseFloat/262144", "BM_CalcMagnitudeResponseAoS/262144"),
+    ("BM_CrossoverTree", "BM_CrossoverChains"),
+    ("BM_DecimateHalfband", "BM_DecimateFullRate"),
+]
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def machine_id():
+    """Short identifier of this machine: host, CPU model and core count."""
+    cpu = platform.processor()
+    try:
+        with open("/proc/cpuinfo") as cpuinfo:
+            for line in cpuinfo:
+                if line.startswith("model name"):
+                    cpu = line.split(":", 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    description = f"{platform.node()}|{cpu}|{os.cpu_count()}"
+    digest = hashlib.sha1(description.encode()).hexdigest()[:10]
+    host = re.sub(r"[^A-Za-z0-9_.-]", "_", platform.node()) or "machine"
+    return f"{host}-{digest}", description
+
+
+def run_benchmarks(binary, repetitions, benchmark_filter, min_time, extra):
+    """Runs the binary and returns {name: [nanoseconds per repetition]}."""
+    command = [
+        binary,
+        f"--benchmark_filter={benchmark_filter}",
+        f"--benchmark_repetitions={repetitions}",
+        "--benchmark_enable_random_interleaving=true",
+        f"--benchmark_min_time={min_time}",
+        "--benchmark_format=json",
+    ] + extra
+    print("running:", " ".join(command), file=sys.stderr)
+    output = subprocess.run(command, check=True, stdout=subprocess.PIPE, text=True).stdout
+    return samples_from_json(json.loads(output))
+
+
+def samples_from_json(report):
+    samples = {}
+    for entry in report.get("benchmarks", []):
+        if entry.get("run_type", "iteration") != "iteration":
+            continue
+        name = entry.get("run_name", entry["name"])
+        scale = TIME_UNITS[entry.get("time_unit", "ns")]
+        samples.setdefault(name, []).append(entry["real_time"] * scale)
+    return samples
+
+
+def median_interval(values, confidence=0.95):
+    """Median and a distribution free confidence interval for it.
+
+    With 0 based ranks, the interval [x(l), x(n - 1 - l)] of the sorted
+    samples covers the median with probability
+    sum_{k=l+1}^{n-1-l} C(n, k) / 2^n. The tightest l reaching the
+    confidence is used (the full range for very few samples)."""
+    data = sorted(values)
+    n = len(data)
+    median = statistics.median(data)
+
+    cumulative = []
+    total = 0.0
+    for k in range(n + 1):
+        total += math.comb(n, k) / 2.0 ** n
+        cumulative.append(total)
+
+    lower = 0
+    for l in range((n - 1) // 2, -1, -1):
+        if cumulative[n - 1 - l] - cumulative[l] >= confidence:
+            lower = l
+            break
+    return median, data[lower], data[n - 1 - lower]
+
+
+def minimum_repetitions(confidence):
+    """Fewest samples whose interval [x(1), x(n - 2)] reaches the confidence,
+    i.e. one outlier on each side can be discarded."""
+    n = 4
+    while 1.0 - 2.0 * (1 + n) / 2.0 ** n < confidence:
+        n += 1
+    return n
+
+
+def compare(baseline, candidate, threshold, confidence):
+    """Prints the comparison table and returns the regressed names."""
+    regressions = []
+    names = [name for name in candidate if name in baseline]
+
+    needed = minimum_repetitions(confidence)
+    if any(len(values) < needed for values in list(baseline.values()) + list(candidate.values())):
+        print(f"warning: fewer than {needed} repetitions, the confidence intervals span "
+              "every sample and a single outlier can hide a regression", file=sys.stderr)
+    width = max([len(name) for name in names] + [9])
+
+    print(f"{'benchmark':<{width}}  {'baseline ns':>14}  {'candidate ns':>14}  {'change':>8}  status")
+    for name in names:
+        base_median, base_low, base_high = median_interval(baseline[name], confidence)
+        new_median, new_low, new_high = median_interval(candidate[name], confidence)
+        change = new_median / base_median - 1.0
+
+        status = "ok"
+        if change > threshold and new_low > base_high:
+            status = "REGRESSION"
+            regressions.append(name)
+        elif change < -threshold and new_high < base_low:
+            status = "faster"
+
+        print(f"{name:<{width}}  {base_median:14.2f}  {new_median:14.2f}  {change:+8.1%}  {status}")
+
+    for name in sorted(set(baseline) - set(candidate)):
+        print(f"{name:<{width}}  missing from the candidate run")
+
+    return regressions + compare_speedups(baseline, candidate, threshold)
+
+
+def speedup(samples, fast, reference):
+    return statistics.median(samples[reference]) / statistics.median(samples[fast])
+
+
+def compare_speedups(baseline, candidate, threshold):
+    """Prints the SPEEDUPS of both runs and returns the shrunk ones."""
+    pairs = [pair for pair in SPEEDUPS
+             if all(name in samples for name in pair for samples in (baseline, candidate))]
+    if not pairs:
+        return []
+
+    regressions = []
+    width = max(len(fast) for fast, _ in pairs)
+    print(f"\n{'speed-up of':<{width}}  {'baseline':>9}  {'candidate':>9}  status")
+    for fast, reference in pairs:
+        base = speedup(baseline, fast, reference)
+        new = speedup(candidate, fast, reference)
+
+        status = "ok"
+        if new < base * (1.0 - threshold):
+            status = "REGRESSION"
+            regressions.append(f"{fast} (speed-up over {reference})")
+
+        print(f"{fast:<{width}}  {base:8.2f}x  {new:8.2f}x  {status}")
+
+    return regressions
+
+
+def baseline_path(directory):
+    identifier, _ = machine_id()
+    return os.path.join(directory, f"{identifier}.json")
+
+
+def save(path, samples, settings):
+    identifier, description = machine_id()
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    with open(path, "w") as file:
+        json.dump({"machine": identifier, "description": description,
+                   "settings": settings, "samples": samples}, file, indent=1)
+
+
+def load(path):
+    with open(path) as file:
+        data = json.load(file)
+    # Stored gate file or a raw Google Benchmark JSON report.
+    return data["samples"] if "samples" in data else samples_from_json(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    def add_run_arguments(command):
+        command.add_argument("--binary", required=True, help="DigitalFiltersBenchmarks executable")
+        command.add_argument("--baseline-dir", help="default: baselines next to --binary")
+        command.add_argument("--repetitions", type=int, default=10)
+        command.add_argument("--min-time", default="0.05", help="--benchmark_min_time per repetition")
+        command.add_argument("--filter", default=DEFAULT_FILTER)
+        command.add_argument("--max-points", type=int, default=100000)
+        command.add_argument("--output", help="also store the run in this file")
+
+    record = commands.add_parser("record", help="run and store the baseline of this machine")
+    add_run_arguments(record)
+
+    check = commands.add_parser("check", help="run and compare with the baseline of this machine")
+    add_run_arguments(check)
+
+    offline = commands.add_parser("compare", help="compare two stored runs")
+    offline.add_argument("baseline")
+    offline.add_argument("candidate")
+
+    for command in (check, offline):
+        command.add_argument("--threshold", type=float, default=0.05,
+                             help="relative slowdown of the median to flag (default 0.05)")
+        command.add_argument("--confidence", type=float, default=0.95)
+
+    arguments = parser.parse_args()
+
+    if arguments.command == "compare":
+        regressions = compare(load(arguments.baseline), load(arguments.candidate),
+                              arguments.threshold, arguments.confidence)
+        return report(regressions)
+
+    directory = arguments.baseline_dir or os.path.join(os.path.dirname(os.path.abspath(arguments.binary)),
+                                                       "baselines")
+    path = baseline_path(directory)
+    if arguments.command == "check" and not os.path.exists(path):
+        print(f"no baseline for this machine ({path}); run 'record' first", file=sys.stderr)
+        return 2
+
+    settings = {"repetitions": arguments.repetitions, "min_time": arguments.min_time,
+                "filter": arguments.filter, "max_points": arguments.max_points}
+    samples = run_benchmarks(arguments.binary, arguments.repetitions, arguments.filter,
+                             arguments.min_time, [f"--max_points={arguments.max_points}"])
+    if arguments.output:
+        save(arguments.output, samples, settings)
+
+    if arguments.command == "record":
+        save(path, samples, settings)
+        print(f"baseline stored in {path} ({len(samples)} benchmarks)")
+        return 0
+
+    regressions = compare(load(path), samples, arguments.threshold, arguments.confidence)
+    return report(regressions)
+
+
+def report(regressions):
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) regressed:")
+        for name in regressions:
+            print(f"  {name}")
+        return 1
+    print("\nno regression")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,18 +1,72 @@
 #include "IIRfreqResponse.h"
 #include "Evaluator.h"
-#include <omp.h>
 #include <span>
+#include <stdexcept>
 #include <Utils.h>
+#include "Instrumentation.h"
+#include "Parallel.h"
 
 
 using namespace DigitalFilters;
 using namespace DigitalFilters::Utils;
 using namespace DigitalFilters::Eval;
 
+namespace
+{
+	void FrequencyResponseBatch( std::span<const double> zeros, std::span<const double> poles,
+		std::span<const double> freqs, double fs, std::span<std::complex<double>> result,
+		const Parallel::Options& options, size_t bytesAllocated )
+	{
+		if (result.size() != freqs.size())
+		{
+			throw std::invalid_argument( "result must have one value per frequency." );
+		}
+
+		// Only read by the instrumentation hooks.
+		(void)bytesAllocated;
+		DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::FrequencyResponse, freqs.size(), bytesAllocated );
+
+		Parallel::For( freqs.size(), options, [&]( size_t begin, size_t end )
+		{
+			DIGITALFILTERS_INSTRUMENT_THREAD( call );
+
+			for (size_t i = begin; i < end; ++i)
+			{
+				result[i] = Eval::CalcFreqResponse( zeros, poles, HzToOmega( freqs[i] ) / fs );
+			}
+		} );
+	}
+
+	void FrequencyResponseTrigBatch( std::span<const double> zeros, std::span<const double> poles,
+		std::span<const double> freqs, double fs, std::span<FrequencyResponseDouble> result,
+		const Parallel::Options& options, size_t bytesAllocated )
+	{
+		if (result.size() != freqs.size())
+		{
+			throw std::invalid_argument( "result must have one value per frequency." );
+		}
+
+		// Only read by the instrumentation hooks.
+		(void)bytesAllocated;
+		DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::FrequencyResponseTrig, freqs.size(), bytesAllocated );
+
+		Parallel::For( freqs.size(), options, [&]( size_t begin, size_t end )
+		{
+			DIGITALFILTERS_INSTRUMENT_THREAD( call );
+
+			for (size_t i = begin; i < end; ++i)
+			{
+				result[i] = Eval::CalcFreqResponseTrig<double>( zeros, poles, HzToOmega( freqs[i] ) / fs );
+			}
+		} );
+	}
+}
+
 #pragma region std::complex<double> EvalBicuad( BiquadCoefficientsDouble... )
 std::complex<double> IIRfreqResponse::EvalBicuad(
 	const BiquadCoefficientsDouble& coef, double fc, double fs )
 {
+	DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::EvalBicuad, 1, 0 );
 	double w = HzToOmega( fc ) / fs;
 	return	Eval::CalcFreqResponse(coef, w );
 }
@@ -22,6 +76,7 @@ std::complex<double> IIRfreqResponse::EvalBicuad(
 std::complex<double> DigitalFilters::IIRfreqResponse::EvalBicuad( double a0
 	, double a1, double a2, double b1, double b2, double fc, double fs )
 {
+	DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::EvalBicuad, 1, 0 );
 	double w = HzToOmega( fc ) / fs;
 	return	Eval::CalcFreqResponse(
 		BiquadCoefficientsDouble(a0, a1, a2, b1, b2), w );
@@ -33,13 +88,22 @@ std::complex<double> DigitalFilters::IIRfreqResponse::FrequencyResponse(
 	const std::vector<double>& zeros, const std::vector<double>& poles,
 	double fc, double fs )
 {
+	return FrequencyResponse( std::span<const double>( zeros ),
+		std::span<const double>( poles ), fc, fs );
+}
+#pragma endregion
+
+#pragma region std::complex<double> FrequencyResponse(std::span<const double>...)
+std::complex<double> DigitalFilters::IIRfreqResponse::FrequencyResponse(
+	std::span<const double> zeros, std::span<const double> poles,
+	double fc, double fs )
+{
+	DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::FrequencyResponse, 1, 0 );
 	double w = HzToOmega( fc ) / fs;
-	std::span mySpan1( zeros );
-	std::span mySpan2( poles );
 
 	return Eval::CalcFreqResponse(
-		mySpan1,
-		mySpan2,
+		zeros,
+		poles,
 		w);
 }
 #pragma endregion
@@ -52,20 +116,39 @@ std::vector<std::complex<double>> IIRfreqResponse::FrequencyResponse(
 	const std::vector<double>& freqs,
 	double fs )
 {
+	return FrequencyResponse( std::span<const double>( zeros ),
+		std::span<const double>( poles ), freqs, fs );
+}
+#pragma endregion
+
+#pragma region std::vector<std::complex<double>> FrequencyResponse(std::span<const double>...)
 
+std::vector<std::complex<double>> IIRfreqResponse::FrequencyResponse(
+	std::span<const double> zeros,
+	std::span<const double> poles,
+	const std::vector<double>& freqs,
+	double fs )
+{
 	std::vector<std::complex<double>> result( freqs.size() );
-	std::span mySpan1( zeros );
-	std::span mySpan2( poles );
 
-	#pragma omp parallel for
-	for (int i = 0; i < (int)freqs.size(); ++i)
-	{
-		double w = HzToOmega( freqs[i] ) / fs;
-		result[i] = Eval::CalcFreqResponse( mySpan1, mySpan2, w );
-	}
+	FrequencyResponseBatch( zeros, poles, freqs, fs, result, Parallel::DefaultOptions(),
+		freqs.size() * sizeof( std::complex<double> ) );
 
 	return result;
+}
+#pragma endregion
+
+#pragma region void FrequencyResponse(..., std::span<std::complex<double>> result, options)
 
+void IIRfreqResponse::FrequencyResponse(
+	std::span<const double> zeros,
+	std::span<const double> poles,
+	std::span<const double> freqs,
+	double fs,
+	std::span<std::complex<double>> result,
+	const Parallel::Options& options )
+{
+	FrequencyResponseBatch( zeros, poles, freqs, fs, result, options, 0 );
 }
 #pragma endregion
 
@@ -73,6 +156,7 @@ std::vector<std::complex<double>> IIRfreqResponse::FrequencyResponse(
 FrequencyResponseDouble DigitalFilters::IIRfreqResponse::EvalBicuadTrig(
 	const BiquadCoefficientsDouble& coef, double fc, double fs )
 {
+	DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::EvalBicuadTrig, 1, 0 );
 	double w = HzToOmega( fc ) / fs;
 
 	return	Eval::CalcFreqResponseTrig( coef, w );
@@ -84,6 +168,7 @@ FrequencyResponseDouble DigitalFilters::IIRfreqResponse::EvalBicuadTrig(
 FrequencyResponseDouble  DigitalFilters::IIRfreqResponse::EvalBicuadTrig( double a0
 	, double a1, double a2, double b1, double b2, double fc, double fs )
 {
+	DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::EvalBicuadTrig, 1, 0 );
 	double w = HzToOmega( fc ) / fs;
 	return	Eval::CalcFreqResponseTrig(
 		BiquadCoefficientsDouble(a0, a1, a2, b1, b2), w );
@@ -96,6 +181,7 @@ DigitalFilters::IIRfreqResponse::FrequencyResponseTrig(
 	const std::vector<double>& poles, const std::vector<double>& zeros,
 	double fc, double fs )
 {
+	DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::FrequencyResponseTrig, 1, 0 );
 	double w = HzToOmega( fc ) / fs;
 
 	std::span z ( zeros );
@@ -113,19 +199,71 @@ std::vector<FrequencyResponseDouble > IIRfreqResponse::FrequencyResponseTrig(
 	const std::vector<double>& freqs,
 	double fs )
 {
-
 	std::vector<FrequencyResponseDouble > result( freqs.size() );
 
-#pragma omp parallel for
-	for (int i = 0; i < (int)freqs.size(); ++i)
-	{
-		double w = HzToOmega( freqs[i] ) / fs;
-		result[i] = Eval::CalcFreqResponseTrig<double>(zeros, poles, w );
-	}
+	FrequencyResponseTrigBatch( zeros, poles, freqs, fs, result, Parallel::DefaultOptions(),
+		freqs.size() * sizeof( FrequencyResponseDouble ) );
 
 	return result;
 }
 
 #pragma endregion
 
+#pragma region void FrequencyResponseTrig(..., std::span<FrequencyResponseDouble> result, options)
+
+void IIRfreqResponse::FrequencyResponseTrig(
+	std::span<const double> zeros,
+	std::span<const double> poles,
+	std::span<const double> freqs,
+	double fs,
+	std::span<FrequencyResponseDouble> result,
+	const Parallel::Options& options )
+{
+	FrequencyResponseTrigBatch( zeros, poles, freqs, fs, result, options, 0 );
+}
+
+#pragma endregion
+
+#pragma region Async::Job FrequencyResponseAsync(...)
 
+Async::Job<std::complex<double>> IIRfreqResponse::FrequencyResponseAsync(
+	std::vector<double> zeros,
+	std::vector<double> poles,
+	std::vector<double> freqs,
+	double fs,
+	Async::Settings settings,
+	const Parallel::Options& options )
+{
+	const size_t count = freqs.size();
+	return Async::Run<std::complex<double>>( count, std::move( settings ),
+		[zeros = std::move( zeros ), poles = std::move( poles ), freqs = std::move( freqs ), fs, options](
+			size_t begin, std::span<std::complex<double>> output )
+		{
+			FrequencyResponseBatch( zeros, poles, std::span<const double>( freqs ).subspan( begin, output.size() ),
+				fs, output, options, 0 );
+		} );
+}
+
+#pragma endregion
+
+#pragma region Async::Job FrequencyResponseTrigAsync(...)
+
+Async::Job<FrequencyResponseDouble> IIRfreqResponse::FrequencyResponseTrigAsync(
+	std::vector<double> zeros,
+	std::vector<double> poles,
+	std::vector<double> freqs,
+	double fs,
+	Async::Settings settings,
+	const Parallel::Options& options )
+{
+	const size_t count = freqs.size();
+	return Async::Run<FrequencyResponseDouble>( count, std::move( settings ),
+		[zeros = std::move( zeros ), poles = std::move( poles ), freqs = std::move( freqs ), fs, options](
+			size_t begin, std::span<FrequencyResponseDouble> output )
+		{
+			FrequencyResponseTrigBatch( zeros, poles, std::span<const double>( freqs ).subspan( begin, output.size() ),
+				fs, output, options, 0 );
+		} );
+}
+
+#pragma endregion
@@ -1,8 +1,11 @@
 #pragma once
 #include <complex>
 #include <vector>
-#include "..\include\Biquad.h"
-#include "..\include\FrequencyResponse.h"
+#include <span>
+#include "../include/Biquad.h"
+#include "../include/FrequencyResponse.h"
+#include "../include/Parallel.h"
+#include "../include/Async.h"
 #include "DigitalFiltersModuleExport.h"
 
 
@@ -36,6 +39,30 @@ public:
 		const std::vector<double>& poles,
 		const std::vector<double>& freqs, double fs);
 
+	// Same as above on coefficient views, e.g. Biquad::Numerator(), so the
+	// caller does not need to allocate vectors.
+	static std::complex<double> FrequencyResponse(
+		std::span<const double> zeros,
+		std::span<const double> poles,
+		double freq, double fs);
+
+	static std::vector < std::complex<double> >FrequencyResponse(
+		std::span<const double> zeros,
+		std::span<const double> poles,
+		const std::vector<double>& freqs, double fs);
+
+	// Same as above into result (one value per frequency) with the given
+	// backend, thread count and grain. Every value is written by the thread
+	// that computes it, so a Parallel::Buffer allocated with the same options
+	// keeps the output pages local on NUMA machines. The overloads returning
+	// a vector use Parallel::DefaultOptions().
+	static void FrequencyResponse(
+		std::span<const double> zeros,
+		std::span<const double> poles,
+		std::span<const double> freqs, double fs,
+		std::span<std::complex<double>> result,
+		const Parallel::Options& options);
+
 	static FrequencyResponseDouble EvalBicuadTrig(
 		const BiquadCoefficientsDouble& coef,
 		double freq, double fs);
@@ -55,6 +82,31 @@ public:
 		const std::vector<double>& poles,
 		const std::vector<double>& freqs, double fs);
 
+	static void FrequencyResponseTrig(
+		std::span<const double> zeros,
+		std::span<const double> poles,
+		std::span<const double> freqs, double fs,
+		std::span<FrequencyResponseDouble> result,
+		const Parallel::Options& options);
+
+	// Asynchronous versions of the batch functions: return at once a job
+	// evaluating settings.chunkSize frequencies at a time (each chunk with
+	// options), that reports progress, can be cancelled between chunks and
+	// exposes the responses computed so far (see Async.h). The job keeps its
+	// own copy of the coefficients and frequencies.
+	static Async::Job<std::complex<double>> FrequencyResponseAsync(
+		std::vector<double> zeros,
+		std::vector<double> poles,
+		std::vector<double> freqs, double fs,
+		Async::Settings settings = {},
+		const Parallel::Options& options = Parallel::DefaultOptions());
+
+	static Async::Job<FrequencyResponseDouble> FrequencyResponseTrigAsync(
+		std::vector<double> zeros,
+		std::vector<double> poles,
+		std::vector<double> freqs, double fs,
+		Async::Settings settings = {},
+		const Parallel::Options& options = Parallel::DefaultOptions());
 
 };
 
@@ -0,0 +1,24 @@
+// Instrumentation.cpp
+#include "Instrumentation.h"
+
+
+namespace DigitalFilters::Instrumentation::Detail
+{
+	namespace
+	{
+		// Constant initialised, so usable from static initialisers of other
+		// translation units.
+		std::array<KernelCounters, KernelCount> counters;
+		std::atomic<Sink*> sink{ nullptr };
+	}
+
+	std::array<KernelCounters, KernelCount>& Counters()
+	{
+		return counters;
+	}
+
+	std::atomic<Sink*>& SinkSlot()
+	{
+		return sink;
+	}
+}
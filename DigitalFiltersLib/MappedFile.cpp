@@ -0,0 +1,161 @@
+// MappedFile.cpp
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace DigitalFilters::Detail
+{
+#if defined(_WIN32)
+	namespace
+	{
+		HANDLE ToHandle( FileHandle handle )
+		{
+			return reinterpret_cast<HANDLE>(handle);
+		}
+
+		[[noreturn]] void ThrowLastError( const std::string& what )
+		{
+			throw std::system_error( static_cast<int>(GetLastError()), std::system_category(), what );
+		}
+	}
+
+	FileHandle OpenFile( const std::filesystem::path& path, bool writable, bool create, uint64_t& size )
+	{
+		const HANDLE handle = CreateFileW( path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+			FILE_SHARE_READ, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+		if (handle == INVALID_HANDLE_VALUE)
+		{
+			ThrowLastError( "CreateFile " + path.string() );
+		}
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx( handle, &fileSize );
+		size = static_cast<uint64_t>(fileSize.QuadPart);
+		return reinterpret_cast<FileHandle>(handle);
+	}
+
+	void ResizeFile( FileHandle handle, uint64_t size )
+	{
+		LARGE_INTEGER distance;
+		distance.QuadPart = static_cast<LONGLONG>(size);
+		if (!SetFilePointerEx( ToHandle( handle ), distance, nullptr, FILE_BEGIN ) || !SetEndOfFile( ToHandle( handle ) ))
+		{
+			ThrowLastError( "SetEndOfFile" );
+		}
+	}
+
+	void CloseFile( FileHandle handle )
+	{
+		CloseHandle( ToHandle( handle ) );
+	}
+
+	void* MapFile( FileHandle handle, bool writable, uint64_t start, size_t length )
+	{
+		const uint64_t end = start + length;
+		const HANDLE mapping = CreateFileMappingW( ToHandle( handle ), nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+			static_cast<DWORD>(end >> 32), static_cast<DWORD>(end), nullptr );
+		if (mapping == nullptr)
+		{
+			ThrowLastError( "CreateFileMapping" );
+		}
+		void* base = MapViewOfFile( mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+			static_cast<DWORD>(start >> 32), static_cast<DWORD>(start), length );
+		const DWORD error = GetLastError();
+		CloseHandle( mapping );
+		if (base == nullptr)
+		{
+			throw std::system_error( static_cast<int>(error), std::system_category(), "MapViewOfFile" );
+		}
+		return base;
+	}
+
+	void FlushMapping( void* base, size_t length )
+	{
+		if (!FlushViewOfFile( base, length ))
+		{
+			ThrowLastError( "FlushViewOfFile" );
+		}
+	}
+
+	void UnmapFile( void* base, size_t )
+	{
+		UnmapViewOfFile( base );
+	}
+
+	uint64_t MapGranularity()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo( &info );
+		return info.dwAllocationGranularity;
+	}
+#else
+	FileHandle OpenFile( const std::filesystem::path& path, bool writable, bool create, uint64_t& size )
+	{
+		const int handle = open( path.c_str(), (writable ? O_RDWR : O_RDONLY) | (create ? O_CREAT | O_TRUNC : 0), 0644 );
+		if (handle < 0)
+		{
+			throw std::system_error( errno, std::system_category(), "open " + path.string() );
+		}
+		struct stat status;
+		fstat( handle, &status );
+		size = static_cast<uint64_t>(status.st_size);
+		return handle;
+	}
+
+	void ResizeFile( FileHandle handle, uint64_t size )
+	{
+		if (ftruncate( static_cast<int>(handle), static_cast<off_t>(size) ) != 0)
+		{
+			throw std::system_error( errno, std::system_category(), "ftruncate" );
+		}
+	}
+
+	void CloseFile( FileHandle handle )
+	{
+		close( static_cast<int>(handle) );
+	}
+
+	void* MapFile( FileHandle handle, bool writable, uint64_t start, size_t length )
+	{
+		void* base = mmap( nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+			static_cast<int>(handle), static_cast<off_t>(start) );
+		if (base == MAP_FAILED)
+		{
+			throw std::system_error( errno, std::system_category(), "mmap" );
+		}
+		return base;
+	}
+
+	void FlushMapping( void* base, size_t length )
+	{
+		if (msync( base, length, MS_SYNC ) != 0)
+		{
+			throw std::system_error( errno, std::system_category(), "msync" );
+		}
+	}
+
+	void UnmapFile( void* base, size_t length )
+	{
+		munmap( base, length );
+	}
+
+	uint64_t MapGranularity()
+	{
+		return static_cast<uint64_t>(sysconf( _SC_PAGESIZE ));
+	}
+#endif
+}
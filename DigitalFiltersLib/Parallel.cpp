@@ -0,0 +1,71 @@
+// Parallel.cpp
+#include "Parallel.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace DigitalFilters::Parallel
+{
+	namespace
+	{
+		std::mutex optionsMutex;
+		Options defaultOptions;
+	}
+
+	Options DefaultOptions()
+	{
+		std::lock_guard<std::mutex> lock( optionsMutex );
+		return defaultOptions;
+	}
+
+	void SetDefaultOptions( const Options& options )
+	{
+		std::lock_guard<std::mutex> lock( optionsMutex );
+		defaultOptions = options;
+	}
+}
+
+namespace DigitalFilters::Parallel::Detail
+{
+	size_t& PoolWorker()
+	{
+		static thread_local size_t worker = NotAWorker;
+		return worker;
+	}
+
+	ThreadPool& SharedPool()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	bool PinCurrentThread( size_t cpu )
+	{
+		const size_t cpus = std::max( 1u, std::thread::hardware_concurrency() );
+#if defined(_WIN32)
+		const size_t bits = sizeof( DWORD_PTR ) * 8;
+		return SetThreadAffinityMask( GetCurrentThread(),
+			DWORD_PTR( 1 ) << (cpu % std::min( cpus, bits )) ) != 0;
+#elif defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		CPU_SET( cpu % std::min<size_t>( cpus, CPU_SETSIZE ), &set );
+		return pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) == 0;
+#else
+		(void)cpu;
+		(void)cpus;
+		return false;
+#endif
+	}
+}
@@ -5,7 +5,33 @@
 #include "..\include\DigitalFilters.h"
 #include <random>
 #include <chrono>
+#include <climits>
+#include <thread>
+#include <fstream>
+#include <filesystem>
 #include "..\include\IIRDesign.h"
+#include "..\include\IIRBatchDesign.h"
+#include "..\include\IIRDesignCache.h"
+#include "..\include\IIRDesignFast.h"
+#include "..\include\IIRSosDesign.h"
+#include "..\include\IIREqFit.h"
+#include "..\include\IIRJacobian.h"
+#include "..\include\BiquadStability.h"
+#include "..\include\BiquadCascade.h"
+#include "..\include\IIRParallelForm.h"
+#include "..\include\BiquadBank.h"
+#include "..\include\IIREqBank.h"
+#include "..\include\IIRCrossover.h"
+#include "..\include\Multirate.h"
+#include "..\include\GoertzelBank.h"
+#include "..\include\Instrumentation.h"
+#include "..\include\Accuracy.h"
+#include "..\include\Datasets.h"
+#include "..\include\Parallel.h"
+#include "..\include\Async.h"
+#include "..\include\ResponseTable.h"
+#include "..\include\Sharding.h"
+#include "..\include\FilterBankFile.h"
 #include "..\include\Utils.h"
 #include "..\include\Evaluator.h"
 #include "..\DigitalFiltersLib\IIRfreqResponse.h"
@@ -39,25 +65,9 @@ typedef union
   }
 
 
-  std::vector<double> generateRandomFloats(int count)
-  {
-    std::vector<double> randomFloats;
-
-    // Configura el generador de nmeros aleatorios
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dis(20.0f, 500.0f);
-
-    // Genera valores flotantes aleatorios y los agrega al vector
-    for(int i = 0; i < count; ++i)
-    {
-      randomFloats.push_back(dis(gen));
-    }
-
-    return randomFloats;
-  }
-
-  std::vector<double> randomSet = generateRandomFloats(448000000);
+  // 448 million reproducible frequencies in [20, 500) Hz, generated the
+  // first time a test uses them.
+  Datasets::LazyDataset<double> randomSet(Datasets::Uniform(2024, 448000000, 20.0, 500.0));
 
 TEST(TestCaseName, TestName) {
   EXPECT_EQ(1, 1);
@@ -653,9 +663,12 @@ TEST(DigitalFiltersTEST, TEST_Parallel)
   auto start = std::chrono::high_resolution_clock::now();
 
 
-  auto res = IIRfreqResponse::FrequencyResponse(bicuads.GetDenominatorCoefficients(),
-    bicuads.GetNumeratorCoefficients(),
-    randomSet,
+  auto denominator = bicuads.Denominator();
+  auto numerator = bicuads.Numerator();
+
+  auto res = IIRfreqResponse::FrequencyResponse(std::span<const double>(denominator),
+    std::span<const double>(numerator),
+    randomSet.Values(),
     1000.0);
 
 
@@ -723,4 +736,2055 @@ TEST(DigitalFiltersTEST, Test_Size)
     EXPECT_EQ(1, 1);
     EXPECT_TRUE(true);
 
-}
\ No newline at end of file
+}
+
+  long long ulpDistance(double x, double y)
+  {
+    dbl_64 sx, sy;
+    sx.d64 = x;
+    sy.d64 = y;
+
+    // Map the sign-magnitude representation onto a monotonic integer line.
+    long long ix = sx.i64 < 0 ? LLONG_MIN - sx.i64 : sx.i64;
+    long long iy = sy.i64 < 0 ? LLONG_MIN - sy.i64 : sy.i64;
+
+    return ix > iy ? ix - iy : iy - ix;
+  }
+
+
+  void expectWithinUlp(const BiquadCoefficientsd& x,
+    const BiquadCoefficientsd& y, long long maxUlp)
+  {
+    EXPECT_LE(ulpDistance(x.a0, y.a0), maxUlp);
+    EXPECT_LE(ulpDistance(x.a1, y.a1), maxUlp);
+    EXPECT_LE(ulpDistance(x.a2, y.a2), maxUlp);
+    EXPECT_LE(ulpDistance(x.b0, y.b0), maxUlp);
+    EXPECT_LE(ulpDistance(x.b1, y.b1), maxUlp);
+    EXPECT_LE(ulpDistance(x.b2, y.b2), maxUlp);
+  }
+
+
+TEST(DigitalFiltersTEST, Test_ConstexprDesign)
+{
+  using namespace DigitalFilters;
+
+  constexpr auto lowPass = IIR::LowPass(1000.0, 0.707, 48000.0);
+  constexpr auto peakBoost = IIR::PeakEq(5.0, 100.0, 10.0, 1000.0);
+  constexpr auto peakCut = IIR::PeakEq(-7.5, 2500.0, 0.5, 44100.0);
+  constexpr auto highShelf = IIR::HighShelf(5.0, 100.0, 1000.0);
+  constexpr auto lowShelfQ = IIR::LowShelfQ(-3.0, 250.0, 0.9, 48000.0);
+  constexpr auto onePole = IIR::OnePoleLowPass(100.0, 1000.0);
+
+  static_assert(lowPass.b0 == 1.0);
+
+  // Same designs outside a constant expression go through <cmath>.
+  expectWithinUlp(lowPass, IIR::LowPass(1000.0, 0.707, 48000.0), 4);
+  expectWithinUlp(peakBoost, IIR::PeakEq(5.0, 100.0, 10.0, 1000.0), 4);
+  expectWithinUlp(peakCut, IIR::PeakEq(-7.5, 2500.0, 0.5, 44100.0), 4);
+  expectWithinUlp(highShelf, IIR::HighShelf(5.0, 100.0, 1000.0), 4);
+  expectWithinUlp(lowShelfQ, IIR::LowShelfQ(-3.0, 250.0, 0.9, 48000.0), 4);
+  expectWithinUlp(onePole, IIR::OnePoleLowPass(100.0, 1000.0), 4);
+
+  ASSERT_NEAR(peakBoost.a0, 1.0222200277386724, Epsilon);
+  ASSERT_NEAR(peakBoost.a2, 0.920679585299887, Epsilon);
+  ASSERT_NEAR(peakBoost.b2, 0.9428996130385592, Epsilon);
+}
+
+
+TEST(DigitalFiltersTEST, Test_BatchDesign)
+{
+  using namespace DigitalFilters;
+
+  std::vector<double> gains, fcs, qs, fss;
+
+  for (double gain : { -24.0, -5.0, -0.5, 0.0, 3.0, 15.0 })
+    for (double fc : { 20.0, 100.0, 1000.0, 11000.0, 20000.0 })
+      for (double q : { 0.3, 0.707, 10.0 })
+      {
+        gains.push_back(gain);
+        fcs.push_back(fc);
+        qs.push_back(q);
+        fss.push_back(fc < 10000.0 ? 44100.0 : 96000.0);
+      }
+
+  const size_t count = gains.size();
+  std::vector<double> a0(count), a1(count), a2(count), b1(count), b2(count);
+  IIR::BiquadSpans<double> out{ a0, a1, a2, b1, b2 };
+
+  auto expectBatchMatches = [&](auto scalarDesign)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      BiquadCoefficientsd expected = scalarDesign(i);
+
+      ASSERT_NEAR(a0[i], expected.a0, Epsilon);
+      ASSERT_NEAR(a1[i], expected.a1, Epsilon);
+      ASSERT_NEAR(a2[i], expected.a2, Epsilon);
+      ASSERT_NEAR(b1[i], expected.b1, Epsilon);
+      ASSERT_NEAR(b2[i], expected.b2, Epsilon);
+    }
+  };
+
+  IIR::PeakEqBatch<double>(gains, fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::PeakEq(gains[i], fcs[i], qs[i], fss[i]); });
+
+  IIR::HighShelfQBatch<double>(gains, fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::HighShelfQ(gains[i], fcs[i], qs[i], fss[i]); });
+
+  IIR::LowShelfQBatch<double>(gains, fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::LowShelfQ(gains[i], fcs[i], qs[i], fss[i]); });
+
+  IIR::LowPassBatch<double>(fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::LowPass(fcs[i], qs[i], fss[i]); });
+
+  IIR::HighPassBatch<double>(fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::HighPass(fcs[i], qs[i], fss[i]); });
+
+  IIR::BandPassBatch<double>(fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::BandPass(fcs[i], qs[i], fss[i]); });
+
+  IIR::NotchBatch<double>(fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::Notch(fcs[i], qs[i], fss[i]); });
+
+  IIR::AllPassQBatch<double>(fcs, qs, fss, out);
+  expectBatchMatches([&](size_t i)
+    { return IIR::AllPassQ(fcs[i], qs[i], fss[i]); });
+
+  std::vector<double> omega(count), linear(count);
+  Utils::PrewarpFrequencyBatch<double>(fcs, fss, omega);
+  Utils::DecibelToLinearGainBatch<double>(gains, linear);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    ASSERT_LE(ulpDistance(omega[i], Utils::PrewarpFrequency(fcs[i], fss[i])), 4);
+    ASSERT_LE(ulpDistance(linear[i], Utils::DecibelToLinearGain(gains[i])), 4);
+  }
+
+  std::vector<double> tooShort(count - 1);
+  EXPECT_THROW(Utils::DecibelToLinearGainBatch<double>(tooShort, linear),
+    std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_DesignCache)
+{
+  using namespace DigitalFilters;
+
+  IIR::DesignCacheOptions<double> options;
+  options.capacity = 64;
+  IIR::DesignCache<double> cache(options);
+
+  auto first = cache.PeakEq(5.0, 100.0, 10.0, 1000.0);
+  auto second = cache.PeakEq(5.0, 100.0, 10.0, 1000.0);
+  auto expected = IIR::PeakEq(5.0, 100.0, 10.0, 1000.0);
+
+  expectWithinUlp(first, expected, 0);
+  expectWithinUlp(second, expected, 0);
+
+  // Bit exact keys: -0.0 and 0.0 are different entries.
+  cache.LowPass(1000.0, 0.707, 48000.0);
+  cache.LowShelf(0.0, 250.0, 48000.0);
+  cache.LowShelf(-0.0, 250.0, 48000.0);
+
+  IIR::DesignCacheStats stats = cache.Stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 4u);
+  EXPECT_EQ(stats.evictions, 0u);
+
+  // Overflowing the capacity evicts, results stay correct.
+  for (int idx = 0; idx < 1000; idx++)
+  {
+    double fc = 20.0 + idx;
+    expectWithinUlp(cache.HighShelfQ(3.0, fc, 0.7, 48000.0),
+      IIR::HighShelfQ(3.0, fc, 0.7, 48000.0), 0);
+  }
+
+  stats = cache.Stats();
+  EXPECT_EQ(cache.Capacity(), 64u);
+  EXPECT_GE(stats.evictions, 1000u - 64u);
+
+  // Quantized keys share one entry.
+  options.gainStep = 0.5;
+  options.frequencyStep = 1.0;
+  IIR::DesignCache<double> quantized(options);
+
+  auto q1 = quantized.PeakEq(3.1, 999.8, 2.0, 48000.0);
+  auto q2 = quantized.PeakEq(2.9, 1000.2, 2.0, 48000.0);
+
+  expectWithinUlp(q1, IIR::PeakEq(3.0, 1000.0, 2.0, 48000.0), 0);
+  expectWithinUlp(q2, q1, 0);
+  EXPECT_EQ(quantized.Stats().hits, 1u);
+
+  // Fc and Q below half a step use the first non-zero bin, not 0.
+  options.qStep = 0.5;
+  IIR::DesignCache<double> coarse(options);
+
+  expectWithinUlp(coarse.PeakEq(3.0, 0.3, 0.1, 48000.0), IIR::PeakEq(3.0, 1.0, 0.5, 48000.0), 0);
+  expectWithinUlp(coarse.LowPass1stOrder(0.2, 48000.0), IIR::LowPass1stOrder(1.0, 48000.0), 0);
+  options.qStep = 0;
+
+  // Concurrent readers and writers always see a whole design.
+  options.capacity = 4096;
+  IIR::DesignCache<double> shared(options);
+  std::vector<std::thread> workers;
+  std::atomic<int> mismatches = 0;
+
+  for (int worker = 0; worker < 8; worker++)
+  {
+    workers.emplace_back([&, worker]()
+    {
+      for (int idx = 0; idx < 20000; idx++)
+      {
+        double gain = ((idx + worker) % 48) - 24.0;
+        double fc = 100.0 * (1 + (idx * 7 + worker) % 200);
+
+        auto cached = IIR::Cached::PeakEq(gain, fc, 1.5, 48000.0);
+        auto local = shared.PeakEq(gain, fc, 1.5, 48000.0);
+        auto direct = IIR::PeakEq(gain, fc, 1.5, 48000.0);
+
+        if (cached.a0 != direct.a0 || cached.b2 != direct.b2
+          || local.a0 != direct.a0 || local.b2 != direct.b2)
+        {
+          mismatches++;
+        }
+      }
+    });
+  }
+
+  for (auto& worker : workers)
+  {
+    worker.join();
+  }
+
+  EXPECT_EQ(mismatches.load(), 0);
+  EXPECT_GT(shared.Stats().hits, 0u);
+}
+
+
+TEST(DigitalFiltersTEST, Test_FastDesign)
+{
+  using namespace DigitalFilters;
+  using IIR::FilterType;
+
+  auto fastDesign = [](FilterType type, double gain, double fc, double q, double fs)
+  {
+    switch (type)
+    {
+    case FilterType::AllPass1stOrder: return IIR::Fast::AllPass1stOrder(fc, fs);
+    case FilterType::AllPassQ: return IIR::Fast::AllPassQ(fc, q, fs);
+    case FilterType::BandPass: return IIR::Fast::BandPass(fc, q, fs);
+    case FilterType::HighPass: return IIR::Fast::HighPass(fc, q, fs);
+    case FilterType::HighPass12dbOct: return IIR::Fast::HighPass12dbOct(fc, fs);
+    case FilterType::HighPass1stOrder: return IIR::Fast::HighPass1stOrder(fc, fs);
+    case FilterType::HighShelf: return IIR::Fast::HighShelf(gain, fc, fs);
+    case FilterType::HighShelf1stOrder: return IIR::Fast::HighShelf1stOrder(gain, fc, fs);
+    case FilterType::HighShelfQ: return IIR::Fast::HighShelfQ(gain, fc, q, fs);
+    case FilterType::LowPass: return IIR::Fast::LowPass(fc, q, fs);
+    case FilterType::LowPass12dbOct: return IIR::Fast::LowPass12dbOct(fc, fs);
+    case FilterType::LowPass1stOrder: return IIR::Fast::LowPass1stOrder(fc, fs);
+    case FilterType::LowShelf: return IIR::Fast::LowShelf(gain, fc, fs);
+    case FilterType::LowShelf1stOrder: return IIR::Fast::LowShelf1stOrder(gain, fc, fs);
+    case FilterType::LowShelfQ: return IIR::Fast::LowShelfQ(gain, fc, q, fs);
+    case FilterType::Notch: return IIR::Fast::Notch(fc, q, fs);
+    case FilterType::OnePoleHighPass: return IIR::Fast::OnePoleHighPass(fc, fs);
+    case FilterType::OnePoleLowPass: return IIR::Fast::OnePoleLowPass(fc, fs);
+    default: return IIR::Fast::PeakEq(gain, fc, q, fs);
+    }
+  };
+
+  double maxMagnitudeError = 0;
+  double maxPhaseError = 0;
+
+  for (int type = 0; type <= static_cast<int>(FilterType::PeakEq); type++)
+    for (double fs : { 44100.0, 48000.0, 96000.0 })
+      for (double gain : { -48.0, -6.0, -0.1, 0.0, 6.0, 48.0 })
+        for (double q : { 0.05, 0.707, 30.0 })
+          for (int step = 0; step < 16; step++)
+          {
+            double fc = 20.0 * std::pow(0.45 * fs / 20.0, step / 15.0);
+            auto exact = IIR::Design(static_cast<FilterType>(type), gain, fc, q, fs);
+            auto fast = fastDesign(static_cast<FilterType>(type), gain, fc, q, fs);
+
+            for (int point = 0; point < 128; point++)
+            {
+              double frequency = 10.0 * std::pow(0.4999 * fs / 10.0, point / 127.0);
+              double omega = HzToOmega(frequency) / fs;
+
+              auto expected = CalcFreqResponse(exact, omega);
+              auto actual = CalcFreqResponse(fast, omega);
+
+              // Below -100 dB (notch zeros) the dB difference is meaningless.
+              if (std::abs(expected) < 1e-5)
+              {
+                continue;
+              }
+
+              maxMagnitudeError = std::max(maxMagnitudeError,
+                std::abs(GainTodB(std::abs(actual)) - GainTodB(std::abs(expected))));
+              maxPhaseError = std::max(maxPhaseError, std::abs(std::arg(actual / expected)));
+            }
+          }
+
+  EXPECT_LE(maxMagnitudeError, 1e-4);
+  EXPECT_LE(maxPhaseError, 1e-6);
+
+  EXPECT_NEAR(Utils::FastReciprocal(3.0), 1.0 / 3.0, 1e-16);
+  EXPECT_NEAR(Utils::FastReciprocal(-0.125f), -8.0f, 1e-5f);
+  EXPECT_NEAR(Utils::FastTan(1.4) / std::tan(1.4), 1.0, 1e-8);
+  EXPECT_NEAR(Utils::FastExp(-3.0) / std::exp(-3.0), 1.0, 1e-8);
+}
+
+
+// Cascade response in dB; peakInternal receives the largest magnitude seen
+// after any section.
+double cascadeMagnitudeDb(const std::vector<BiquadCoefficientsd>& sections,
+  double frequency, double fs, double* peakInternal = nullptr)
+{
+  std::complex<double> response = 1.0;
+  double peak = 0;
+
+  for (const auto& section : sections)
+  {
+    response *= CalcFreqResponse(section, HzToOmega(frequency) / fs);
+    peak = std::max(peak, std::abs(response));
+  }
+
+  if (peakInternal)
+  {
+    *peakInternal = peak;
+  }
+
+  return GainTodB(std::abs(response));
+}
+
+
+TEST(DigitalFiltersTEST, Test_SosDesign)
+{
+  using namespace DigitalFilters;
+  using IIR::SosBand;
+  const double fs = 48000.0;
+
+  // Butterworth low-pass matches the cascade of Butterworth Q sections.
+  auto butterworth = IIR::ButterworthSos(SosBand::LowPass, 8, 1000.0, fs);
+  std::vector<BiquadCoefficientsd> byQ;
+  for (double q : IIR::ButterworthResponceQfactors<double>(8))
+  {
+    byQ.push_back(IIR::LowPass(1000.0, q, fs));
+  }
+
+  ASSERT_EQ(butterworth.size(), 4u);
+  EXPECT_NEAR(cascadeMagnitudeDb(butterworth, 1000.0, fs), -3.0102999566, 1e-8);
+  for (double frequency : { 10.0, 500.0, 1000.0, 1500.0, 4000.0, 20000.0 })
+  {
+    EXPECT_NEAR(cascadeMagnitudeDb(butterworth, frequency, fs),
+      cascadeMagnitudeDb(byQ, frequency, fs), 1e-8);
+  }
+
+  auto highPass = IIR::ButterworthSos(SosBand::HighPass, 7, 1000.0, fs);
+  EXPECT_EQ(highPass.size(), 4u);
+  EXPECT_NEAR(cascadeMagnitudeDb(highPass, 1000.0, fs), -3.0102999566, 1e-8);
+  EXPECT_NEAR(cascadeMagnitudeDb(highPass, 23999.0, fs), 0.0, 1e-6);
+
+  for (int order : { 3, 4, 7, 10 })
+  {
+    auto chebyshev1 = IIR::ChebyshevISos(SosBand::LowPass, order, 1.0, 1000.0, fs);
+    auto chebyshev2 = IIR::ChebyshevIISos(SosBand::LowPass, order, 40.0, 1000.0, fs);
+    auto elliptic = IIR::EllipticSos(SosBand::LowPass, order, 0.5, 60.0, 1000.0, fs);
+
+    EXPECT_NEAR(cascadeMagnitudeDb(chebyshev1, 1000.0, fs), -1.0, 1e-8);
+    EXPECT_NEAR(cascadeMagnitudeDb(chebyshev2, 1000.0, fs), -40.0, 1e-8);
+    EXPECT_NEAR(cascadeMagnitudeDb(elliptic, 1000.0, fs), -0.5, 1e-8);
+
+    for (double frequency = 5.0; frequency < 1000.0; frequency += 5.0)
+    {
+      double db1 = cascadeMagnitudeDb(chebyshev1, frequency, fs);
+      double dbElliptic = cascadeMagnitudeDb(elliptic, frequency, fs);
+      EXPECT_TRUE(db1 >= -1.0 - 1e-8 && db1 <= 1e-8);
+      EXPECT_TRUE(dbElliptic >= -0.5 - 1e-8 && dbElliptic <= 1e-8);
+    }
+
+    for (double frequency = 1000.0; frequency < 24000.0; frequency += 50.0)
+    {
+      EXPECT_LE(cascadeMagnitudeDb(chebyshev2, frequency, fs), -40.0 + 1e-8);
+    }
+
+    if (order >= 4)
+    {
+      for (double frequency = 3000.0; frequency < 24000.0; frequency += 50.0)
+      {
+        EXPECT_LE(cascadeMagnitudeDb(elliptic, frequency, fs), -60.0 + 1e-8);
+      }
+    }
+  }
+
+  auto bandPass = IIR::EllipticSos(SosBand::BandPass, 6, 0.5, 60.0, 1000.0, fs, 2000.0);
+  EXPECT_EQ(bandPass.size(), 6u);
+  EXPECT_NEAR(cascadeMagnitudeDb(bandPass, 1000.0, fs), -0.5, 1e-7);
+  EXPECT_NEAR(cascadeMagnitudeDb(bandPass, 2000.0, fs), -0.5, 1e-7);
+  EXPECT_LE(cascadeMagnitudeDb(bandPass, 300.0, fs), -60.0);
+  EXPECT_LE(cascadeMagnitudeDb(bandPass, 6000.0, fs), -60.0);
+
+  auto bandStop = IIR::ChebyshevISos(SosBand::BandStop, 5, 0.5, 1000.0, fs, 2000.0);
+  EXPECT_EQ(bandStop.size(), 5u);
+  EXPECT_NEAR(cascadeMagnitudeDb(bandStop, 1000.0, fs), -0.5, 1e-7);
+  EXPECT_NEAR(cascadeMagnitudeDb(bandStop, 2000.0, fs), -0.5, 1e-7);
+  EXPECT_LE(cascadeMagnitudeDb(bandStop, 1414.0, fs), -100.0);
+
+  auto wideBand = IIR::ButterworthSos(SosBand::BandPass, 64, 1000.0, fs, 3000.0);
+  EXPECT_EQ(wideBand.size(), 64u);
+  EXPECT_NEAR(cascadeMagnitudeDb(wideBand, 1000.0, fs), -3.0102999566, 1e-6);
+  EXPECT_NEAR(cascadeMagnitudeDb(wideBand, 3000.0, fs), -3.0102999566, 1e-6);
+
+  // Ordering and scaling keep the level after every section near unity.
+  auto elliptic32 = IIR::EllipticSos(SosBand::LowPass, 32, 0.1, 100.0, 1000.0, fs);
+  double worstInternal = 0;
+  for (double frequency = 1.0; frequency < 24000.0; frequency += 7.0)
+  {
+    double peak;
+    cascadeMagnitudeDb(elliptic32, frequency, fs, &peak);
+    worstInternal = std::max(worstInternal, peak);
+  }
+  EXPECT_LE(worstInternal, 1.0 + 1e-6);
+  EXPECT_LE(cascadeMagnitudeDb(elliptic32, 1100.0, fs), -100.0);
+
+  EXPECT_THROW(IIR::ButterworthSos(SosBand::LowPass, 65, 1000.0, fs), std::invalid_argument);
+  EXPECT_THROW(IIR::ButterworthSos(SosBand::BandPass, 4, 1000.0, fs, 500.0), std::invalid_argument);
+  EXPECT_THROW(IIR::EllipticSos(SosBand::LowPass, 4, 3.0, 2.0, 1000.0, fs), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_EqFit)
+{
+  using namespace DigitalFilters;
+  using IIR::FilterType;
+  const double fs = 48000.0;
+
+  std::vector<IIR::EqFitBand<double>> truth = {
+    { FilterType::LowShelfQ, 4.0, 120.0, 0.7 },
+    { FilterType::PeakEq, -6.0, 300.0, 2.0 },
+    { FilterType::PeakEq, 3.0, 1000.0, 1.0 },
+    { FilterType::PeakEq, -4.0, 3500.0, 4.0 },
+    { FilterType::PeakEq, 5.0, 8000.0, 1.5 },
+    { FilterType::HighShelfQ, -3.0, 12000.0, 0.7 } };
+
+  IIR::EqFitResult<double> reference;
+  reference.bands = truth;
+  auto truthBiquads = reference.Biquads(fs);
+
+  std::vector<double> frequencies, target;
+  for (int idx = 0; idx < 1000; idx++)
+  {
+    frequencies.push_back(20.0 * std::pow(1000.0, idx / 999.0));
+    target.push_back(cascadeMagnitudeDb(truthBiquads, frequencies.back(), fs));
+  }
+
+  IIR::EqFitOptions<double> options;
+  options.bands = 6;
+  options.starts = 8;
+  options.tolerance = 1e-9;
+
+  auto fit = IIR::FitEq<double>(frequencies, target, options);
+  auto again = IIR::FitEq<double>(frequencies, target, options);
+
+  EXPECT_LT(fit.rmsErrorDb, 1e-3);
+  EXPECT_EQ(fit.start, again.start);
+  EXPECT_EQ(fit.rmsErrorDb, again.rmsErrorDb);
+
+  auto fitted = fit.Biquads(fs);
+  for (size_t idx = 0; idx < frequencies.size(); idx += 37)
+  {
+    EXPECT_NEAR(cascadeMagnitudeDb(fitted, frequencies[idx], fs), target[idx], 1e-2);
+  }
+
+  // Analytic band derivatives against central differences.
+  for (auto type : { FilterType::PeakEq, FilterType::LowShelfQ, FilterType::HighShelfQ })
+    for (double gain : { -6.0, 4.0 })
+    {
+      IIR::EqFitBand<double> band{ type, gain, 1200.0, 1.3 };
+      double omega = HzToOmega(900.0) / fs;
+      IIR::Detail::EqFitPoint<double> point{ std::cos(omega), std::sin(omega),
+        std::cos(2 * omega), std::sin(2 * omega) };
+
+      double gradient[3];
+      double value = IIR::Detail::EqBandResponse(
+        IIR::Detail::MakeEqBandTerms(band, fs), point, gradient);
+      EXPECT_NEAR(value, GainTodB(std::abs(CalcFreqResponse(
+        IIR::Design(type, gain, 1200.0, 1.3, fs), omega))), 1e-10);
+
+      for (int parameter = 0; parameter < 3; parameter++)
+      {
+        const double h = 1e-6;
+        auto up = band, down = band;
+        if (parameter == 0) { up.gain += h; down.gain -= h; }
+        if (parameter == 1) { up.Fc *= std::exp(h); down.Fc *= std::exp(-h); }
+        if (parameter == 2) { up.Q *= std::exp(h); down.Q *= std::exp(-h); }
+
+        double difference = (IIR::Detail::EqBandResponse(IIR::Detail::MakeEqBandTerms(up, fs),
+          point, static_cast<double*>(nullptr)) - IIR::Detail::EqBandResponse(
+            IIR::Detail::MakeEqBandTerms(down, fs), point, static_cast<double*>(nullptr))) / (2 * h);
+        EXPECT_NEAR(gradient[parameter], difference, 1e-6);
+      }
+    }
+
+  std::vector<double> shortTarget(10);
+  EXPECT_THROW(IIR::FitEq<double>(frequencies, shortTarget, options), std::invalid_argument);
+
+  // Fc range empty after the 0.45 * Fs limit, and weights summing to 0.
+  auto lowRate = options;
+  lowRate.Fs = 40.0;
+  EXPECT_THROW(IIR::FitEq<double>(frequencies, target, lowRate), std::invalid_argument);
+
+  std::vector<double> weights(frequencies.size(), 0.0);
+  EXPECT_THROW(IIR::FitEq<double>(frequencies, target, options, weights), std::invalid_argument);
+  weights[0] = -1.0;
+  weights[1] = 2.0;
+  EXPECT_THROW(IIR::FitEq<double>(frequencies, target, options, weights), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_EqFitRandomWalk)
+{
+  std::vector<double> frequencies, target;
+  std::mt19937 generator(5);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  double walk = 0;
+
+  for (int idx = 0; idx < 1000; idx++)
+  {
+    frequencies.push_back(20.0 * std::pow(1000.0, idx / 999.0));
+    walk = 0.97 * walk + 0.5 * noise(generator);
+    target.push_back(walk + 3.0 * std::sin(idx / 60.0));
+  }
+
+  IIR::EqFitOptions<double> options;
+  options.bands = 20;
+
+  // A rough target: 20 bands still fit it within 1 dB rms.
+  auto fit = IIR::FitEq<double>(frequencies, target, options);
+
+  EXPECT_EQ(fit.bands.size(), 20u);
+  EXPECT_LT(fit.rmsErrorDb, 1.0);
+}
+
+
+TEST(DigitalFiltersTEST, Test_Jacobian)
+{
+  using IIR::FilterType;
+  const double fs = 48000.0;
+  const double q = 1.3;
+
+  auto coefficients = [](const BiquadCoefficientsd& biquad)
+  {
+    return std::array<double, 5>{ biquad.a0, biquad.a1, biquad.a2, biquad.b1, biquad.b2 };
+  };
+
+  auto partialCoefficients = [](const IIR::BiquadPartial<double>& partial)
+  {
+    return std::array<double, 5>{ partial.a0, partial.a1, partial.a2, partial.b1, partial.b2 };
+  };
+
+  // Coefficient partials of every designer against central differences.
+  for (int type = 0; type <= static_cast<int>(FilterType::PeakEq); type++)
+    for (double gain : { -6.0, 4.0 })
+      for (double fc : { 90.0, 2500.0, 15000.0 })
+      {
+        auto filterType = static_cast<FilterType>(type);
+        auto sensitivity = IIR::DesignSensitivity(filterType, gain, fc, q, fs);
+
+        auto expected = coefficients(IIR::Design(filterType, gain, fc, q, fs));
+        auto actual = coefficients(sensitivity.biquad);
+        for (int k = 0; k < 5; k++)
+        {
+          EXPECT_NEAR(actual[k], expected[k], 1e-12);
+        }
+
+        for (int parameter = 0; parameter < 3; parameter++)
+        {
+          double g = gain, f = fc, r = q, h = 0;
+          if (parameter == 0) { h = 1e-5; }
+          if (parameter == 1) { h = 1e-5 * fc; }
+          if (parameter == 2) { h = 1e-5 * q; }
+
+          auto up = coefficients(IIR::Design(filterType,
+            g + (parameter == 0 ? h : 0), f + (parameter == 1 ? h : 0), r + (parameter == 2 ? h : 0), fs));
+          auto down = coefficients(IIR::Design(filterType,
+            g - (parameter == 0 ? h : 0), f - (parameter == 1 ? h : 0), r - (parameter == 2 ? h : 0), fs));
+          auto analytic = partialCoefficients(sensitivity.partials[parameter]);
+
+          for (int k = 0; k < 5; k++)
+          {
+            double difference = (up[k] - down[k]) / (2 * h);
+            EXPECT_NEAR(analytic[k], difference, 1e-6 * (1 + std::abs(difference)))
+              << "type " << type << " gain " << gain << " fc " << fc << " parameter " << parameter;
+          }
+        }
+      }
+
+  // Cascade Jacobian against central differences of the response.
+  std::vector<std::array<double, 3>> bands = {
+    { -3.0, 120.0, 0.8 }, { 5.0, 1000.0, 2.0 }, { -8.0, 6000.0, 0.7 } };
+  std::vector<FilterType> types = { FilterType::LowShelfQ, FilterType::PeakEq, FilterType::HighShelfQ };
+  std::vector<double> omegas;
+  for (double frequency : { 40.0, 300.0, 1100.0, 4000.0, 12000.0 })
+  {
+    omegas.push_back(HzToOmega(frequency) / fs);
+  }
+
+  auto design = [&](const std::vector<std::array<double, 3>>& parameters)
+  {
+    std::vector<IIR::BiquadSensitivity<double>> sections;
+    for (size_t s = 0; s < parameters.size(); s++)
+    {
+      sections.push_back(IIR::DesignSensitivity(types[s], parameters[s][0], parameters[s][1], parameters[s][2], fs));
+    }
+    return sections;
+  };
+
+  auto sections = design(bands);
+  for (auto scale : { Eval::MagnitudeScale::Linear, Eval::MagnitudeScale::Decibels })
+  {
+    auto jacobian = Eval::CalcResponseJacobian<double>(sections, omegas, scale);
+    ASSERT_EQ(jacobian.rows, omegas.size());
+    ASSERT_EQ(jacobian.columns, 9u);
+
+    for (size_t i = 0; i < omegas.size(); i++)
+    {
+      double magnitude = 1;
+      for (auto& section : sections)
+      {
+        magnitude *= CalcFreqResponseTrig(section.biquad, omegas[i]).magnitude;
+      }
+      EXPECT_NEAR(jacobian.magnitude[i],
+        scale == Eval::MagnitudeScale::Decibels ? GainTodB(magnitude) : magnitude, 1e-10);
+
+      for (size_t column = 0; column < jacobian.columns; column++)
+      {
+        const double h = 1e-6 * (1 + std::abs(bands[column / 3][column % 3]));
+        auto up = bands, down = bands;
+        up[column / 3][column % 3] += h;
+        down[column / 3][column % 3] -= h;
+
+        auto upJacobian = Eval::CalcResponseJacobian<double>(design(up), omegas, scale);
+        auto downJacobian = Eval::CalcResponseJacobian<double>(design(down), omegas, scale);
+
+        double magnitudeDifference = (upJacobian.magnitude[i] - downJacobian.magnitude[i]) / (2 * h);
+        double phaseDifference = (upJacobian.phase[i] - downJacobian.phase[i]) / (2 * h);
+        EXPECT_NEAR(jacobian.MagnitudeDerivative(i, column), magnitudeDifference,
+          1e-6 * (1 + std::abs(magnitudeDifference)));
+        EXPECT_NEAR(jacobian.PhaseDerivative(i, column), phaseDifference,
+          1e-6 * (1 + std::abs(phaseDifference)));
+      }
+    }
+  }
+}
+
+
+TEST(DigitalFiltersTEST, Test_PolesZerosStability)
+{
+  auto peak = IIR::PeakEq(6.0, 1000.0, 2.0, 48000.0);
+
+  // Allocation free roots agree with the vector API and satisfy the polynomials.
+  auto poles = peak.Poles();
+  auto zeros = peak.Zeros();
+  ASSERT_EQ(poles.size(), 2u);
+  ASSERT_EQ(zeros.size(), 2u);
+  EXPECT_EQ(peak.calculatePoles().size(), 2u);
+  EXPECT_EQ(peak.calculatePoles()[0], poles[0]);
+  EXPECT_EQ(peak.calculateZeros()[1], zeros[1]);
+
+  for (auto& pole : poles)
+  {
+    auto value = peak.b0 * pole * pole + peak.b1 * pole + peak.b2;
+    EXPECT_NEAR(std::abs(value), 0.0, 1e-12);
+    EXPECT_LT(std::abs(pole), 1.0);
+  }
+  for (auto& zero : zeros)
+  {
+    auto value = peak.a0 * zero * zero + peak.a1 * zero + peak.a2;
+    EXPECT_NEAR(std::abs(value), 0.0, 1e-12);
+  }
+
+  auto lowPass = IIR::LowPass1stOrder(1000.0, 48000.0);
+  ASSERT_EQ(lowPass.Poles().size(), 1u);
+  EXPECT_NEAR(lowPass.Poles()[0].real(), -lowPass.b1, 1e-15);
+
+  auto numerator = peak.Numerator();
+  EXPECT_EQ(numerator[2], peak.a2);
+  EXPECT_EQ(peak.Denominator()[0], 1.0);
+  EXPECT_NEAR(std::abs(CalcFreqResponse<double>(numerator, peak.Denominator(), 0.3)
+    - CalcFreqResponse(peak, 0.3)), 0.0, 1e-15);
+
+  // Coefficient tests against the pole / zero radii.
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> coefficient(-2.5, 2.5);
+  const size_t count = 10000;
+  std::vector<double> a0(count), a1(count), a2(count), b1(count), b2(count);
+  std::vector<BiquadCoefficientsd> biquads(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    biquads[i] = BiquadCoefficientsd(coefficient(generator), coefficient(generator),
+      coefficient(generator), coefficient(generator), coefficient(generator));
+    a0[i] = biquads[i].a0; a1[i] = biquads[i].a1; a2[i] = biquads[i].a2;
+    b1[i] = biquads[i].b1; b2[i] = biquads[i].b2;
+  }
+
+  std::vector<std::uint8_t> stable(count), minimumPhase(count), aos(count);
+  size_t unstable = CheckStability<double>(b1, b2, stable);
+  size_t failing = CheckMinimumPhase<double>(a0, a1, a2, minimumPhase);
+
+  size_t expectedUnstable = 0, expectedFailing = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    double poleRadius = 0, zeroRadius = 0;
+    for (auto& pole : biquads[i].Poles()) poleRadius = std::max(poleRadius, std::abs(pole));
+    for (auto& zero : biquads[i].Zeros()) zeroRadius = std::max(zeroRadius, std::abs(zero));
+
+    EXPECT_EQ(stable[i] != 0, poleRadius < 1.0) << i;
+    EXPECT_EQ(minimumPhase[i] != 0, zeroRadius < 1.0) << i;
+    EXPECT_EQ(IsStable(biquads[i]), stable[i] != 0);
+    expectedUnstable += poleRadius >= 1.0;
+    expectedFailing += zeroRadius >= 1.0;
+  }
+  EXPECT_EQ(unstable, expectedUnstable);
+  EXPECT_EQ(failing, expectedFailing);
+  EXPECT_GT(unstable, 0u);
+  EXPECT_LT(unstable, count);
+
+  EXPECT_EQ(CheckStability<double>(biquads, aos), unstable);
+  EXPECT_EQ(aos, stable);
+  EXPECT_EQ(CheckMinimumPhase<double>(biquads, aos), failing);
+  EXPECT_EQ(aos, minimumPhase);
+
+  // Notch zeros lie on the unit circle.
+  EXPECT_FALSE(IsMinimumPhase(IIR::Notch(1000.0, 2.0, 48000.0)));
+  EXPECT_TRUE(IsStable(IIR::Notch(1000.0, 2.0, 48000.0)));
+
+  std::vector<std::uint8_t> shortResult(10);
+  EXPECT_THROW(CheckStability<double>(b1, b2, shortResult), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_StabilityCheckRandom)
+{
+  const size_t count = 1 << 20;
+  std::mt19937 generator(4);
+  std::uniform_real_distribution<double> coefficient(-2.0, 2.0);
+  std::vector<double> b1(count), b2(count);
+  std::vector<std::uint8_t> stable(count);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    b1[i] = coefficient(generator);
+    b2[i] = coefficient(generator);
+  }
+
+  // The stability triangle covers a quarter of [-2, 2]^2.
+  const size_t unstable = CheckStability<double>(b1, b2, stable);
+  EXPECT_NEAR(static_cast<double>(unstable) / count, 0.75, 0.005);
+  for (size_t i = 0; i < count; i += 997)
+  {
+    EXPECT_EQ(stable[i] != 0, IsStable(BiquadCoefficientsd(1.0, 0.0, 0.0, b1[i], b2[i])));
+  }
+}
+
+
+TEST(DigitalFiltersTEST, Test_ParallelForm)
+{
+  const double fs = 48000.0;
+
+  std::vector<std::vector<BiquadCoefficientsd>> cascades = {
+    IIR::LowPassCascadeAsButterworth<double>(8, 1000.0, fs),
+    IIR::LowPassCascadeAsButterworth<double>(16, 4000.0, fs),
+    IIR::HighPassCascadeAsButterworth<double>(8, 300.0, fs),
+    IIR::EllipticSos(IIR::SosBand::BandPass, 8, 0.5, 60.0, 1000.0, fs, 2000.0),
+    { IIR::LowPass1stOrder(500.0, fs), IIR::PeakEq(6.0, 2000.0, 3.0, fs), IIR::OnePoleHighPass(50.0, fs) } };
+
+  for (auto& cascade : cascades)
+  {
+    auto form = IIR::ToParallelForm<double>(cascade);
+
+    // Frequency response.
+    for (double frequency : { 20.0, 700.0, 1500.0, 5000.0, 20000.0 })
+    {
+      double omega = HzToOmega(frequency) / fs;
+      std::complex<double> expected = 1;
+      for (auto& section : cascade)
+      {
+        expected *= CalcFreqResponse(section, omega);
+      }
+      EXPECT_NEAR(std::abs(form.Response(omega) - expected), 0.0, 1e-10);
+    }
+
+    // Sample by sample against the serial cascade, processed in place.
+    IIR::CascadeProcessor<double> serial(cascade);
+    IIR::ParallelProcessor<double> parallel(form);
+    std::mt19937 generator(8);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<double> expected(4096), actual(4096);
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+      expected[i] = actual[i] = noise(generator);
+    }
+
+    serial.Process(expected, expected);
+    parallel.Process(actual, actual);
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+      ASSERT_NEAR(actual[i], expected[i], 1e-10) << i;
+    }
+
+    parallel.Reset();
+    serial.Reset();
+    EXPECT_NEAR(parallel.Process(1.0), serial.Process(1.0), 1e-12);
+  }
+
+  // Partial fractions need distinct poles.
+  auto section = IIR::LowPass(1000.0, 0.707, fs);
+  std::vector<BiquadCoefficientsd> repeated = { section, section };
+  EXPECT_THROW(IIR::ToParallelForm<double>(repeated), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_FixedCascade)
+{
+  const double fs = 48000.0;
+  auto sections = IIR::LowPassCascadeAsButterworth<double>(8, 2000.0, fs);
+
+  IIR::Cascade<double, 4> cascade(sections);
+  IIR::CascadeProcessor<double> reference(sections);
+  static_assert(IIR::Cascade<double, 4>::Sections == 4);
+  EXPECT_EQ(cascade.Section(2).a1, sections[2].a1);
+
+  std::mt19937 generator(10);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<double> input(1000), output(1000);
+  for (auto& sample : input)
+  {
+    sample = noise(generator);
+  }
+
+  // Block and per-sample processing continue from the same state.
+  cascade.Process(std::span<const double>(input).first(500), std::span<double>(output).first(500));
+  for (size_t i = 500; i < input.size(); i++)
+  {
+    output[i] = cascade.Process(input[i]);
+  }
+
+  for (size_t i = 0; i < input.size(); i++)
+  {
+    ASSERT_EQ(output[i], reference.Process(input[i])) << i;
+  }
+
+  cascade.Reset();
+  reference.Reset();
+  EXPECT_EQ(cascade.Process(1.0), reference.Process(1.0));
+
+  IIR::Cascade<float, 2> identity;
+  EXPECT_EQ(identity.Process(0.25f), 0.25f);
+
+  IIR::Cascade<double, 2> fromArray(std::array<BiquadCoefficientsd, 2>{
+    IIR::PeakEq(3.0, 100.0, 1.0, fs), IIR::HighShelf(-2.0, 8000.0, fs) });
+  EXPECT_EQ(fromArray.Section(1).b2, IIR::HighShelf(-2.0, 8000.0, fs).b2);
+
+  EXPECT_THROW((IIR::Cascade<double, 3>(sections)), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_BiquadBank)
+{
+  const double fs = 48000.0;
+  std::vector<BiquadCoefficientsd> biquads;
+  for (int i = 0; i < 37; i++)
+  {
+    biquads.push_back(IIR::PeakEq(i % 7 - 3.0, 50.0 + 500.0 * i, 0.5 + i * 0.1, fs));
+  }
+
+  IIR::BiquadBank<double> bank(biquads);
+  EXPECT_EQ(bank.size(), 37u);
+  EXPECT_EQ(bank.PaddedSize(), 40u);
+  EXPECT_EQ(bank.MemoryBytes(), 5 * 40 * sizeof(double));
+  EXPECT_EQ(IIR::BiquadBank<float>::Lanes, 16u);
+
+  auto spans = bank.Spans();
+  for (auto coefficients : { spans.a0, spans.a1, spans.a2, spans.b1, spans.b2 })
+  {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(coefficients.data()) % 64, 0u);
+  }
+
+  // Round trip and padding.
+  auto back = bank.ToBiquads();
+  ASSERT_EQ(back.size(), biquads.size());
+  for (size_t i = 0; i < biquads.size(); i++)
+  {
+    EXPECT_EQ(back[i].a0, biquads[i].a0);
+    EXPECT_EQ(back[i].b2, biquads[i].b2);
+    EXPECT_EQ(bank[i].a1, biquads[i].a1);
+  }
+  auto padded = bank.PaddedSpans();
+  EXPECT_EQ(padded.a0[39], 1.0);
+  EXPECT_EQ(padded.b1[39], 0.0);
+
+  // Float storage of double designs.
+  IIR::BiquadBank<float> floatBank(biquads);
+  EXPECT_EQ(floatBank.MemoryBytes(), 5 * 48 * sizeof(float));
+  EXPECT_EQ(floatBank[5].b1, static_cast<float>(biquads[5].b1));
+
+  // Bank evaluator against CalcFreqResponseTrig.
+  double omega = HzToOmega(1234.0) / fs;
+  std::vector<double> magnitude(bank.size());
+  CalcMagnitudeResponse(bank, omega, std::span<double>(magnitude));
+  for (size_t i = 0; i < bank.size(); i++)
+  {
+    EXPECT_NEAR(magnitude[i], CalcFreqResponseTrig(biquads[i], omega).magnitude, 1e-12);
+  }
+
+  // Designed in place by the batch designers, checked by the batch checkers.
+  std::vector<double> gain(bank.size(), 6.0), fc(bank.size(), 1000.0), q(bank.size(), 2.0), rate(bank.size(), fs);
+  IIR::PeakEqBatch<double>(gain, fc, q, rate, bank.Spans());
+  EXPECT_NEAR(bank[3].a0, IIR::PeakEq(6.0, 1000.0, 2.0, fs).a0, 1e-12);
+
+  std::vector<std::uint8_t> stable(bank.PaddedSize());
+  auto view = std::as_const(bank).PaddedSpans();
+  EXPECT_EQ(CheckStability(view.b1, view.b2, std::span<std::uint8_t>(stable)), 0u);
+
+  // Copies are deep, moves leave an empty bank.
+  IIR::BiquadBank<double> copy = bank;
+  copy.Set(0, IIR::LowPass(100.0, 0.7, fs));
+  EXPECT_NE(copy[0].a0, bank[0].a0);
+  IIR::BiquadBank<double> moved = std::move(copy);
+  EXPECT_EQ(copy.size(), 0u);
+  EXPECT_EQ(moved.size(), 37u);
+  EXPECT_THROW(moved.Set(37, biquads[0]), std::out_of_range);
+}
+
+
+TEST(DigitalFiltersTEST, Test_BiquadBankMagnitude)
+{
+  const size_t count = 100000;
+  const double fs = 48000.0;
+  std::vector<BiquadCoefficientsd> biquads(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    biquads[i] = IIR::PeakEq(static_cast<double>(i % 13) - 6.0, 20.0 + i % 20000, 1.0, fs);
+  }
+
+  IIR::BiquadBank<double> bank(biquads);
+  IIR::BiquadBank<float> floatBank(biquads);
+  std::vector<double> magnitude(count);
+  std::vector<float> floatMagnitude(count);
+  const double omega = 0.1;
+
+  // The bank kernels against the scalar evaluator on the array of structures.
+  CalcMagnitudeResponse(bank, omega, std::span<double>(magnitude));
+  CalcMagnitudeResponse(floatBank, 0.1f, std::span<float>(floatMagnitude));
+  for (size_t i = 0; i < count; i += 7)
+  {
+    const double expected = std::abs(Eval::CalcFreqResponse(biquads[i], omega));
+    ASSERT_NEAR(magnitude[i], expected, 1e-12 * expected) << i;
+    ASSERT_NEAR(floatMagnitude[i], expected, 1e-4 * expected) << i;
+  }
+
+  EXPECT_LT(bank.MemoryBytes(), count * sizeof(BiquadCoefficientsd));
+  EXPECT_LT(floatBank.MemoryBytes(), bank.MemoryBytes() / 2 + 64 * 5);
+}
+
+
+// ISO 1/3 octave graphic EQ, 31 bands from 20 Hz to 20 kHz.
+std::vector<IIR::EqBandSettings<double>> graphicEq(int activeEvery)
+{
+  std::vector<IIR::EqBandSettings<double>> bands;
+  for (int band = 0; band < 31; band++)
+  {
+    double gain = band % activeEvery == 0 ? ((band * 7) % 13 - 6.0) : 0.0;
+    bands.push_back({ IIR::FilterType::PeakEq, gain, 20.0 * std::pow(2.0, band / 3.0), 4.32, false });
+  }
+  return bands;
+}
+
+
+TEST(DigitalFiltersTEST, Test_EqBank)
+{
+  const double fs = 48000.0;
+  auto bands = graphicEq(2);
+  bands[4].bypass = true;
+  bands[6].gain = 0.001;
+
+  IIR::EqBankProcessor<double> mono(bands, fs);
+
+  // Reference: the non flat, non bypassed bands in series.
+  std::vector<BiquadCoefficientsd> sections;
+  for (auto& band : bands)
+  {
+    if (!band.bypass && std::abs(band.gain) >= 0.01)
+    {
+      sections.push_back(IIR::Design(band.type, band.gain, band.Fc, band.Q, fs));
+    }
+  }
+  EXPECT_EQ(mono.Bands(), 31u);
+  EXPECT_EQ(mono.ActiveBands(), sections.size());
+  EXPECT_LT(mono.ActiveBands(), 16u);
+
+  IIR::CascadeProcessor<double> reference(sections);
+  std::mt19937 generator(12);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  const size_t frames = 2048;
+  std::vector<double> input(frames), output(frames);
+  for (auto& sample : input)
+  {
+    sample = noise(generator);
+  }
+
+  mono.Process(input, output);
+  for (size_t f = 0; f < frames; f++)
+  {
+    ASSERT_NEAR(output[f], reference.Process(input[f]), 1e-12) << f;
+  }
+
+  // Multichannel: every channel matches an independent mono processor.
+  const size_t channels = 6;
+  IIR::EqBankProcessor<double> multi(bands, fs, channels);
+  std::vector<std::vector<double>> planar(channels, std::vector<double>(frames));
+  std::vector<const double*> inputs;
+  std::vector<double*> outputs;
+  for (auto& channel : planar)
+  {
+    for (auto& sample : channel)
+    {
+      sample = noise(generator);
+    }
+  }
+  auto original = planar;
+  for (auto& channel : planar)
+  {
+    inputs.push_back(channel.data());
+    outputs.push_back(channel.data());
+  }
+  multi.Process(inputs, outputs, frames);
+
+  for (size_t ch = 0; ch < channels; ch++)
+  {
+    IIR::EqBankProcessor<double> single(bands, fs);
+    std::vector<double> expected(frames);
+    single.Process(original[ch], expected);
+    for (size_t f = 0; f < frames; f += 17)
+    {
+      ASSERT_NEAR(planar[ch][f], expected[f], 1e-12);
+    }
+  }
+
+  EXPECT_EQ(multi.Cost().frames, frames);
+  EXPECT_EQ(multi.Cost().channels, channels);
+  EXPECT_GT(multi.Cost().NanosecondsPerChannelBand(), 0.0);
+
+  // Retuning a band changes the active set.
+  size_t before = mono.ActiveBands();
+  auto band = mono.Band(1);
+  band.gain = 3.0;
+  mono.SetBand(1, band);
+  EXPECT_EQ(mono.ActiveBands(), before + 1);
+  band.bypass = true;
+  mono.SetBand(1, band);
+  EXPECT_EQ(mono.ActiveBands(), before);
+
+  EXPECT_THROW(multi.Process(input, output), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_Crossover)
+{
+  const double fs = 48000.0;
+  std::mt19937 generator(14);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  const size_t frames = 4096;
+  std::vector<double> input(frames);
+  for (auto& sample : input)
+  {
+    sample = noise(generator);
+  }
+
+  // Two bands: plain LR4 low and high pass.
+  {
+    IIR::LinkwitzRileyCrossover<double> crossover(std::vector<double>{ 1000.0 }, fs);
+    std::vector<double> low(frames), high(frames);
+    std::vector<std::span<double>> outputs{ low, high };
+    crossover.Process(input, outputs);
+
+    auto lp = IIR::LowPass12dbOct(1000.0, fs);
+    auto hp = IIR::HighPass12dbOct(1000.0, fs);
+    IIR::CascadeProcessor<double> lowReference({ lp, lp }), highReference({ hp, hp });
+    for (size_t i = 0; i < frames; i++)
+    {
+      ASSERT_NEAR(low[i], lowReference.Process(input[i]), 1e-12);
+      ASSERT_NEAR(high[i], highReference.Process(input[i]), 1e-12);
+    }
+  }
+
+  // Several bands sum to the allpass chain of all the crossovers.
+  for (std::vector<double> frequencies : { std::vector<double>{ 200.0, 2000.0 },
+    std::vector<double>{ 80.0, 250.0, 800.0, 2500.0, 8000.0 },
+    std::vector<double>{ 60.0, 120.0, 250.0, 500.0, 1000.0, 4000.0, 12000.0 } })
+  {
+    IIR::LinkwitzRileyCrossover<double> crossover(frequencies, fs);
+    EXPECT_EQ(crossover.Bands(), frequencies.size() + 1);
+
+    std::vector<std::vector<double>> bands(crossover.Bands(), std::vector<double>(frames));
+    std::vector<std::span<double>> outputs(bands.begin(), bands.end());
+    crossover.Process(input, outputs);
+
+    std::vector<BiquadCoefficientsd> allPasses;
+    for (double fc : frequencies)
+    {
+      allPasses.push_back(IIR::AllPassQ(fc, 1 / std::sqrt(2.0), fs));
+    }
+    IIR::CascadeProcessor<double> reference(allPasses);
+
+    for (size_t i = 0; i < frames; i++)
+    {
+      double sum = 0;
+      for (auto& band : bands)
+      {
+        sum += band[i];
+      }
+      ASSERT_NEAR(sum, reference.Process(input[i]), 1e-10) << i;
+    }
+
+    // LR4: adjacent bands are -6 dB at their crossover (impulse response DFT).
+    crossover.Reset();
+    std::vector<double> impulse(frames, 0.0);
+    impulse[0] = 1;
+    crossover.Process(impulse, outputs);
+    auto magnitude = [&](const std::vector<double>& h, double f)
+    {
+      std::complex<double> sum = 0;
+      for (size_t n = 0; n < h.size(); n++)
+      {
+        sum += h[n] * std::polar(1.0, -2 * std::numbers::pi * f / fs * n);
+      }
+      return std::abs(sum);
+    };
+    for (size_t k = 0; k + 1 < frequencies.size(); k += 2)
+    {
+      EXPECT_NEAR(magnitude(bands[k], frequencies[k]), 0.5, 0.1);
+      EXPECT_NEAR(magnitude(bands[k + 1], frequencies[k]), 0.5, 0.1);
+    }
+  }
+
+  // In place on one of the outputs.
+  {
+    IIR::LinkwitzRileyCrossover<double> crossover(std::vector<double>{ 300.0, 3000.0 }, fs);
+    std::vector<double> low(input), middle(frames), high(frames);
+    std::vector<double> expectedLow(frames), expectedMiddle(frames), expectedHigh(frames);
+    std::vector<std::span<double>> expected{ expectedLow, expectedMiddle, expectedHigh };
+    crossover.Process(input, expected);
+    crossover.Reset();
+    std::vector<std::span<double>> outputs{ low, middle, high };
+    crossover.Process(low, outputs);
+    EXPECT_EQ(low, expectedLow);
+    EXPECT_EQ(high, expectedHigh);
+  }
+
+  std::vector<double> out(frames);
+  std::vector<std::span<double>> one{ out };
+  IIR::LinkwitzRileyCrossover<double> crossover(std::vector<double>{ 500.0 }, fs);
+  EXPECT_THROW(crossover.Process(input, one), std::invalid_argument);
+  EXPECT_THROW(IIR::LinkwitzRileyCrossover<double>(std::vector<double>{ 500.0, 400.0 }, fs), std::invalid_argument);
+  EXPECT_THROW(IIR::LinkwitzRileyCrossover<double>(std::vector<double>{}, fs), std::invalid_argument);
+  EXPECT_THROW(IIR::LinkwitzRileyCrossover<double>(std::vector<double>{ 30000.0 }, fs), std::invalid_argument);
+}
+
+
+// Halfband 0.5 * (A0(z^2) + z^-1 A1(z^2)) at the high rate, with the allpass
+// sections in z^-2.
+std::vector<double> halfbandFullRate(const std::vector<double>& coefficients, const std::vector<double>& input)
+{
+  std::vector<BiquadCoefficientsd> path0, path1;
+  for (size_t i = 0; i < coefficients.size(); i++)
+  {
+    (i % 2 == 0 ? path0 : path1).emplace_back(coefficients[i], 0.0, 1.0, 0.0, coefficients[i]);
+  }
+  IIR::CascadeProcessor<double> chain0(path0), chain1(path1);
+
+  std::vector<double> output(input.size());
+  double delayed = 0;
+  for (size_t n = 0; n < input.size(); n++)
+  {
+    const double y1 = chain1.Process(input[n]);
+    output[n] = 0.5 * (chain0.Process(input[n]) + delayed);
+    delayed = y1;
+  }
+  return output;
+}
+
+
+TEST(DigitalFiltersTEST, Test_Multirate)
+{
+  const double fs = 192000.0;
+  std::mt19937 generator(16);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<double> input(3001);
+  for (auto& sample : input)
+  {
+    sample = noise(generator);
+  }
+
+  auto convolve = [](const std::vector<double>& taps, const std::vector<double>& x)
+  {
+    std::vector<double> y(x.size(), 0.0);
+    for (size_t n = 0; n < x.size(); n++)
+      for (size_t k = 0; k < taps.size() && k <= n; k++)
+        y[n] += taps[k] * x[n - k];
+    return y;
+  };
+
+  // FIR decimation keeps every 4th output of the full rate filter, across
+  // blocks of any size.
+  auto taps = Multirate::LowPassTaps(63, 20000.0, fs);
+  {
+    auto full = convolve(taps, input);
+    Multirate::PolyphaseDecimator<double> decimator(taps, 4);
+    std::vector<double> output(input.size() / 4);
+    size_t written = 0;
+    for (size_t start = 0, block = 1; start < input.size(); start += block, block = block * 3 % 97 + 1)
+    {
+      const size_t size = std::min(block, input.size() - start);
+      std::span<const double> in(input.data() + start, size);
+      EXPECT_EQ(decimator.OutputSize(size), (start % 4 + size) / 4);
+      written += decimator.Process(in, std::span<double>(output).subspan(written));
+    }
+    ASSERT_EQ(written, output.size());
+    for (size_t m = 0; m < output.size(); m++)
+    {
+      ASSERT_NEAR(output[m], full[4 * m + 3], 1e-12) << m;
+    }
+  }
+
+  // FIR interpolation equals zero insertion followed by the filter.
+  {
+    std::vector<double> stuffed(3 * input.size(), 0.0), scaled(taps);
+    for (size_t n = 0; n < input.size(); n++)
+    {
+      stuffed[3 * n] = input[n];
+    }
+    for (auto& tap : scaled)
+    {
+      tap *= 3;
+    }
+    auto full = convolve(scaled, stuffed);
+
+    Multirate::PolyphaseInterpolator<double> interpolator(taps, 3);
+    std::vector<double> output(stuffed.size());
+    interpolator.Process(input, output);
+    for (size_t n = 0; n < output.size(); n++)
+    {
+      ASSERT_NEAR(output[n], full[n], 1e-12) << n;
+    }
+  }
+
+  // IIR halfband: low pass around Fs / 4.
+  auto coefficients = Multirate::HalfbandCoefficients(8, 0.05);
+  ASSERT_EQ(coefficients.size(), 8u);
+  for (double c : coefficients)
+  {
+    EXPECT_GT(c, 0.0);
+    EXPECT_LT(c, 1.0);
+  }
+  {
+    std::vector<double> impulse(8192, 0.0);
+    impulse[0] = 1;
+    auto h = halfbandFullRate(coefficients, impulse);
+    auto magnitude = [&](double f)
+    {
+      std::complex<double> sum = 0;
+      for (size_t n = 0; n < h.size(); n++)
+      {
+        sum += h[n] * std::polar(1.0, -2 * std::numbers::pi * f * n);
+      }
+      return std::abs(sum);
+    };
+    for (double f : { 0.0, 0.05, 0.1, 0.2 })
+    {
+      EXPECT_NEAR(magnitude(f), 1.0, 1e-3) << f;
+    }
+    for (double f : { 0.3, 0.35, 0.45, 0.5 })
+    {
+      EXPECT_LT(20 * std::log10(magnitude(f)), -60.0) << f;
+    }
+  }
+
+  // Halfband decimation keeps the odd outputs of the full rate filter.
+  {
+    auto full = halfbandFullRate(coefficients, input);
+    Multirate::HalfbandDecimator<double> decimator(coefficients);
+    std::vector<double> output(input.size() / 2);
+    size_t written = decimator.Process(std::span<const double>(input).first(1001), output);
+    written += decimator.Process(std::span<const double>(input).subspan(1001), std::span<double>(output).subspan(written));
+    ASSERT_EQ(written, output.size());
+    for (size_t m = 0; m < output.size(); m++)
+    {
+      ASSERT_NEAR(output[m], full[2 * m + 1], 1e-12) << m;
+    }
+  }
+
+  // Halfband interpolation: 2 * H on the zero stuffed input.
+  {
+    std::vector<double> stuffed(2 * input.size(), 0.0);
+    for (size_t n = 0; n < input.size(); n++)
+    {
+      stuffed[2 * n] = 2 * input[n];
+    }
+    auto full = halfbandFullRate(coefficients, stuffed);
+    Multirate::HalfbandInterpolator<double> interpolator(coefficients);
+    std::vector<double> output(stuffed.size());
+    interpolator.Process(input, output);
+    for (size_t n = 0; n < output.size(); n++)
+    {
+      ASSERT_NEAR(output[n], full[n], 1e-12) << n;
+    }
+  }
+
+  std::vector<double> small(2);
+  Multirate::PolyphaseDecimator<double> decimator(taps, 4);
+  EXPECT_THROW(decimator.Process(input, small), std::invalid_argument);
+  EXPECT_THROW(Multirate::PolyphaseDecimator<double>(taps, 0), std::invalid_argument);
+  EXPECT_THROW(Multirate::HalfbandCoefficients(4, 0.6), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_GoertzelBank)
+{
+  const double fs = 48000.0;
+  const size_t block = 960;
+
+  // Tones on and off the 50 Hz bins, DC and Nyquist included.
+  const std::vector<double> frequencies{ 0.0, 50.0, 1000.0, 1234.5, 7000.0, 24000.0 };
+  Eval::GoertzelBank<double> bank(frequencies, fs, block);
+  EXPECT_EQ(bank.Frequencies(), frequencies.size());
+
+  std::vector<double> input(3 * block + 100);
+  for (size_t n = 0; n < input.size(); n++)
+  {
+    const double t = n / fs;
+    input[n] = 0.25 + 0.5 * std::cos(2 * std::numbers::pi * 1000.0 * t + 0.3)
+      + 0.125 * std::cos(2 * std::numbers::pi * 7000.0 * t - 1.2);
+  }
+
+  // Fed in uneven chunks; every block reports the same tones.
+  size_t blocks = 0;
+  for (size_t start = 0, chunk = 1; start < input.size(); start += chunk, chunk = chunk * 5 % 331 + 1)
+  {
+    const size_t size = std::min(chunk, input.size() - start);
+    blocks += bank.Process(std::span<const double>(input.data() + start, size),
+      [&](std::span<const FrequencyResponse<double>> results)
+      {
+        ASSERT_EQ(results.size(), frequencies.size());
+        EXPECT_NEAR(results[0].magnitude, 0.25, 1e-9);
+        EXPECT_NEAR(results[1].magnitude, 0.0, 1e-9);
+        EXPECT_NEAR(results[2].magnitude, 0.5, 1e-9);
+        EXPECT_NEAR(results[4].magnitude, 0.125, 1e-9);
+        EXPECT_NEAR(results[5].magnitude, 0.0, 1e-9);
+      });
+  }
+  EXPECT_EQ(blocks, 3u);
+  EXPECT_EQ(bank.Position(), 100u);
+
+  // Phases of the last block: blocks start on whole periods of both tones.
+  EXPECT_NEAR(bank.Results()[2].phase, 0.3, 1e-9);
+  EXPECT_NEAR(bank.Results()[4].phase, -1.2, 1e-9);
+
+  // Any frequency matches the direct DFT sum of the block.
+  std::mt19937 generator(18);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<double> samples(block);
+  for (auto& sample : samples)
+  {
+    sample = noise(generator);
+  }
+  bank.Reset();
+  ASSERT_EQ(bank.Process(samples), 1u);
+  for (size_t k = 0; k < frequencies.size(); k++)
+  {
+    std::complex<double> sum = 0;
+    const double omega = Utils::HzToOmega(frequencies[k]) / fs;
+    for (size_t n = 0; n < block; n++)
+    {
+      sum += samples[n] * std::polar(1.0, -omega * n);
+    }
+    const double scale = (k == 0 || k + 1 == frequencies.size() ? 1.0 : 2.0) / block;
+    EXPECT_NEAR(bank.Results()[k].magnitude, std::abs(sum) * scale, 1e-10) << k;
+    if (std::abs(sum) > 1e-6)
+    {
+      EXPECT_NEAR(std::remainder(bank.Results()[k].phase - std::arg(sum), 2 * std::numbers::pi), 0.0, 1e-9) << k;
+    }
+  }
+
+  EXPECT_THROW(Eval::GoertzelBank<double>(std::vector<double>{ 30000.0 }, fs, block), std::invalid_argument);
+  EXPECT_THROW(Eval::GoertzelBank<double>(frequencies, fs, 0), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_Instrumentation)
+{
+  using namespace DigitalFilters::Instrumentation;
+
+  struct CountingSink : Sink
+  {
+    std::atomic<int> records{ 0 };
+    void Record(const CallRecord&) override { records++; }
+  } sink;
+
+  Reset();
+  SetSink(&sink);
+
+  const std::vector<double> numerator{ 0.2, 0.4, 0.2 };
+  const std::vector<double> denominator{ 1.0, -0.5, 0.3 };
+  std::vector<double> freqs(1000);
+  for (size_t i = 0; i < freqs.size(); i++)
+  {
+    freqs[i] = 20.0 * i;
+  }
+
+  IIRfreqResponse::EvalBicuad(0.2, 0.4, 0.2, -0.5, 0.3, 1000.0, 48000.0);
+  IIRfreqResponse::EvalBicuad(0.2, 0.4, 0.2, -0.5, 0.3, 2000.0, 48000.0);
+  auto response = IIRfreqResponse::FrequencyResponse(std::span<const double>(numerator),
+    std::span<const double>(denominator), freqs, 48000.0);
+
+  IIR::CascadeProcessor<double> cascade({ Biquad<double>(0.2, 0.4, 0.2, -0.5, 0.3) });
+  std::vector<double> samples(256, 1.0);
+  cascade.Process(std::span<const double>(samples), std::span<double>(samples));
+
+  SetSink(nullptr);
+  const Snapshot snapshot = TakeSnapshot();
+  const KernelStats& eval = snapshot[static_cast<size_t>(Kernel::EvalBicuad)];
+  const KernelStats& batch = snapshot[static_cast<size_t>(Kernel::FrequencyResponse)];
+  const KernelStats& process = snapshot[static_cast<size_t>(Kernel::CascadeProcess)];
+
+  if constexpr (Enabled)
+  {
+    EXPECT_EQ(eval.calls, 2u);
+    EXPECT_EQ(eval.points, 2u);
+
+    EXPECT_EQ(batch.calls, 1u);
+    EXPECT_EQ(batch.points, freqs.size());
+    EXPECT_EQ(batch.bytesAllocated, response.size() * sizeof(std::complex<double>));
+    EXPECT_EQ(batch.parallelCalls, 1u);
+    EXPECT_GT(batch.threadNanoseconds, 0u);
+    EXPECT_GE(batch.Imbalance(), 1.0);
+    EXPECT_GE(batch.wallNanoseconds, batch.maxThreadNanoseconds);
+
+    EXPECT_EQ(process.calls, 1u);
+    EXPECT_EQ(process.points, samples.size());
+    EXPECT_EQ(process.parallelCalls, 0u);
+
+    EXPECT_EQ(sink.records.load(), 4);
+
+    Reset();
+    EXPECT_EQ(Stats(Kernel::FrequencyResponse).calls, 0u);
+  }
+  else
+  {
+    for (const KernelStats& stats : snapshot)
+    {
+      EXPECT_EQ(stats.calls, 0u);
+      EXPECT_EQ(stats.points, 0u);
+      EXPECT_EQ(stats.wallNanoseconds, 0u);
+    }
+    EXPECT_EQ(sink.records.load(), 0);
+  }
+
+  EXPECT_STREQ(KernelName(Kernel::GoertzelProcess), "GoertzelProcess");
+}
+
+
+TEST(DigitalFiltersTEST, Test_AccuracySweep)
+{
+  Accuracy::LogHistogram histogram(2, -1, 4);
+  for (double value : { 0.0, 0.25, 0.5, 1.0, 3.0, 16.0, 17.0, std::numeric_limits<double>::infinity() })
+  {
+    histogram.Add(value);
+  }
+  auto counts = histogram.Counts();
+  ASSERT_EQ(counts.size(), 8u);
+  EXPECT_EQ(counts[0], 1u); // 0
+  EXPECT_EQ(counts[1], 2u); // 0.25, 0.5
+  EXPECT_EQ(counts[2], 1u); // 1
+  EXPECT_EQ(counts[4], 1u); // 3 in (2, 4]
+  EXPECT_EQ(counts[6], 1u); // 16
+  EXPECT_EQ(counts[7], 2u); // 17, inf
+  EXPECT_EQ(histogram.UpperBound(4), 4.0);
+  EXPECT_EQ(histogram.Quantile(0.5), 1.0);
+
+  Accuracy::SweepSettings settings;
+  settings.sampleRates = { 48000.0 };
+  settings.cutoffCount = 4;
+  settings.frequencyCount = 32;
+  settings.qs = { 0.7071, 4.0 };
+  settings.gains = { -12.0, 12.0 };
+
+  std::vector<Accuracy::Mode> modes = Accuracy::StandardModes();
+
+  // Evaluated in long double and rounded: within one ulp of the reference.
+  modes.push_back({ "long double", std::numeric_limits<double>::digits, Accuracy::ErrorSource::Evaluation,
+    modes[0].design,
+    [](const Biquad<double>& c, double fs, std::span<const double> frequencies,
+      std::span<FrequencyResponse<double>> responses)
+    {
+      const Biquad<long double> wide(c.a0, c.a1, c.a2, c.b1, c.b2);
+      for (size_t i = 0; i < frequencies.size(); i++)
+      {
+        const long double w = 2 * Constants::pi<long double>() * frequencies[i] / fs;
+        const std::complex<long double> h = Eval::CalcFreqResponse(wide, w);
+        responses[i] = FrequencyResponse<double>(static_cast<double>(std::abs(h)), static_cast<double>(std::arg(h)));
+      }
+    } });
+
+  const auto reports = Accuracy::RunSweep(settings, modes);
+  ASSERT_EQ(reports.size(), modes.size());
+
+  const uint64_t comparisons = Accuracy::ComparisonsPerMode(settings);
+  for (const auto& report : reports)
+  {
+    EXPECT_EQ(report.comparisons, comparisons) << report.name;
+    EXPECT_EQ(report.ulp.Total(), comparisons - report.skipped) << report.name;
+    EXPECT_EQ(report.decibels.Total(), comparisons - report.skipped) << report.name;
+    EXPECT_LT(report.skipped, comparisons / 10) << report.name;
+  }
+
+  // Only against the long double reference itself: the double-double one
+  // also sees the long double cancellation near DC.
+  if (!Accuracy::DoubleDoubleReference)
+  {
+    EXPECT_LE(reports.back().worstUlp.error, 1.0);
+  }
+
+  // Double evaluators and the Fast designers (documented bound 1e-4 dB).
+  for (size_t m : { 0, 1, 2, 3, 6 })
+  {
+    EXPECT_EQ(reports[m].nonFinite, 0u) << reports[m].name;
+    EXPECT_LT(reports[m].worstDecibels.error, 1e-4) << reports[m].name;
+    EXPECT_LT(reports[m].worstPhase.error, 1e-5) << reports[m].name;
+  }
+
+  EXPECT_THROW(Accuracy::RunSweep(Accuracy::SweepSettings{ .frequencyCount = 0 }, modes), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_AccuracyDoubleDouble)
+{
+  using Accuracy::Detail::DoubleDouble;
+
+  // TwoProd keeps the low half: (1 + 2^-30)^2 = 1 + 2^-29 + 2^-60.
+  const DoubleDouble square = DoubleDouble(1.0 + std::ldexp(1.0, -30)) * DoubleDouble(1.0 + std::ldexp(1.0, -30));
+  EXPECT_EQ(square.hi, 1.0 + std::ldexp(1.0, -29));
+  EXPECT_EQ(square.lo, std::ldexp(1.0, -60));
+
+  const DoubleDouble third = DoubleDouble(1.0) / 3.0;
+  EXPECT_LT(std::abs(static_cast<double>(third * 3.0 - 1.0)), 1e-31);
+  const DoubleDouble root = sqrt(DoubleDouble(2.0));
+  EXPECT_LT(std::abs(static_cast<double>(root * root - 2.0)), 1e-31);
+  EXPECT_EQ(Accuracy::Detail::Exponent(DoubleDouble(4.0, -1e-20)), 1);
+  EXPECT_EQ(Accuracy::Detail::Exponent(DoubleDouble(4.0, 1e-20)), 2);
+
+  // Double-double and long double references agree to the long double
+  // precision (only double on MSVC).
+  const Biquad<long double> peak = IIR::PeakEq<long double>(6.0L, 1000.0L, 2.0L, 48000.0L);
+  for (double frequency : { 1.0, 20.0, 999.0, 1000.0, 15000.0, 24000.0 })
+  {
+    const auto point = Accuracy::Detail::MakeReferencePoint<DoubleDouble>(frequency, 48000.0);
+    EXPECT_LT(std::abs(static_cast<double>(point.c1 * point.c1 + point.s1 * point.s1 - 1.0)), 1e-29);
+
+    const auto h = Accuracy::Detail::Reference(peak, point);
+    const auto wide = Accuracy::Detail::Reference(peak,
+      Accuracy::Detail::MakeReferencePoint<long double>(frequency, 48000.0));
+    const double tolerance = 64 * std::numeric_limits<long double>::epsilon();
+    EXPECT_NEAR(Accuracy::Detail::ToDouble(h.magnitude) / static_cast<double>(wide.magnitude), 1.0, tolerance);
+    const double rounded = static_cast<double>(wide.magnitude);
+    EXPECT_NEAR(Accuracy::Detail::Difference(rounded, h.magnitude),
+      static_cast<double>(rounded - wide.magnitude), tolerance * rounded);
+  }
+}
+
+
+TEST(DigitalFiltersTEST, Test_Datasets)
+{
+  const Datasets::Dataset uniform = Datasets::Uniform(7, 100000, 20.0, 500.0);
+
+  // Same values on every call, whether generated whole, by index or in chunks.
+  const std::vector<double> values = Datasets::Generate<double>(uniform);
+  EXPECT_EQ(values, Datasets::Generate<double>(uniform));
+  EXPECT_NE(values, Datasets::Generate<double>(Datasets::Uniform(8, 100000, 20.0, 500.0)));
+  EXPECT_EQ(values[12345], Datasets::Value<double>(uniform, 12345));
+
+  std::vector<double> chunked;
+  Datasets::ForEachChunk<double>(uniform, 4096, [&](size_t first, std::span<const double> chunk)
+    {
+      EXPECT_EQ(first, chunked.size());
+      chunked.insert(chunked.end(), chunk.begin(), chunk.end());
+    });
+  EXPECT_EQ(chunked, values);
+
+  double sum = 0;
+  for (double value : values)
+  {
+    ASSERT_GE(value, 20.0);
+    ASSERT_LT(value, 500.0);
+    sum += value;
+  }
+  EXPECT_NEAR(sum / values.size(), 260.0, 2.0);
+
+  const std::vector<double> noise = Datasets::Generate<double>(Datasets::Gaussian(3, 100000, 1.0, 2.0));
+  double mean = 0, square = 0;
+  for (double value : noise)
+  {
+    mean += value;
+    square += value * value;
+  }
+  mean /= noise.size();
+  EXPECT_NEAR(mean, 1.0, 0.05);
+  EXPECT_NEAR(std::sqrt(square / noise.size() - mean * mean), 2.0, 0.05);
+
+  const std::vector<float> sweep = Datasets::Generate<float>(Datasets::LogSweep(5, 10.0, 100000.0));
+  EXPECT_EQ(sweep.front(), 10.0f);
+  EXPECT_NEAR(sweep[2], 1000.0f, 1e-3);
+  EXPECT_EQ(sweep.back(), 100000.0f);
+
+  for (double value : Datasets::Generate<double>(Datasets::LogUniform(4, 1000, 10.0, 1000.0)))
+  {
+    ASSERT_GE(value, 10.0);
+    ASSERT_LE(value, 1000.0);
+  }
+
+  Datasets::LazyDataset<double> lazy(uniform);
+  EXPECT_FALSE(lazy.Generated());
+  EXPECT_EQ(lazy.size(), values.size());
+  EXPECT_EQ(lazy.Values(), values);
+  EXPECT_TRUE(lazy.Generated());
+
+  std::vector<double> tooMany(10);
+  EXPECT_THROW(Datasets::Fill<double>(uniform, 99995, tooMany), std::out_of_range);
+  EXPECT_THROW(Datasets::LogUniform(1, 10, 0.0, 1.0), std::invalid_argument);
+}
+
+
+TEST(DigitalFiltersTEST, Test_ParallelBackends)
+{
+  // Work stealing pool: every chunk exactly once, nested runs inline.
+  Parallel::ThreadPool pool(4);
+  EXPECT_EQ(pool.Size(), 4u);
+
+  std::vector<std::atomic<int>> runs(1000);
+  std::atomic<int> nested{ 0 };
+  pool.Run(runs.size(), 4, false, [&](size_t chunk)
+    {
+      EXPECT_LT(Parallel::WorkerIndex(), pool.Size());
+      runs[chunk]++;
+      if (chunk % 100 == 0)
+      {
+        pool.Run(10, 4, false, [&](size_t) { nested++; });
+      }
+    });
+  for (const auto& count : runs)
+  {
+    ASSERT_EQ(count.load(), 1);
+  }
+  EXPECT_EQ(nested.load(), 100);
+
+  const std::vector<double> numerator{ 0.2, 0.4, 0.2 };
+  const std::vector<double> denominator{ 1.0, -0.5, 0.3 };
+  const std::vector<double> freqs = Datasets::Generate<double>(Datasets::LogSweep(10001, 10.0, 23000.0));
+  const auto expected = IIRfreqResponse::FrequencyResponse(numerator, denominator, freqs, 48000.0);
+  const auto expectedTrig = IIRfreqResponse::FrequencyResponseTrig(numerator, denominator, freqs, 48000.0);
+
+  for (auto backend : { Parallel::Backend::OpenMP, Parallel::Backend::ThreadPool, Parallel::Backend::Serial })
+  {
+    const Parallel::Options options{ backend, 3, 7, false };
+
+    std::vector<int> covered(1000, 0);
+    Parallel::For(covered.size(), options, [&](size_t begin, size_t end)
+      {
+        EXPECT_LE(end - begin, 7u);
+        for (size_t i = begin; i < end; i++)
+        {
+          covered[i]++;
+        }
+      });
+    EXPECT_EQ(std::count(covered.begin(), covered.end(), 1), 1000);
+
+    Parallel::Buffer<std::complex<double>> result(freqs.size(), options);
+    ASSERT_EQ(result.size(), freqs.size());
+    EXPECT_EQ(result[123], std::complex<double>(0.0, 0.0));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(result.data()) % Parallel::Buffer<double>::Alignment, 0u);
+
+    IIRfreqResponse::FrequencyResponse(numerator, denominator, freqs, 48000.0, result, options);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+    std::vector<FrequencyResponseDouble> trig(freqs.size());
+    IIRfreqResponse::FrequencyResponseTrig(numerator, denominator, freqs, 48000.0, trig, options);
+    for (size_t i = 0; i < trig.size(); i += 97)
+    {
+      ASSERT_EQ(trig[i].magnitude, expectedTrig[i].magnitude);
+      ASSERT_EQ(trig[i].phase, expectedTrig[i].phase);
+    }
+  }
+
+  std::vector<std::complex<double>> tooShort(10);
+  EXPECT_THROW(IIRfreqResponse::FrequencyResponse(numerator, denominator, freqs, 48000.0, tooShort,
+    Parallel::Options{}), std::invalid_argument);
+
+  const Parallel::Options previous = Parallel::DefaultOptions();
+  Parallel::SetDefaultOptions({ Parallel::Backend::Serial, 1, 64, false });
+  EXPECT_EQ(Parallel::DefaultOptions().backend, Parallel::Backend::Serial);
+  EXPECT_EQ(IIRfreqResponse::FrequencyResponse(numerator, denominator, freqs, 48000.0), expected);
+  Parallel::SetDefaultOptions(previous);
+}
+
+
+TEST(DigitalFiltersTEST, Test_AsyncFrequencyResponse)
+{
+  const std::vector<double> numerator{ 0.2, 0.4, 0.2 };
+  const std::vector<double> denominator{ 1.0, -0.5, 0.3 };
+  const std::vector<double> freqs = Datasets::Generate<double>(Datasets::LogSweep(10000, 10.0, 23000.0));
+  const auto expected = IIRfreqResponse::FrequencyResponse(numerator, denominator, freqs, 48000.0);
+  const auto expectedTrig = IIRfreqResponse::FrequencyResponseTrig(numerator, denominator, freqs, 48000.0);
+
+  // Complete run, progress after every chunk.
+  std::vector<size_t> progress;
+  Async::Settings settings;
+  settings.chunkSize = 1000;
+  settings.progress = [&](size_t completed, size_t total)
+    {
+      EXPECT_EQ(total, freqs.size());
+      progress.push_back(completed);
+    };
+  auto job = IIRfreqResponse::FrequencyResponseAsync(numerator, denominator, freqs, 48000.0, settings);
+  EXPECT_EQ(job.Wait(), Async::Status::Completed);
+  EXPECT_EQ(job.Progress(), 1.0);
+  EXPECT_EQ(job.Get(), expected);
+  EXPECT_FALSE(job.Valid());
+  ASSERT_EQ(progress.size(), 10u);
+  EXPECT_EQ(progress.front(), 1000u);
+  EXPECT_EQ(progress.back(), 10000u);
+
+  auto trigJob = IIRfreqResponse::FrequencyResponseTrigAsync(numerator, denominator, freqs, 48000.0);
+  const auto trig = trigJob.Get();
+  ASSERT_EQ(trig.size(), expectedTrig.size());
+  for (size_t i = 0; i < trig.size(); i += 101)
+  {
+    EXPECT_EQ(trig[i].magnitude, expectedTrig[i].magnitude);
+  }
+
+  // Cancelled after the third chunk: the first three are delivered.
+  std::promise<void> reached, resume;
+  std::shared_future<void> resumed = resume.get_future().share();
+  settings.progress = [&](size_t completed, size_t)
+    {
+      if (completed == 3000)
+      {
+        reached.set_value();
+        resumed.wait();
+      }
+    };
+  auto cancelled = IIRfreqResponse::FrequencyResponseAsync(numerator, denominator, freqs, 48000.0, settings);
+  reached.get_future().wait();
+  EXPECT_EQ(cancelled.GetStatus(), Async::Status::Running);
+  EXPECT_EQ(cancelled.Completed(), 3000u);
+  EXPECT_TRUE(std::equal(cancelled.Partial().begin(), cancelled.Partial().end(), expected.begin()));
+  cancelled.Cancel();
+  resume.set_value();
+  EXPECT_EQ(cancelled.Wait(), Async::Status::Cancelled);
+  const auto partial = cancelled.Get();
+  ASSERT_EQ(partial.size(), 3000u);
+  EXPECT_TRUE(std::equal(partial.begin(), partial.end(), expected.begin()));
+
+  // Errors of the evaluation come out of Get.
+  auto failing = Async::Run<double>(100, { 10, nullptr }, [](size_t begin, std::span<double> output)
+    {
+      if (begin == 50)
+      {
+        throw std::runtime_error("failed");
+      }
+      std::fill(output.begin(), output.end(), 1.0);
+    });
+  EXPECT_EQ(failing.Wait(), Async::Status::Failed);
+  EXPECT_EQ(failing.Completed(), 50u);
+  EXPECT_THROW(failing.Get(), std::runtime_error);
+
+  EXPECT_THROW(Async::Run<double>(100, { 0, nullptr }, [](size_t, std::span<double>) {}), std::invalid_argument);
+
+  // A dropped job stops after its current chunk.
+  std::atomic<size_t> chunks{ 0 };
+  {
+    auto dropped = Async::Run<double>(1000000, { 1, nullptr }, [&](size_t, std::span<double>)
+      {
+        chunks++;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      });
+  }
+  const size_t stopped = chunks.load();
+  EXPECT_LT(stopped, 1000000u);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(chunks.load(), stopped);
+}
+
+
+TEST(DigitalFiltersTEST, Test_ResponseTable)
+{
+  const double fs = 48000.0;
+  const std::vector<double> freqs = Datasets::Generate<double>(Datasets::LogSweep(1500, 10.0, 23000.0));
+
+  ResponseTable::FilterSet filters(5, 3);
+  for (int i = 0; i < 7; i++)
+  {
+    filters.Add(IIR::PeakEq(3.0 + i, 100.0 * (i + 1), 1.0, fs));
+  }
+  const std::vector<double> fourthOrder{ 0.1, 0.2, 0.3, 0.2, 0.1 };
+  const std::vector<double> poles{ 1.0, -0.2, 0.1 };
+  filters.Add(fourthOrder, poles);
+  EXPECT_EQ(filters.Size(), 8u);
+  EXPECT_THROW(filters.Add(fourthOrder, fourthOrder), std::invalid_argument);
+
+  const auto path = std::filesystem::temp_directory_path() / "DigitalFiltersResponseTable.bin";
+
+  for (auto layout : { ResponseTable::Layout::Complex, ResponseTable::Layout::MagnitudePhase })
+  {
+    // Windows much smaller than the table and not aligned on its rows.
+    ResponseTable::WriteSettings settings;
+    settings.layout = layout;
+    settings.windowBytes = 3 * 4096 + 48;
+    settings.options = { Parallel::Backend::ThreadPool, 3, 100, false };
+    ResponseTable::Write(path, filters, freqs, fs, settings);
+
+    const ResponseTable::Table table(path);
+    ASSERT_EQ(table.GetLayout(), layout);
+    ASSERT_EQ(table.FilterCount(), 8u);
+    ASSERT_EQ(table.FrequencyCount(), freqs.size());
+    EXPECT_EQ(table.Fs(), fs);
+    EXPECT_TRUE(std::ranges::equal(table.Frequencies(), freqs));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(table.Frequencies().data()) % ResponseTable::ArrayAlignment, 0u);
+
+    for (size_t f = 0; f < table.FilterCount(); f++)
+    {
+      ASSERT_TRUE(std::ranges::equal(table.Numerator(f), filters.Numerator(f)));
+      ASSERT_TRUE(std::ranges::equal(table.Denominator(f), filters.Denominator(f)));
+      const std::vector<double> zeros(filters.Numerator(f).begin(), filters.Numerator(f).end());
+      const std::vector<double> denominator(filters.Denominator(f).begin(), filters.Denominator(f).end());
+
+      if (layout == ResponseTable::Layout::Complex)
+      {
+        const auto expected = IIRfreqResponse::FrequencyResponse(zeros, denominator, freqs, fs);
+        ASSERT_TRUE(std::ranges::equal(table.Response(f), expected));
+        EXPECT_THROW(table.Magnitude(f), std::invalid_argument);
+      }
+      else
+      {
+        const auto expected = IIRfreqResponse::FrequencyResponseTrig(zeros, denominator, freqs, fs);
+        for (size_t i = 0; i < freqs.size(); i++)
+        {
+          ASSERT_EQ(table.Magnitude(f)[i], expected[i].magnitude);
+          ASSERT_EQ(table.Phase(f)[i], expected[i].phase);
+        }
+        EXPECT_THROW(table.Response(f), std::invalid_argument);
+      }
+    }
+    EXPECT_THROW(table.Numerator(8), std::out_of_range);
+  }
+
+  // Damaged files do not open.
+  const auto size = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, size - 8);
+  EXPECT_THROW(ResponseTable::Table{ path }, std::runtime_error);
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.write("NOTATABL", 8);
+  }
+  EXPECT_THROW(ResponseTable::Table{ path }, std::runtime_error);
+  std::filesystem::remove(path);
+  EXPECT_THROW(ResponseTable::Table{ path }, std::system_error);
+}
+
+
+TEST(DigitalFiltersTEST, Test_Sharding)
+{
+  const auto directory = std::filesystem::temp_directory_path() / "DigitalFiltersSharding";
+  std::filesystem::create_directories(directory);
+
+  Sharding::Job job;
+  job.grid = Datasets::LogSweep(3001, 10.0, 23000.0);
+  for (int i = 0; i < 5; i++)
+  {
+    job.filters.Add(IIR::PeakEq(-6.0 + 3.0 * i, 100.0 * (i + 1), 1.0 / 3.0, job.fs));
+  }
+
+  // Descriptors read back exactly.
+  Sharding::Save(job, directory / "job.txt");
+  const Sharding::Job loaded = Sharding::LoadJob(directory / "job.txt");
+  EXPECT_TRUE(std::ranges::equal(loaded.filters.Coefficients(), job.filters.Coefficients()));
+  EXPECT_EQ(loaded.grid.size, job.grid.size);
+  EXPECT_EQ(loaded.grid.a, job.grid.a);
+  EXPECT_EQ(loaded.fs, job.fs);
+
+  for (auto layout : { ResponseTable::Layout::Complex, ResponseTable::Layout::MagnitudePhase })
+  {
+    job.layout = layout;
+    const auto single = directory / "single.bin";
+    ResponseTable::Write(single, job.filters, Datasets::Generate<double>(job.grid), job.fs, { layout });
+
+    // 3 shards split the filters, 7 the frequencies.
+    for (size_t count : { 3u, 7u })
+    {
+      const auto shards = Sharding::Split(job, count);
+      size_t points = 0;
+      std::vector<std::filesystem::path> tables;
+      for (const auto& shard : shards)
+      {
+        points += (shard.lastFilter - shard.firstFilter) * (shard.lastFrequency - shard.firstFrequency);
+
+        const auto spec = directory / ("shard-" + std::to_string(shard.index) + ".txt");
+        Sharding::Save(shard, spec);
+        tables.push_back(directory / ("shard-" + std::to_string(shard.index) + ".bin"));
+        Sharding::Run(Sharding::LoadShard(spec), tables.back());
+      }
+      EXPECT_EQ(points, job.filters.Size() * job.grid.size);
+      EXPECT_EQ(shards[1].firstFilter == 0, count == 7);
+
+      const auto merged = directory / "merged.bin";
+      Sharding::Merge(job, tables, merged, 4096);
+      ASSERT_EQ(std::filesystem::file_size(merged), std::filesystem::file_size(single));
+      std::ifstream a(merged, std::ios::binary), b(single, std::ios::binary);
+      EXPECT_TRUE(std::equal(std::istreambuf_iterator<char>(a), std::istreambuf_iterator<char>(),
+        std::istreambuf_iterator<char>(b), std::istreambuf_iterator<char>()));
+
+      // Shards out of order, or missing, are rejected.
+      std::swap(tables[0], tables[1]);
+      EXPECT_THROW(Sharding::Merge(job, tables, merged), std::runtime_error);
+      tables.pop_back();
+      EXPECT_THROW(Sharding::Merge(job, tables, merged), std::runtime_error);
+    }
+  }
+
+  Sharding::Shard outside = Sharding::Split(job, 2)[1];
+  outside.lastFilter = 6;
+  Sharding::Save(outside, directory / "outside.txt");
+  EXPECT_THROW(Sharding::LoadShard(directory / "outside.txt"), std::runtime_error);
+  EXPECT_THROW(Sharding::LoadShard(directory / "job.txt"), std::runtime_error);
+  EXPECT_THROW(Sharding::Split(job, 0), std::invalid_argument);
+
+  std::filesystem::remove_all(directory);
+}
+
+
+TEST(DigitalFiltersTEST, Test_FilterBankFile)
+{
+  // XXH64 reference values.
+  auto checksum = [](const char* text)
+    {
+      return IIR::Detail::Checksum(std::as_bytes(std::span<const char>(text, std::strlen(text))));
+    };
+  EXPECT_EQ(checksum(""), 0xEF46DB3751D8E999ull);
+  EXPECT_EQ(checksum("abc"), 0x44BC2CF5AD770999ull);
+  EXPECT_EQ(checksum("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ull);
+
+  const double fs = 48000.0;
+  std::vector<Biquad<double>> sections;
+  std::vector<IIR::SectionDesign> designs;
+  for (int i = 0; i < 1000; i++)
+  {
+    const double fc = 20.0 * std::pow(1000.0, i / 1000.0), q = 0.5 + (i % 7) * 0.3, gain = -12.0 + (i % 25);
+    sections.push_back(IIR::PeakEq(gain, fc, q, fs));
+    designs.push_back({ static_cast<int32_t>(IIR::FilterType::PeakEq), gain, fc, q, fs });
+  }
+  const std::vector<size_t> cascadeSizes{ 10, 0, 490, 500 };
+
+  const auto path = std::filesystem::temp_directory_path() / "DigitalFiltersBank.dfb";
+  IIR::WriteFilterBank(path, sections, cascadeSizes, designs);
+
+  {
+    const auto bank = IIR::FilterBankFile::Open(path);
+    ASSERT_EQ(bank.size(), sections.size());
+    ASSERT_EQ(bank.CascadeCount(), 4u);
+    EXPECT_TRUE(bank.HasDesigns());
+    EXPECT_TRUE(bank.Verify());
+
+    // Views into the file, aligned for the bank kernels.
+    const IIR::ConstBiquadSpans<double> spans = bank.Sections();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(spans.a0.data()) % IIR::FilterBankFormat::ArrayAlignment, 0u);
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+      const Biquad<double> section = bank[i];
+      ASSERT_EQ(section.a0, sections[i].a0);
+      ASSERT_EQ(section.a2, sections[i].a2);
+      ASSERT_EQ(section.b1, sections[i].b1);
+      ASSERT_EQ(section.b2, sections[i].b2);
+      ASSERT_EQ(bank.Design(i).Fc, designs[i].Fc);
+      ASSERT_EQ(bank.Design(i).type, designs[i].type);
+    }
+
+    std::vector<double> fromFile(sections.size()), fromBank(sections.size());
+    Eval::CalcMagnitudeResponse(bank.Sections(), 0.3, std::span<double>(fromFile));
+    Eval::CalcMagnitudeResponse(IIR::BiquadBank<double>(sections), 0.3, std::span<double>(fromBank));
+    EXPECT_EQ(fromFile, fromBank);
+
+    EXPECT_EQ(bank.Cascade(1).size(), 0u);
+    EXPECT_EQ(bank.Cascade(2).size(), 490u);
+    EXPECT_EQ(bank.Cascade(3).a1.data(), spans.a1.data() + 500);
+    EXPECT_THROW(bank.Cascade(4), std::out_of_range);
+
+    IIR::CascadeProcessor<double> reference(std::vector<Biquad<double>>(sections.begin(), sections.begin() + 10));
+    IIR::CascadeProcessor<double> loaded(bank.CascadeSections(0));
+    for (int n = 0; n < 100; n++)
+    {
+      const double x = std::sin(0.1 * n);
+      ASSERT_EQ(loaded.Process(x), reference.Process(x));
+    }
+  }
+
+  // Little endian on disk: a0 of section 0 starts the first array.
+  {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    uint64_t bits = 0;
+    for (int b = 7; b >= 0; b--)
+    {
+      bits = (bits << 8) | bytes[256 + b];
+    }
+    EXPECT_EQ(std::bit_cast<double>(bits), sections[0].a0);
+  }
+
+  // A flat bank without designs.
+  IIR::WriteFilterBank(path, std::span<const Biquad<double>>(sections).first(3));
+  {
+    const auto bank = IIR::FilterBankFile::Open(path);
+    EXPECT_EQ(bank.size(), 3u);
+    EXPECT_FALSE(bank.HasDesigns());
+    EXPECT_EQ(bank.Design(2).type, IIR::SectionDesign::NoDesign);
+    EXPECT_TRUE(bank.Types().empty());
+    EXPECT_EQ(bank.Cascade(0).size(), 3u);
+  }
+
+  EXPECT_THROW(IIR::WriteFilterBank(path, sections, std::vector<size_t>{ 5 }), std::invalid_argument);
+  EXPECT_THROW(IIR::WriteFilterBank(path, sections, {}, std::span<const IIR::SectionDesign>(designs).first(2)),
+    std::invalid_argument);
+
+  // Damage: payload bytes fail Verify, header bytes fail Open.
+  IIR::WriteFilterBank(path, sections, cascadeSizes, designs);
+  auto patch = [&](std::streamoff offset)
+    {
+      std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+      file.seekg(offset);
+      const char byte = static_cast<char>(file.get() ^ 0x10);
+      file.seekp(offset);
+      file.put(byte);
+    };
+  patch(1000);
+  EXPECT_FALSE(IIR::FilterBankFile::Open(path).Verify());
+  patch(20);
+  EXPECT_THROW(IIR::FilterBankFile::Open(path), std::runtime_error);
+  std::filesystem::remove(path);
+}
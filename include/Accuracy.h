@@ -0,0 +1,817 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <string>
+#include <functional>
+#include <complex>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include "Biquad.h"
+#include "Constants.h"
+#include "FrequencyResponse.h"
+#include "Evaluator.h"
+#include "IIRDesign.h"
+#include "IIRDesignFast.h"
+
+// Accuracy of the response evaluators over the whole design space.
+//
+// RunSweep designs every combination of filter type, sample rate, cutoff, Q
+// and gain of a SweepSettings (Q and gain only for the types that take them),
+// evaluates each design with every Mode on a log frequency grid from
+// frequencyMin to Fs / 2 and compares the results with an extended precision
+// reference:
+//
+//   - ErrorSource::Evaluation: the reference evaluates the coefficients the
+//     mode designed, so only the evaluator error is measured;
+//   - ErrorSource::DesignAndEvaluation: the reference is the long double
+//     design (IIR::Design<long double>), so coefficient rounding and
+//     approximate designers count as well.
+//
+// For every mode the report holds histograms of the magnitude error in ulp
+// of the mode's precision and in dB, the largest phase error and the point
+// where each maximum was reached. Points where the reference magnitude is
+// below magnitudeFloorDb (notch zeros, stop bands) are counted as skipped:
+// there the relative error only reflects the conditioning of the problem.
+//
+// The reference uses the cosines of omega and 2 omega computed once per sample
+// rate. It is evaluated in long double where long double is wider than
+// double, and in double-double arithmetic (TwoSum / TwoProd, about 106 bits)
+// where it is not (MSVC); ReferenceDigits is the resulting precision. The
+// DesignAndEvaluation reference design is IIR::Design<long double> in both
+// cases, so on MSVC it carries double rounding.
+//
+// Designs are spread over the OpenMP threads; every thread accumulates its
+// own reports, merged at the end, so the result does not depend on the
+// thread count (ties between worst cases go to the first design).
+
+namespace DigitalFilters::Accuracy
+{
+	constexpr bool DoubleDoubleReference =
+		std::numeric_limits<long double>::digits <= std::numeric_limits<double>::digits;
+
+	constexpr int ReferenceDigits = DoubleDoubleReference
+		? 2 * std::numeric_limits<double>::digits : std::numeric_limits<long double>::digits;
+
+	enum class ErrorSource
+	{
+		Evaluation,
+		DesignAndEvaluation
+	};
+
+	// One evaluator configuration under test.
+	struct Mode
+	{
+		std::string name;
+
+		// Mantissa bits of the precision the mode computes in (the ulp unit).
+		int digits = std::numeric_limits<double>::digits;
+
+		ErrorSource source = ErrorSource::Evaluation;
+
+		// Coefficients of a design, exactly as the mode evaluates them.
+		std::function<Biquad<double>( IIR::FilterType type, double peakGain,
+			double Fc, double Q, double Fs )> design;
+
+		// Response at every frequency (Hz), one output per frequency.
+		std::function<void( const Biquad<double>& coefficients, double Fs,
+			std::span<const double> frequencies,
+			std::span<FrequencyResponse<double>> responses )> evaluate;
+	};
+
+	// Counts of non negative values in logarithmic bins: bin 0 holds exact
+	// zeros, bin 1 values up to base^minExponent, bin i values in
+	// (base^(minExponent + i - 2), base^(minExponent + i - 1)] and the last
+	// bin everything above base^maxExponent.
+	class LogHistogram
+	{
+	public:
+
+		LogHistogram() = default;
+
+		LogHistogram( int base, int minExponent, int maxExponent )
+			: base( base ), minExponent( minExponent ), maxExponent( maxExponent ),
+			counts( maxExponent - minExponent + 3, 0 )
+		{
+			if (base != 2 && base != 10)
+			{
+				throw std::invalid_argument( "base must be 2 or 10." );
+			}
+			if (maxExponent < minExponent)
+			{
+				throw std::invalid_argument( "maxExponent must not be below minExponent." );
+			}
+		}
+
+		void Add( double value )
+		{
+			counts[Bin( value )]++;
+		}
+
+		void Merge( const LogHistogram& other )
+		{
+			for (size_t i = 0; i < counts.size(); i++)
+			{
+				counts[i] += other.counts[i];
+			}
+		}
+
+		std::span<const uint64_t> Counts() const { return counts; }
+
+		uint64_t Total() const
+		{
+			uint64_t total = 0;
+			for (uint64_t count : counts)
+			{
+				total += count;
+			}
+			return total;
+		}
+
+		// Largest value bin can hold (infinity for the last one).
+		double UpperBound( size_t bin ) const
+		{
+			if (bin == 0)
+			{
+				return 0;
+			}
+			if (bin + 1 >= counts.size())
+			{
+				return std::numeric_limits<double>::infinity();
+			}
+			return std::pow( static_cast<double>(base), minExponent + static_cast<int>(bin) - 1 );
+		}
+
+		// Upper bound of the bin holding the q quantile (0 <= q <= 1).
+		double Quantile( double q ) const
+		{
+			const double target = q * static_cast<double>(Total());
+			uint64_t cumulative = 0;
+			for (size_t i = 0; i < counts.size(); i++)
+			{
+				cumulative += counts[i];
+				if (cumulative > 0 && static_cast<double>(cumulative) >= target)
+				{
+					return UpperBound( i );
+				}
+			}
+			return 0;
+		}
+
+	private:
+
+		size_t Bin( double value ) const
+		{
+			if (value == 0)
+			{
+				return 0;
+			}
+			if (!(value <= std::numeric_limits<double>::max()))
+			{
+				return counts.size() - 1;
+			}
+
+			// Smallest exponent with base^exponent >= value.
+			int exponent;
+			if (base == 2)
+			{
+				int e;
+				const double mantissa = std::frexp( value, &e );
+				exponent = mantissa == 0.5 ? e - 1 : e;
+			}
+			else
+			{
+				exponent = static_cast<int>(std::ceil( std::log10( value ) ));
+			}
+
+			if (exponent <= minExponent)
+			{
+				return 1;
+			}
+			if (exponent > maxExponent)
+			{
+				return counts.size() - 1;
+			}
+			return static_cast<size_t>(exponent - minExponent + 1);
+		}
+
+		int base = 2;
+		int minExponent = 0;
+		int maxExponent = 0;
+		std::vector<uint64_t> counts;
+	};
+
+	struct SweepPoint
+	{
+		IIR::FilterType type = IIR::FilterType::LowPass;
+		double peakGain = 0;
+		double Fc = 0;
+		double Q = 0;
+		double Fs = 0;
+		double frequency = 0;
+	};
+
+	struct WorstCase
+	{
+		double error = 0;
+		SweepPoint point;
+		double value = 0;
+		double reference = 0;
+
+		// Position in the sweep, to break ties independently of the threads.
+		uint64_t order = std::numeric_limits<uint64_t>::max();
+
+		bool Replace( const WorstCase& other ) const
+		{
+			return other.error > error || (other.error == error && other.order < order);
+		}
+	};
+
+	struct ModeReport
+	{
+		std::string name;
+		int digits = 0;
+		ErrorSource source = ErrorSource::Evaluation;
+
+		uint64_t comparisons = 0;
+		uint64_t skipped = 0;
+		uint64_t nonFinite = 0;
+
+		// Magnitude error in ulp (2^-1 .. 2^64) and in dB (1e-18 .. 1e3).
+		LogHistogram ulp{ 2, -1, 64 };
+		LogHistogram decibels{ 10, -18, 3 };
+
+		WorstCase worstUlp;
+		WorstCase worstDecibels;
+		WorstCase worstPhase;
+
+		void Merge( const ModeReport& other )
+		{
+			comparisons += other.comparisons;
+			skipped += other.skipped;
+			nonFinite += other.nonFinite;
+			ulp.Merge( other.ulp );
+			decibels.Merge( other.decibels );
+			for (auto [mine, theirs] : { std::pair{ &worstUlp, &other.worstUlp },
+				std::pair{ &worstDecibels, &other.worstDecibels },
+				std::pair{ &worstPhase, &other.worstPhase } })
+			{
+				if (mine->Replace( *theirs ))
+				{
+					*mine = *theirs;
+				}
+			}
+		}
+	};
+
+	struct SweepSettings
+	{
+		std::vector<IIR::FilterType> types = {
+			IIR::FilterType::AllPass1stOrder, IIR::FilterType::AllPassQ, IIR::FilterType::BandPass,
+			IIR::FilterType::HighPass, IIR::FilterType::HighPass12dbOct, IIR::FilterType::HighPass1stOrder,
+			IIR::FilterType::HighShelf, IIR::FilterType::HighShelf1stOrder, IIR::FilterType::HighShelfQ,
+			IIR::FilterType::LowPass, IIR::FilterType::LowPass12dbOct, IIR::FilterType::LowPass1stOrder,
+			IIR::FilterType::LowShelf, IIR::FilterType::LowShelf1stOrder, IIR::FilterType::LowShelfQ,
+			IIR::FilterType::Notch, IIR::FilterType::OnePoleHighPass, IIR::FilterType::OnePoleLowPass,
+			IIR::FilterType::PeakEq };
+
+		std::vector<double> sampleRates = { 44100, 48000, 96000 };
+
+		// Log grid of cutoffs from cutoffMin to cutoffMaxRatio * Fs.
+		size_t cutoffCount = 32;
+		double cutoffMin = 10;
+		double cutoffMaxRatio = 0.45;
+
+		std::vector<double> qs = { 0.1, 0.3, 0.5, Constants::one_over_sqrt2<double>(), 1, 2, 5, 20 };
+		std::vector<double> gains = { -24, -12, -3, 3, 12, 24 };
+
+		// Log grid of evaluation frequencies from frequencyMin to Fs / 2.
+		size_t frequencyCount = 512;
+		double frequencyMin = 1;
+
+		double magnitudeFloorDb = -100;
+	};
+
+	// Magnitude comparisons RunSweep performs per mode (skipped points included).
+	inline uint64_t ComparisonsPerMode( const SweepSettings& settings )
+	{
+		uint64_t designs = 0;
+		for (IIR::FilterType type : settings.types)
+		{
+			designs += static_cast<uint64_t>(settings.cutoffCount)
+				* (IIR::UsesQ( type ) ? settings.qs.size() : 1)
+				* (IIR::UsesGain( type ) ? settings.gains.size() : 1);
+		}
+		return designs * settings.sampleRates.size() * settings.frequencyCount;
+	}
+
+	namespace Detail
+	{
+		template <typename T>
+		Biquad<double> Widen( const Biquad<T>& c )
+		{
+			return Biquad<double>( c.a0, c.a1, c.a2, c.b1, c.b2 );
+		}
+
+		template <typename T>
+		Biquad<T> Narrow( const Biquad<double>& c )
+		{
+			return Biquad<T>( static_cast<T>(c.a0), static_cast<T>(c.a1), static_cast<T>(c.a2),
+				static_cast<T>(c.b1), static_cast<T>(c.b2) );
+		}
+
+		inline std::vector<double> LogGrid( double first, double last, size_t count )
+		{
+			std::vector<double> grid( count );
+			for (size_t i = 0; i < count; i++)
+			{
+				grid[i] = count == 1 ? first
+					: first * std::pow( last / first, static_cast<double>(i) / (count - 1) );
+			}
+			if (count > 1)
+			{
+				grid.back() = last;
+			}
+			return grid;
+		}
+
+		// Unevaluated sum hi + lo of two doubles, |lo| <= ulp( hi ) / 2. The
+		// operations are the usual TwoSum / TwoProd (fma) based ones and keep
+		// about 106 bits; they need strict IEEE double (no fast-math).
+		struct DoubleDouble
+		{
+			double hi = 0;
+			double lo = 0;
+
+			DoubleDouble() = default;
+			DoubleDouble( double value ) : hi( value ) {}
+			DoubleDouble( double hi, double lo ) : hi( hi ), lo( lo ) {}
+
+			// Exact for the 64 bit long double of x87.
+			explicit DoubleDouble( long double value )
+				: hi( static_cast<double>(value) ), lo( static_cast<double>(value - static_cast<long double>(hi)) ) {}
+
+			explicit operator double() const { return hi + lo; }
+
+			// a + b exactly.
+			static DoubleDouble TwoSum( double a, double b )
+			{
+				const double sum = a + b;
+				const double b1 = sum - a;
+				return { sum, (a - (sum - b1)) + (b - b1) };
+			}
+
+			// a + b exactly, for |a| >= |b|.
+			static DoubleDouble QuickTwoSum( double a, double b )
+			{
+				const double sum = a + b;
+				return { sum, b - (sum - a) };
+			}
+
+			// a * b exactly.
+			static DoubleDouble TwoProd( double a, double b )
+			{
+				const double product = a * b;
+				return { product, std::fma( a, b, -product ) };
+			}
+
+			DoubleDouble operator-() const { return { -hi, -lo }; }
+
+			friend DoubleDouble operator+( const DoubleDouble& a, const DoubleDouble& b )
+			{
+				DoubleDouble high = TwoSum( a.hi, b.hi );
+				const DoubleDouble low = TwoSum( a.lo, b.lo );
+				high = QuickTwoSum( high.hi, high.lo + low.hi );
+				return QuickTwoSum( high.hi, high.lo + low.lo );
+			}
+
+			friend DoubleDouble operator-( const DoubleDouble& a, const DoubleDouble& b )
+			{
+				return a + -b;
+			}
+
+			friend DoubleDouble operator*( const DoubleDouble& a, const DoubleDouble& b )
+			{
+				const DoubleDouble product = TwoProd( a.hi, b.hi );
+				return QuickTwoSum( product.hi, product.lo + (a.hi * b.lo + a.lo * b.hi) );
+			}
+
+			// Long division: three quotient digits of one double each.
+			friend DoubleDouble operator/( const DoubleDouble& a, const DoubleDouble& b )
+			{
+				const double q1 = a.hi / b.hi;
+				DoubleDouble remainder = a - b * q1;
+				const double q2 = remainder.hi / b.hi;
+				remainder = remainder - b * q2;
+				const double q3 = remainder.hi / b.hi;
+				return QuickTwoSum( q1, q2 ) + q3;
+			}
+
+			// One Newton step from the double square root.
+			friend DoubleDouble sqrt( const DoubleDouble& a )
+			{
+				if (!(a.hi > 0))
+				{
+					return std::sqrt( a.hi );
+				}
+				const double root = std::sqrt( a.hi );
+				const DoubleDouble remainder = a - TwoProd( root, root );
+				return QuickTwoSum( root, remainder.hi / (2 * root) );
+			}
+		};
+
+		// Precision of the reference evaluation, see ReferenceDigits.
+		using ReferenceReal = std::conditional_t<DoubleDoubleReference, DoubleDouble, long double>;
+
+		// 2 pi as a double-double.
+		inline const DoubleDouble TwoPi{ 6.283185307179586232, 2.449293598294706414e-16 };
+
+		// sin and cos of 0 <= w <= pi: Taylor series of w / 2^8, then eight
+		// angle doublings (they cost about 8 of the 106 bits).
+		inline std::pair<DoubleDouble, DoubleDouble> SinCos( const DoubleDouble& w )
+		{
+			constexpr int Halvings = 8;
+			const DoubleDouble x{ std::ldexp( w.hi, -Halvings ), std::ldexp( w.lo, -Halvings ) };
+			const DoubleDouble x2 = x * x;
+
+			DoubleDouble sine = x, cosine = 1.0;
+			DoubleDouble sineTerm = x, cosineTerm = 1.0;
+			for (int n = 1; n <= 10; n++)
+			{
+				sineTerm = -sineTerm * x2 / static_cast<double>((2 * n) * (2 * n + 1));
+				cosineTerm = -cosineTerm * x2 / static_cast<double>((2 * n - 1) * (2 * n));
+				sine = sine + sineTerm;
+				cosine = cosine + cosineTerm;
+			}
+
+			for (int i = 0; i < Halvings; i++)
+			{
+				const DoubleDouble doubled = 2.0 * sine * cosine;
+				cosine = cosine * cosine - sine * sine;
+				sine = doubled;
+			}
+			return { sine, cosine };
+		}
+
+		template <typename Real>
+		double ToDouble( const Real& value )
+		{
+			return static_cast<double>(value);
+		}
+
+		// Exponent e of value, 2^e <= |value| < 2^(e + 1).
+		inline int Exponent( long double value )
+		{
+			return std::ilogb( value );
+		}
+
+		inline int Exponent( const DoubleDouble& value )
+		{
+			const int exponent = std::ilogb( value.hi );
+			const bool belowPowerOfTwo = std::ldexp( 1.0, exponent ) == std::abs( value.hi )
+				&& (value.lo != 0 && (value.lo < 0) != (value.hi < 0));
+			return belowPowerOfTwo ? exponent - 1 : exponent;
+		}
+
+		// value - reference, rounded once to double.
+		inline double Difference( double value, long double reference )
+		{
+			return static_cast<double>(value - reference);
+		}
+
+		inline double Difference( double value, const DoubleDouble& reference )
+		{
+			return static_cast<double>(DoubleDouble( value ) - reference);
+		}
+
+		// e^-jw and e^-2jw of one frequency.
+		template <typename Real>
+		struct ReferencePoint
+		{
+			Real c1, s1, c2, s2;
+		};
+
+		template <typename Real>
+		ReferencePoint<Real> MakeReferencePoint( double frequency, double Fs )
+		{
+			if constexpr (std::is_same_v<Real, DoubleDouble>)
+			{
+				const DoubleDouble w = TwoPi * frequency / Fs;
+				const auto [s1, c1] = SinCos( w );
+				return { c1, -s1, c1 * c1 - s1 * s1, -(2.0 * s1 * c1) };
+			}
+			else
+			{
+				const Real w = 2 * Constants::pi<Real>() * frequency / Fs;
+				return { std::cos( w ), -std::sin( w ), std::cos( 2 * w ), -std::sin( 2 * w ) };
+			}
+		}
+
+		struct SampleRateGrid
+		{
+			double Fs = 0;
+			std::vector<double> frequencies;
+			std::vector<ReferencePoint<ReferenceReal>> points;
+		};
+
+		inline SampleRateGrid MakeGrid( const SweepSettings& settings, double Fs )
+		{
+			SampleRateGrid grid;
+			grid.Fs = Fs;
+			grid.frequencies = LogGrid( settings.frequencyMin, Fs / 2, settings.frequencyCount );
+			grid.points.reserve( grid.frequencies.size() );
+			for (double frequency : grid.frequencies)
+			{
+				grid.points.push_back( MakeReferencePoint<ReferenceReal>( frequency, Fs ) );
+			}
+			return grid;
+		}
+
+		struct DesignPoint
+		{
+			IIR::FilterType type;
+			double peakGain, Fc, Q;
+			size_t grid;
+		};
+
+		// Magnitude and N(z) * conj(D(z)) (the phase) of the response at one point.
+		template <typename Real>
+		struct ReferenceValue
+		{
+			Real magnitude;
+			Real real, imag;
+		};
+
+		template <typename Real>
+		ReferenceValue<Real> Reference( const Biquad<long double>& coefficients, const ReferencePoint<Real>& p )
+		{
+			using std::sqrt;
+			const Real a0( coefficients.a0 ), a1( coefficients.a1 ), a2( coefficients.a2 );
+			const Real b1( coefficients.b1 ), b2( coefficients.b2 );
+
+			const Real nRe = a0 + a1 * p.c1 + a2 * p.c2;
+			const Real nIm = a1 * p.s1 + a2 * p.s2;
+			const Real dRe = Real( 1.0 ) + b1 * p.c1 + b2 * p.c2;
+			const Real dIm = b1 * p.s1 + b2 * p.s2;
+			return { sqrt( (nRe * nRe + nIm * nIm) / (dRe * dRe + dIm * dIm) ),
+				nRe * dRe + nIm * dIm, nIm * dRe - nRe * dIm };
+		}
+
+		inline void Offer( WorstCase& worst, double error, const SweepPoint& point,
+			double value, double reference, uint64_t order )
+		{
+			const WorstCase candidate{ error, point, value, reference, order };
+			if (worst.Replace( candidate ))
+			{
+				worst = candidate;
+			}
+		}
+	}
+
+	// Evaluators of Evaluator.h in double, the same in float (designed in float)
+	// and the IIR::Fast designers evaluated in double.
+	inline std::vector<Mode> StandardModes()
+	{
+		using Response = std::span<FrequencyResponse<double>>;
+		using Frequencies = std::span<const double>;
+
+		auto exactDesign = []( IIR::FilterType type, double gain, double Fc, double Q, double Fs )
+		{
+			return IIR::Design<double>( type, gain, Fc, Q, Fs );
+		};
+
+		auto floatDesign = []( IIR::FilterType type, double gain, double Fc, double Q, double Fs )
+		{
+			return Detail::Widen( IIR::Design<float>( type, static_cast<float>(gain),
+				static_cast<float>(Fc), static_cast<float>(Q), static_cast<float>(Fs) ) );
+		};
+
+		auto fastDesign = []( IIR::FilterType type, double gain, double Fc, double Q, double Fs )
+		{
+			return IIR::Fast::Design<double>( type, gain, Fc, Q, Fs );
+		};
+
+		auto complexBiquad = []<typename T>( const Biquad<double>& coefficients, double Fs,
+			Frequencies frequencies, Response responses, T )
+		{
+			const Biquad<T> c = Detail::Narrow<T>( coefficients );
+			for (size_t i = 0; i < frequencies.size(); i++)
+			{
+				const T w = Utils::HzToOmega( static_cast<T>(frequencies[i]) ) / static_cast<T>(Fs);
+				const std::complex<T> h = Eval::CalcFreqResponse( c, w );
+				responses[i] = FrequencyResponse<double>( std::abs( h ), std::arg( h ) );
+			}
+		};
+
+		auto trigBiquad = []<typename T>( const Biquad<double>& coefficients, double Fs,
+			Frequencies frequencies, Response responses, T )
+		{
+			const Biquad<T> c = Detail::Narrow<T>( coefficients );
+			for (size_t i = 0; i < frequencies.size(); i++)
+			{
+				const T w = Utils::HzToOmega( static_cast<T>(frequencies[i]) ) / static_cast<T>(Fs);
+				const FrequencyResponse<T> h = Eval::CalcFreqResponseTrig( c, w );
+				responses[i] = FrequencyResponse<double>( h.magnitude, h.phase );
+			}
+		};
+
+		std::vector<Mode> modes;
+
+		modes.push_back( { "CalcFreqResponse(Biquad)<double>", std::numeric_limits<double>::digits,
+			ErrorSource::Evaluation, exactDesign,
+			[=]( const Biquad<double>& c, double Fs, Frequencies f, Response r ) { complexBiquad( c, Fs, f, r, 0.0 ); } } );
+
+		modes.push_back( { "CalcFreqResponseTrig(Biquad)<double>", std::numeric_limits<double>::digits,
+			ErrorSource::Evaluation, exactDesign,
+			[=]( const Biquad<double>& c, double Fs, Frequencies f, Response r ) { trigBiquad( c, Fs, f, r, 0.0 ); } } );
+
+		modes.push_back( { "CalcFreqResponse(span)<double>", std::numeric_limits<double>::digits,
+			ErrorSource::Evaluation, exactDesign,
+			[]( const Biquad<double>& c, double Fs, Frequencies frequencies, Response responses )
+			{
+				const auto numerator = c.Numerator();
+				const auto denominator = c.Denominator();
+				for (size_t i = 0; i < frequencies.size(); i++)
+				{
+					const double w = Utils::HzToOmega( frequencies[i] ) / Fs;
+					const std::complex<double> h = Eval::CalcFreqResponse(
+						std::span<const double>( numerator ), std::span<const double>( denominator ), w );
+					responses[i] = FrequencyResponse<double>( std::abs( h ), std::arg( h ) );
+				}
+			} } );
+
+		modes.push_back( { "CalcFreqResponseTrig(span)<double>", std::numeric_limits<double>::digits,
+			ErrorSource::Evaluation, exactDesign,
+			[]( const Biquad<double>& c, double Fs, Frequencies frequencies, Response responses )
+			{
+				const auto numerator = c.Numerator();
+				const auto denominator = c.Denominator();
+				for (size_t i = 0; i < frequencies.size(); i++)
+				{
+					const double w = Utils::HzToOmega( frequencies[i] ) / Fs;
+					responses[i] = Eval::CalcFreqResponseTrig(
+						std::span<const double>( numerator ), std::span<const double>( denominator ), w );
+				}
+			} } );
+
+		modes.push_back( { "CalcFreqResponse(Biquad)<float>", std::numeric_limits<float>::digits,
+			ErrorSource::DesignAndEvaluation, floatDesign,
+			[=]( const Biquad<double>& c, double Fs, Frequencies f, Response r ) { complexBiquad( c, Fs, f, r, 0.0f ); } } );
+
+		modes.push_back( { "CalcFreqResponseTrig(Biquad)<float>", std::numeric_limits<float>::digits,
+			ErrorSource::DesignAndEvaluation, floatDesign,
+			[=]( const Biquad<double>& c, double Fs, Frequencies f, Response r ) { trigBiquad( c, Fs, f, r, 0.0f ); } } );
+
+		modes.push_back( { "Fast::Design + CalcFreqResponse<double>", std::numeric_limits<double>::digits,
+			ErrorSource::DesignAndEvaluation, fastDesign,
+			[=]( const Biquad<double>& c, double Fs, Frequencies f, Response r ) { complexBiquad( c, Fs, f, r, 0.0 ); } } );
+
+		return modes;
+	}
+
+	// Runs every mode over the sweep; one report per mode, in order.
+	inline std::vector<ModeReport> RunSweep( const SweepSettings& settings, std::span<const Mode> modes )
+	{
+		if (settings.frequencyCount == 0 || settings.cutoffCount == 0
+			|| !(settings.frequencyMin > 0) || !(settings.cutoffMin > 0))
+		{
+			throw std::invalid_argument( "Invalid sweep grid." );
+		}
+		for (const Mode& mode : modes)
+		{
+			if (!mode.design || !mode.evaluate)
+			{
+				throw std::invalid_argument( "Every mode needs a design and an evaluate function." );
+			}
+		}
+
+		std::vector<Detail::SampleRateGrid> grids;
+		std::vector<Detail::DesignPoint> designs;
+		for (double Fs : settings.sampleRates)
+		{
+			if (!(Fs > 2 * settings.frequencyMin) || !(settings.cutoffMin < settings.cutoffMaxRatio * Fs))
+			{
+				throw std::invalid_argument( "Sample rate too low for the sweep grid." );
+			}
+			grids.push_back( Detail::MakeGrid( settings, Fs ) );
+
+			const std::vector<double> cutoffs = Detail::LogGrid(
+				settings.cutoffMin, settings.cutoffMaxRatio * Fs, settings.cutoffCount );
+			const std::vector<double> noValue{ 0.0 };
+
+			for (IIR::FilterType type : settings.types)
+			{
+				for (double Fc : cutoffs)
+				{
+					for (double Q : IIR::UsesQ( type ) ? settings.qs : noValue)
+					{
+						for (double gain : IIR::UsesGain( type ) ? settings.gains : noValue)
+						{
+							designs.push_back( { type, gain, Fc, Q, grids.size() - 1 } );
+						}
+					}
+				}
+			}
+		}
+
+		std::vector<ModeReport> reports( modes.size() );
+		for (size_t m = 0; m < modes.size(); m++)
+		{
+			reports[m].name = modes[m].name;
+			reports[m].digits = modes[m].digits;
+			reports[m].source = modes[m].source;
+		}
+
+		const double floor = std::pow( 10.0, settings.magnitudeFloorDb / 20.0 );
+		const double decibelsPerNeper = 20 / std::log( 10.0 );
+
+		#pragma omp parallel
+		{
+			std::vector<ModeReport> local( modes.size() );
+			std::vector<FrequencyResponse<double>> responses( settings.frequencyCount );
+
+			#pragma omp for schedule(dynamic, 8) nowait
+			for (int d = 0; d < static_cast<int>(designs.size()); d++)
+			{
+				const Detail::DesignPoint& design = designs[d];
+				const Detail::SampleRateGrid& grid = grids[design.grid];
+				const Biquad<long double> exact = IIR::Design<long double>( design.type,
+					design.peakGain, design.Fc, design.Q, grid.Fs );
+
+				for (size_t m = 0; m < modes.size(); m++)
+				{
+					const Mode& mode = modes[m];
+					ModeReport& report = local[m];
+
+					const Biquad<double> coefficients = mode.design( design.type,
+						design.peakGain, design.Fc, design.Q, grid.Fs );
+					const Biquad<long double> reference = mode.source == ErrorSource::Evaluation
+						? Biquad<long double>( coefficients.a0, coefficients.a1, coefficients.a2,
+							coefficients.b1, coefficients.b2 )
+						: exact;
+
+					mode.evaluate( coefficients, grid.Fs, grid.frequencies, responses );
+
+					for (size_t i = 0; i < grid.frequencies.size(); i++)
+					{
+						const auto h = Detail::Reference( reference, grid.points[i] );
+						const double referenceMagnitude = Detail::ToDouble( h.magnitude );
+						const FrequencyResponse<double>& value = responses[i];
+						const uint64_t order = static_cast<uint64_t>(d) * grid.frequencies.size() + i;
+						const SweepPoint point{ design.type, design.peakGain, design.Fc, design.Q,
+							grid.Fs, grid.frequencies[i] };
+
+						report.comparisons++;
+
+						if (!std::isfinite( value.magnitude ) || !std::isfinite( value.phase ))
+						{
+							report.nonFinite++;
+							report.ulp.Add( std::numeric_limits<double>::infinity() );
+							report.decibels.Add( std::numeric_limits<double>::infinity() );
+							continue;
+						}
+						if (!(referenceMagnitude >= floor))
+						{
+							report.skipped++;
+							continue;
+						}
+
+						const double difference = Detail::Difference( value.magnitude, h.magnitude );
+						const double ulp = std::abs( std::ldexp( difference,
+							(mode.digits - 1) - Detail::Exponent( h.magnitude ) ) );
+						const double relative = difference / referenceMagnitude;
+						const double decibels = std::abs( std::log1p( relative ) ) * decibelsPerNeper;
+
+						// The reference phase only needs double accuracy: phase
+						// errors are reported in radians, not ulp.
+						const double referencePhase = std::atan2(
+							Detail::ToDouble( h.imag ), Detail::ToDouble( h.real ) );
+						double phase = std::abs( value.phase - referencePhase );
+						phase = std::min( phase, std::abs( 2 * Constants::pi<double>() - phase ) );
+
+						report.ulp.Add( ulp );
+						report.decibels.Add( decibels );
+
+						Detail::Offer( report.worstUlp, ulp, point, value.magnitude, referenceMagnitude, order );
+						Detail::Offer( report.worstDecibels, decibels, point, value.magnitude, referenceMagnitude, order );
+						Detail::Offer( report.worstPhase, phase, point, value.phase, referencePhase, order );
+					}
+				}
+			}
+
+			#pragma omp critical
+			{
+				for (size_t m = 0; m < modes.size(); m++)
+				{
+					reports[m].Merge( local[m] );
+				}
+			}
+		}
+
+		return reports;
+	}
+}
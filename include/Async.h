@@ -0,0 +1,211 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+#include "Parallel.h"
+
+// Asynchronous, cancellable batch evaluation.
+//
+// Async::Run( count, settings, evaluate ) returns at once a Job that computes
+// count values on its own thread, as consecutive chunks of settings.chunkSize
+// values. evaluate( begin, output ) fills output with values begin ..
+// begin + output.size() - 1, and may itself run in parallel (the
+// IIRfreqResponse jobs use the Parallel::Options overloads). Since chunks
+// complete in order, the values done so far are always a prefix of the
+// result:
+//   - Completed() / Progress() tell how far the job is, and
+//     settings.progress( completed, count ) is called, on the job thread,
+//     after every chunk;
+//   - Partial() views the completed prefix while the job runs;
+//   - Cancel() stops the job before its next chunk. Get() then returns the
+//     completed prefix, so a UI can keep what was drawn and drop the rest.
+// Destroying a running Job cancels it and waits for the current chunk, so
+// the job never outlives the data it captured.
+
+namespace DigitalFilters::Async
+{
+	enum class Status
+	{
+		Running,
+		Completed,
+		Cancelled,
+		Failed
+	};
+
+	// Values per chunk: the cancellation and progress granularity.
+	constexpr size_t DefaultChunkSize = 1 << 16;
+
+	struct Settings
+	{
+		size_t chunkSize = DefaultChunkSize;
+
+		// Called on the job thread after every chunk with the values completed
+		// and the total. Must not throw.
+		std::function<void( size_t completed, size_t total )> progress;
+	};
+
+	template <typename T>
+	class Job
+	{
+	public:
+
+		Job() = default;
+
+		Job( Job&& ) noexcept = default;
+
+		Job& operator=( Job&& other ) noexcept
+		{
+			if (this != &other)
+			{
+				Stop();
+				state = std::move( other.state );
+				done = std::move( other.done );
+			}
+			return *this;
+		}
+
+		Job( const Job& ) = delete;
+		Job& operator=( const Job& ) = delete;
+
+		~Job()
+		{
+			Stop();
+		}
+
+		bool Valid() const { return state != nullptr; }
+
+		size_t Total() const { return state->values.size(); }
+
+		size_t Completed() const { return state->completed.load( std::memory_order_acquire ); }
+
+		double Progress() const
+		{
+			return Total() > 0 ? static_cast<double>(Completed()) / static_cast<double>(Total()) : 1.0;
+		}
+
+		Status GetStatus() const { return state->status.load( std::memory_order_acquire ); }
+
+		// Asks the job to stop before its next chunk (the current one finishes).
+		void Cancel() { state->cancelled.store( true, std::memory_order_relaxed ); }
+
+		bool CancelRequested() const { return state->cancelled.load( std::memory_order_relaxed ); }
+
+		// The values completed so far. Valid until Get() or the Job is
+		// destroyed.
+		std::span<const T> Partial() const
+		{
+			return std::span<const T>( state->values.data(), Completed() );
+		}
+
+		// Waits for the job and returns its final status.
+		Status Wait() const
+		{
+			done.wait();
+			return GetStatus();
+		}
+
+		// True when the job finished within timeout.
+		template <typename Rep, typename Period>
+		bool WaitFor( const std::chrono::duration<Rep, Period>& timeout ) const
+		{
+			return done.wait_for( timeout ) == std::future_status::ready;
+		}
+
+		// Waits for the job and returns all the values, or the completed
+		// prefix if it was cancelled. Rethrows the exception of evaluate.
+		// The Job is empty afterwards.
+		std::vector<T> Get()
+		{
+			done.get();
+			std::vector<T> values = std::move( state->values );
+			values.resize( state->completed.load( std::memory_order_acquire ) );
+			state.reset();
+			return values;
+		}
+
+	private:
+
+		template <typename U, typename Evaluate>
+		friend Job<U> Run( size_t count, Settings settings, Evaluate evaluate );
+
+		struct State
+		{
+			std::vector<T> values;
+			std::atomic<size_t> completed{ 0 };
+			std::atomic<bool> cancelled{ false };
+			std::atomic<Status> status{ Status::Running };
+		};
+
+		void Stop()
+		{
+			if (state && done.valid())
+			{
+				Cancel();
+				done.wait();
+			}
+		}
+
+		std::unique_ptr<State> state;
+		std::shared_future<void> done;
+	};
+
+	// Starts computing count values with evaluate( begin, std::span<T> output ).
+	// evaluate is copied into the job, so it must own (or outlive) its inputs.
+	template <typename T, typename Evaluate>
+	Job<T> Run( size_t count, Settings settings, Evaluate evaluate )
+	{
+		if (settings.chunkSize == 0)
+		{
+			throw std::invalid_argument( "chunkSize must be positive." );
+		}
+
+		Job<T> job;
+		job.state = std::make_unique<typename Job<T>::State>();
+		job.state->values.resize( count );
+
+		auto* state = job.state.get();
+		job.done = std::async( std::launch::async,
+			[state, settings = std::move( settings ), evaluate = std::move( evaluate )]() mutable
+			{
+				const size_t total = state->values.size();
+				try
+				{
+					for (size_t begin = 0; begin < total; begin += settings.chunkSize)
+					{
+						if (state->cancelled.load( std::memory_order_relaxed ))
+						{
+							state->status.store( Status::Cancelled, std::memory_order_release );
+							return;
+						}
+
+						const size_t size = std::min( settings.chunkSize, total - begin );
+						evaluate( begin, std::span<T>( state->values.data() + begin, size ) );
+						state->completed.store( begin + size, std::memory_order_release );
+
+						if (settings.progress)
+						{
+							settings.progress( begin + size, total );
+						}
+					}
+				}
+				catch (...)
+				{
+					state->status.store( Status::Failed, std::memory_order_release );
+					throw;
+				}
+				state->status.store( Status::Completed, std::memory_order_release );
+			} ).share();
+
+		return job;
+	}
+}
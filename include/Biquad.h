@@ -2,6 +2,9 @@
 #include <type_traits>
 #include <vector>
 #include <complex>
+#include <array>
+#include <limits>
+#include <cmath>
 #include <stdexcept>
 
 namespace DigitalFilters
@@ -23,6 +26,77 @@ namespace DigitalFilters
 	// - b0, b1, b2 are the feedback (denominator)
 	// coefficients (often associated with "poles").
 
+	// Finite roots of a biquad polynomial: at most two, so they are held
+	// in place instead of in a std::vector.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	struct BiquadRoots
+	{
+		std::array<std::complex<T>, 2> values{};
+		size_t count = 0;
+
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		const std::complex<T>* begin() const { return values.data(); }
+		const std::complex<T>* end() const { return values.data() + count; }
+
+		const std::complex<T>& operator[]( size_t index ) const
+		{
+			return values[index];
+		}
+	};
+
+	namespace Detail
+	{
+		// z-plane roots of c0 + c1 z^-1 + c2 z^-2, i.e. of c0 z^2 + c1 z + c2.
+		// Roots at infinity (c0 == 0) and the trivial root at the origin of a
+		// first-order section are not reported.
+		template <typename T>
+		BiquadRoots<T> PolynomialRoots( T c0, T c1, T c2 )
+		{
+			const T epsilon = std::numeric_limits<T>::epsilon();
+			BiquadRoots<T> roots;
+
+			if (std::abs( c2 ) < epsilon)
+			{
+				// First-order case: c0 z + c1.
+				if (std::abs( c1 ) > epsilon && std::abs( c0 ) > epsilon)
+				{
+					roots.values[roots.count++] = { -c1 / c0, static_cast<T>(0) };
+				}
+			}
+			else if (std::abs( c0 ) < epsilon)
+			{
+				// c1 z + c2, the other root is at infinity.
+				if (std::abs( c1 ) > epsilon)
+				{
+					roots.values[roots.count++] = { -c2 / c1, static_cast<T>(0) };
+				}
+			}
+			else
+			{
+				const T discriminant = c1 * c1 - 4 * c0 * c2;
+
+				if (discriminant >= 0)
+				{
+					const T root = std::sqrt( discriminant );
+					roots.values[0] = { (-c1 + root) / (2 * c0), static_cast<T>(0) };
+					roots.values[1] = { (-c1 - root) / (2 * c0), static_cast<T>(0) };
+				}
+				else
+				{
+					const T root = std::sqrt( -discriminant );
+					roots.values[0] = { -c1 / (2 * c0), root / (2 * c0) };
+					roots.values[1] = { -c1 / (2 * c0), -root / (2 * c0) };
+				}
+				roots.count = 2;
+			}
+
+			return roots;
+		}
+	}
+
 	template <typename T>
 		requires std::is_floating_point_v<T>
 	struct Biquad
@@ -33,10 +107,10 @@ namespace DigitalFilters
 		// Feedback coefficients (Denominator, often related to Poles)
 		T b0 = 1, b1 = 0, b2 = 0;
 
-		Biquad () = default;
+		constexpr Biquad () = default;
 
 		// Constructor with full parameters
-		Biquad ( T a0, T a1, T a2, T b0, T b1, T b2 )
+		constexpr Biquad ( T a0, T a1, T a2, T b0, T b1, T b2 )
 			: a0( a0 ), a1( a1 ), a2( a2 ), b0( b0 ), b1( b1 ), b2( b2 )
 		{
 			// It's common practice to normalize b0 to 1 to simplify calculations
@@ -58,7 +132,7 @@ namespace DigitalFilters
 		}
 
 		// Constructor with b0 = 1 implicit
-		Biquad ( T a0, T a1, T a2, T b1, T b2 )
+		constexpr Biquad ( T a0, T a1, T a2, T b1, T b2 )
 			: a0( a0 ), a1( a1 ), a2( a2 ),
 			b0( static_cast<T>(1) ), b1( b1 ), b2( b2 )
 		{
@@ -76,104 +150,43 @@ namespace DigitalFilters
 			return{ b0, b1, b2 };
 		}
 
-		// Calculates the poles of the transfer function.
-		std::vector<std::complex<T>> calculatePoles() const
+		// Allocation free versions of the two functions above. The result
+		// converts to std::span<const T> for the span based evaluators.
+		constexpr std::array <T, 3> Numerator() const
 		{
+			return { a0, a1, a2 };
+		}
 
-			std::vector<std::complex<T>> poles;
-			if (std::abs( b2 ) < std::numeric_limits<T>::epsilon())
-			{
-				// First-order case (b2 is approximately zero)
-				if (std::abs( b1 ) > std::numeric_limits<T>::epsilon())
-				{
-					poles.emplace_back( -b0 / b1, static_cast<T>(0) );
-				}
-				// If both b1 and b2 are zero,
-				//	there are no finite poles (only at infinity)
-			}
-			else
-			{
-				T discriminant = b1 * b1 - 4 * b0 * b2;
+		constexpr std::array <T, 3> Denominator() const
+		{
+			return { b0, b1, b2 };
+		}
 
-				if (discriminant >= 0)
-				{
-					poles.emplace_back
-					(
-						(-b1 + std::sqrt( discriminant )) / (2 * b2), static_cast<T>(0)
-					);
-					poles.emplace_back
-					(
-						(-b1 - std::sqrt( discriminant )) / (2 * b2), static_cast<T>(0)
-					);
-				}
-				else
-				{
-					poles.emplace_back
-					(
-						-b1 / (2 * b2), std::sqrt( -discriminant ) / (2 * b2)
-					);
-					poles.emplace_back
-					(
-						-b1 / (2 * b2), -std::sqrt( -discriminant ) / (2 * b2)
-					);
-				}
+		// Poles (z-plane roots of the denominator) without allocation.
+		BiquadRoots<T> Poles() const
+		{
+			return Detail::PolynomialRoots( b0, b1, b2 );
+		}
 
-			}
+		// Zeros (z-plane roots of the numerator) without allocation.
+		BiquadRoots<T> Zeros() const
+		{
+			return Detail::PolynomialRoots( a0, a1, a2 );
+		}
 
-			return poles;
+		// Calculates the poles of the transfer function.
+		std::vector<std::complex<T>> calculatePoles() const
+		{
+			const BiquadRoots<T> poles = Poles();
+			return std::vector<std::complex<T>>( poles.begin(), poles.end() );
 		}
 
 		// Calculates the zeros of the transfer function.
 		std::vector<std::complex<T>> calculateZeros() const
 		{
-			std::vector<std::complex<T>> zeros;
-			if (std::abs( a2 ) < std::numeric_limits<T>::epsilon())
-			{
-				// First-order case (a2 is approximately zero)
-				if (std::abs( a1 ) > std::numeric_limits<T>::epsilon())
-				{
-					zeros.emplace_back( -a0 / a1, static_cast<T>(0) );
-				}
-				// If both a1 and a2 are zero, there are no finite zeros
-				//	(only at infinity if a0 is non-zero)
-				else if (std::abs( a0 ) > std::numeric_limits<T>::epsilon())
-				{
-					// A zero at z = 0 if a0 is zero and a1 or a2 are not.
-				}
-			}
-			else
-			{
-				T discriminant = a1 * a1 - 4 * a0 * a2;
-				if (discriminant >= 0)
-				{
-					zeros.emplace_back
-					(
-						(-a1 + std::sqrt( discriminant )) / (2 * a2), static_cast<T>(0)
-					);
-					zeros.emplace_back
-					(
-						(-a1 - std::sqrt( discriminant )) / (2 * a2), static_cast<T>(0)
-					);
-				}
-				else
-				{
-					zeros.emplace_back
-					(
-						-a1 / (2 * a2), std::sqrt( -discriminant ) / (2 * a2)
-					);
-
-					zeros.emplace_back
-					(
-						-a1 / (2 * a2), -std::sqrt( -discriminant ) / (2 * a2)
-					);
-				}
-			}
-			return zeros;
-
-
-		};
-
-
+			const BiquadRoots<T> zeros = Zeros();
+			return std::vector<std::complex<T>>( zeros.begin(), zeros.end() );
+		}
 	};
 }
 
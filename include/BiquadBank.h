@@ -0,0 +1,278 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <stdexcept>
+#include "Biquad.h"
+#include "IIRBatchDesign.h"
+
+// Structure-of-arrays storage for large sets of biquads.
+//
+// A BiquadBank holds a0, a1, a2, b1, b2 in five separate arrays (b0 = 1 is
+// implicit, so 5 instead of 6 values per filter). Every array starts on a 64
+// byte boundary and is padded to a whole number of 64 byte lines
+// (Lanes values) with pass-through filters, so kernels may run full SIMD
+// lanes over PaddedSpans() without a remainder loop.
+//
+// The storage type is independent of the design precision: a
+// BiquadBank<float> built from double designs halves the footprint again.
+//
+// Spans() returns the IIR::BiquadSpans used by the batch designers, so a bank
+// can be designed in place; ConstBiquadSpans is the read only counterpart
+// taken by the bank evaluators below and by CheckStability / CheckMinimumPhase.
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	struct ConstBiquadSpans
+	{
+		std::span<const T> a0, a1, a2;
+		std::span<const T> b1, b2;
+
+		size_t size() const { return a0.size(); }
+
+		Biquad<T> operator[]( size_t index ) const
+		{
+			return Biquad<T>( a0[index], a1[index], a2[index], b1[index], b2[index] );
+		}
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class BiquadBank
+	{
+	public:
+
+		static constexpr size_t Alignment = 64;
+		static constexpr size_t Lanes = Alignment / sizeof( T );
+
+		BiquadBank() = default;
+
+		// count pass-through filters.
+		explicit BiquadBank( size_t count )
+		{
+			Allocate( count );
+		}
+
+		template <typename U> requires std::is_floating_point_v<U>
+		explicit BiquadBank( std::span<const Biquad<U>> biquads )
+		{
+			Allocate( biquads.size() );
+			for (size_t i = 0; i < biquads.size(); i++)
+			{
+				Set( i, biquads[i] );
+			}
+		}
+
+		template <typename U> requires std::is_floating_point_v<U>
+		explicit BiquadBank( const std::vector<Biquad<U>>& biquads )
+			: BiquadBank( std::span<const Biquad<U>>( biquads ) )
+		{
+		}
+
+		BiquadBank( const BiquadBank& other )
+		{
+			Allocate( other.count );
+			std::copy_n( other.storage.get(), Coefficients * padded, storage.get() );
+		}
+
+		BiquadBank& operator=( const BiquadBank& other )
+		{
+			if (this != &other)
+			{
+				BiquadBank copy( other );
+				*this = std::move( copy );
+			}
+			return *this;
+		}
+
+		BiquadBank( BiquadBank&& other ) noexcept
+			: storage( std::move( other.storage ) ),
+			count( std::exchange( other.count, 0 ) ),
+			padded( std::exchange( other.padded, 0 ) )
+		{
+		}
+
+		BiquadBank& operator=( BiquadBank&& other ) noexcept
+		{
+			storage = std::move( other.storage );
+			count = std::exchange( other.count, 0 );
+			padded = std::exchange( other.padded, 0 );
+			return *this;
+		}
+
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		// Filters including the pass-through padding.
+		size_t PaddedSize() const { return padded; }
+
+		size_t MemoryBytes() const { return Coefficients * padded * sizeof( T ); }
+
+		Biquad<T> operator[]( size_t index ) const
+		{
+			return Biquad<T>( Array( 0 )[index], Array( 1 )[index], Array( 2 )[index],
+				Array( 3 )[index], Array( 4 )[index] );
+		}
+
+		// Stores a biquad, converting to the storage type (and normalizing
+		// b0 if needed).
+		template <typename U> requires std::is_floating_point_v<U>
+		void Set( size_t index, const Biquad<U>& biquad )
+		{
+			if (index >= count)
+			{
+				throw std::out_of_range( "BiquadBank index out of range." );
+			}
+
+			const U norm = biquad.b0 == 1 ? U( 1 ) : 1 / biquad.b0;
+			Array( 0 )[index] = static_cast<T>(biquad.a0 * norm);
+			Array( 1 )[index] = static_cast<T>(biquad.a1 * norm);
+			Array( 2 )[index] = static_cast<T>(biquad.a2 * norm);
+			Array( 3 )[index] = static_cast<T>(biquad.b1 * norm);
+			Array( 4 )[index] = static_cast<T>(biquad.b2 * norm);
+		}
+
+		template <typename U = T> requires std::is_floating_point_v<U>
+		std::vector<Biquad<U>> ToBiquads() const
+		{
+			std::vector<Biquad<U>> biquads;
+			biquads.reserve( count );
+
+			for (size_t i = 0; i < count; i++)
+			{
+				biquads.emplace_back( static_cast<U>(Array( 0 )[i]), static_cast<U>(Array( 1 )[i]),
+					static_cast<U>(Array( 2 )[i]), static_cast<U>(Array( 3 )[i]),
+					static_cast<U>(Array( 4 )[i]) );
+			}
+
+			return biquads;
+		}
+
+		BiquadSpans<T> Spans()
+		{
+			return MutableSpans( count );
+		}
+
+		ConstBiquadSpans<T> Spans() const
+		{
+			return ConstSpans( count );
+		}
+
+		// Views over PaddedSize() filters; the padding is pass-through and
+		// must stay so.
+		BiquadSpans<T> PaddedSpans()
+		{
+			return MutableSpans( padded );
+		}
+
+		ConstBiquadSpans<T> PaddedSpans() const
+		{
+			return ConstSpans( padded );
+		}
+
+	private:
+
+		static constexpr size_t Coefficients = 5;
+
+		struct AlignedDelete
+		{
+			void operator()( T* data ) const
+			{
+				::operator delete[]( data, std::align_val_t( Alignment ) );
+			}
+		};
+
+		void Allocate( size_t filters )
+		{
+			count = filters;
+			padded = (filters + Lanes - 1) / Lanes * Lanes;
+
+			if (padded == 0)
+			{
+				storage.reset();
+				return;
+			}
+
+			storage.reset( static_cast<T*>(::operator new[](
+				Coefficients * padded * sizeof( T ), std::align_val_t( Alignment ) )) );
+
+			// Pass-through: a0 = 1, everything else 0.
+			std::fill_n( storage.get(), Coefficients * padded, T( 0 ) );
+			std::fill_n( storage.get(), padded, T( 1 ) );
+		}
+
+		T* Array( size_t coefficient ) const
+		{
+			return storage.get() + coefficient * padded;
+		}
+
+		BiquadSpans<T> MutableSpans( size_t filters )
+		{
+			return { { Array( 0 ), filters }, { Array( 1 ), filters }, { Array( 2 ), filters },
+				{ Array( 3 ), filters }, { Array( 4 ), filters } };
+		}
+
+		ConstBiquadSpans<T> ConstSpans( size_t filters ) const
+		{
+			return { { Array( 0 ), filters }, { Array( 1 ), filters }, { Array( 2 ), filters },
+				{ Array( 3 ), filters }, { Array( 4 ), filters } };
+		}
+
+		std::unique_ptr<T[], AlignedDelete> storage;
+		size_t count = 0;
+		size_t padded = 0;
+	};
+}
+
+namespace DigitalFilters::Eval
+{
+	// |H(e^jw)| of every filter of a bank at one omega (radians per sample),
+	// as CalcFreqResponseTrig computes it.
+	template <typename T> requires std::is_floating_point_v<T>
+	void CalcMagnitudeResponse( IIR::ConstBiquadSpans<T> biquads, T omega, std::span<T> magnitude )
+	{
+		const size_t count = biquads.size();
+		if (magnitude.size() != count)
+		{
+			throw std::invalid_argument( "magnitude must have one value per filter." );
+		}
+
+		const T c1 = std::cos( omega ), s1 = std::sin( omega );
+		const T c2 = std::cos( 2 * omega ), s2 = std::sin( 2 * omega );
+		const T* a0 = biquads.a0.data();
+		const T* a1 = biquads.a1.data();
+		const T* a2 = biquads.a2.data();
+		const T* b1 = biquads.b1.data();
+		const T* b2 = biquads.b2.data();
+		T* out = magnitude.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; i++)
+		{
+			const T nRe = a0[i] + a1[i] * c1 + a2[i] * c2;
+			const T nIm = a1[i] * s1 + a2[i] * s2;
+			const T dRe = 1 + b1[i] * c1 + b2[i] * c2;
+			const T dIm = b1[i] * s1 + b2[i] * s2;
+			out[i] = (nRe * nRe + nIm * nIm) / (dRe * dRe + dIm * dIm);
+		}
+
+		// Separate pass: with errno setting math (GCC's default) a sqrt in
+		// the loop above would keep it from vectorizing.
+		for (size_t i = 0; i < count; i++)
+		{
+			out[i] = std::sqrt( out[i] );
+		}
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	void CalcMagnitudeResponse( const IIR::BiquadBank<T>& bank, T omega, std::span<T> magnitude )
+	{
+		CalcMagnitudeResponse( bank.Spans(), omega, magnitude );
+	}
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <utility>
+#include <array>
+#include <stdexcept>
+#include "Biquad.h"
+#include "Instrumentation.h"
+
+// Sample processing of a biquad cascade.
+//
+// Each section runs in transposed direct form II:
+//
+//     y  = a0 x + s1
+//     s1 = a1 x - b1 y + s2
+//     s2 = a2 x - b2 y
+//
+// with b0 = 1 (the designers' normalization). Sections run one after the
+// other, so every sample walks the whole dependency chain.
+//
+// CascadeProcessor holds any number of sections. Cascade<T, N> fixes the
+// count at compile time: coefficients and state of each stage share one
+// aligned block (a 64 byte cache line for double), storage is inline and the
+// stage loop is expanded at compile time, so there is no heap allocation and
+// no loop overhead between stages.
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	class CascadeProcessor
+	{
+	public:
+
+		explicit CascadeProcessor( std::vector<Biquad<T>> sections )
+			: sections( std::move( sections ) ),
+			state( 2 * this->sections.size(), T( 0 ) )
+		{
+		}
+
+		size_t Sections() const { return sections.size(); }
+
+		void Reset()
+		{
+			std::fill( state.begin(), state.end(), T( 0 ) );
+		}
+
+		T Process( T x )
+		{
+			T* s = state.data();
+
+			for (const Biquad<T>& section : sections)
+			{
+				const T y = section.a0 * x + s[0];
+				s[0] = section.a1 * x - section.b1 * y + s[1];
+				s[1] = section.a2 * x - section.b2 * y;
+				x = y;
+				s += 2;
+			}
+
+			return x;
+		}
+
+		// input and output may be the same buffer.
+		void Process( std::span<const T> input, std::span<T> output )
+		{
+			if (input.size() != output.size())
+			{
+				throw std::invalid_argument( "input and output must have the same size." );
+			}
+
+			DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::CascadeProcess, input.size(), 0 );
+
+			for (size_t i = 0; i < input.size(); i++)
+			{
+				output[i] = Process( input[i] );
+			}
+		}
+
+	private:
+
+		std::vector<Biquad<T>> sections;
+
+		// s1, s2 per section.
+		std::vector<T> state;
+	};
+
+	template <typename T, size_t N>
+		requires std::is_floating_point_v<T> && (N > 0)
+	class Cascade
+	{
+	public:
+
+		static constexpr size_t Sections = N;
+
+		// N pass-through sections.
+		constexpr Cascade()
+		{
+			for (Stage& stage : stages)
+			{
+				stage.biquad = Biquad<T>( 1, 0, 0, 0, 0 );
+			}
+		}
+
+		constexpr explicit Cascade( const std::array<Biquad<T>, N>& sections )
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				SetSection( i, sections[i] );
+			}
+		}
+
+		// From the IIR:: cascade designers, e.g.
+		// Cascade<double, 4>( LowPassCascadeAsButterworth( 8, Fc, Fs ) ).
+		explicit Cascade( std::span<const Biquad<T>> sections )
+		{
+			if (sections.size() != N)
+			{
+				throw std::invalid_argument( "Section count does not match the cascade size." );
+			}
+
+			for (size_t i = 0; i < N; i++)
+			{
+				SetSection( i, sections[i] );
+			}
+		}
+
+		explicit Cascade( const std::vector<Biquad<T>>& sections )
+			: Cascade( std::span<const Biquad<T>>( sections ) )
+		{
+		}
+
+		const Biquad<T>& Section( size_t index ) const
+		{
+			return stages[index].biquad;
+		}
+
+		// Replaces the coefficients and keeps the state, so sections can be
+		// retuned while running.
+		constexpr void SetSection( size_t index, const Biquad<T>& section )
+		{
+			if (section.b0 != 1)
+			{
+				throw std::invalid_argument( "Sections must be normalized (b0 = 1)." );
+			}
+			stages[index].biquad = section;
+		}
+
+		constexpr void Reset()
+		{
+			for (Stage& stage : stages)
+			{
+				stage.s1 = stage.s2 = 0;
+			}
+		}
+
+		constexpr T Process( T x )
+		{
+			return ProcessStages( stages, x, std::make_index_sequence<N>{} );
+		}
+
+		// input and output may be the same buffer.
+		void Process( std::span<const T> input, std::span<T> output )
+		{
+			if (input.size() != output.size())
+			{
+				throw std::invalid_argument( "input and output must have the same size." );
+			}
+
+			DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::FixedCascadeProcess, input.size(), 0 );
+
+			// Work on a local copy so the state can live in registers for the
+			// whole block instead of going through memory every sample.
+			std::array<Stage, N> local = stages;
+
+			for (size_t i = 0; i < input.size(); i++)
+			{
+				output[i] = ProcessStages( local, input[i], std::make_index_sequence<N>{} );
+			}
+
+			stages = local;
+		}
+
+	private:
+
+		// Eight coefficients / state values: one aligned block per stage.
+		struct alignas(sizeof( T ) * 8) Stage
+		{
+			Biquad<T> biquad;
+			T s1 = 0, s2 = 0;
+		};
+
+		static constexpr T ProcessStage( Stage& stage, T x )
+		{
+			const Biquad<T>& c = stage.biquad;
+			const T y = c.a0 * x + stage.s1;
+			stage.s1 = c.a1 * x - c.b1 * y + stage.s2;
+			stage.s2 = c.a2 * x - c.b2 * y;
+			return y;
+		}
+
+		template <size_t... I>
+		static constexpr T ProcessStages( std::array<Stage, N>& chain, T x, std::index_sequence<I...> )
+		{
+			((x = ProcessStage( chain[I], x )), ...);
+			return x;
+		}
+
+		std::array<Stage, N> stages{};
+	};
+}
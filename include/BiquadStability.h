@@ -0,0 +1,145 @@
+#pragma once
+
+#include <type_traits>
+#include <span>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+#include "Biquad.h"
+
+// Stability and minimum phase checks.
+//
+// Both tests work on the coefficients directly (stability triangle), no roots
+// are computed. For b0 = 1 the poles are strictly inside the unit circle iff
+//
+//     |b2| < 1  and  |b1| < 1 + b2
+//
+// and the same test on a1 / a0, a2 / a0 places the zeros strictly inside the
+// unit circle (minimum phase; zeros on the circle, e.g. notches, and a0 = 0
+// fail). The batch versions are branch free over structure-of-arrays
+// coefficients so the compiler can vectorize them (#pragma omp simd).
+
+namespace DigitalFilters
+{
+	namespace Detail
+	{
+		template <typename T>
+		inline bool StableDenominator( T b1, T b2 )
+		{
+			return (std::abs( b2 ) < 1) & (std::abs( b1 ) < 1 + b2);
+		}
+
+		// Minimum phase test scaled by |a0| to avoid the division.
+		template <typename T>
+		inline bool MinimumPhaseNumerator( T a0, T a1, T a2 )
+		{
+			const T scale = std::abs( a0 );
+			const T a2Signed = a0 < 0 ? -a2 : a2;
+			return (std::abs( a2 ) < scale) & (std::abs( a1 ) < scale + a2Signed);
+		}
+
+		template <typename... Spans>
+		void CheckSameSize( size_t size, const Spans&... spans )
+		{
+			if (((spans.size() != size) || ...))
+			{
+				throw std::invalid_argument( "All coefficient spans must have the same size." );
+			}
+		}
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	bool IsStable( const Biquad<T>& biquad )
+	{
+		return Detail::StableDenominator( biquad.b1 / biquad.b0, biquad.b2 / biquad.b0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	bool IsMinimumPhase( const Biquad<T>& biquad )
+	{
+		return Detail::MinimumPhaseNumerator( biquad.a0, biquad.a1, biquad.a2 );
+	}
+
+	// Checks N normalized (b0 = 1) denominators. stable[i] is set to 1 when
+	// filter i is stable and 0 otherwise. Returns the number of unstable
+	// filters.
+	template <typename T> requires std::is_floating_point_v<T>
+	size_t CheckStability( std::span<const T> b1, std::span<const T> b2,
+		std::span<std::uint8_t> stable )
+	{
+		const size_t count = b1.size();
+		Detail::CheckSameSize( count, b2, stable );
+
+		size_t unstable = 0;
+
+		#pragma omp simd reduction(+:unstable)
+		for (size_t i = 0; i < count; i++)
+		{
+			const bool ok = Detail::StableDenominator( b1[i], b2[i] );
+			stable[i] = static_cast<std::uint8_t>(ok);
+			unstable += !ok;
+		}
+
+		return unstable;
+	}
+
+	// Same for the numerators: minimumPhase[i] is 1 when the zeros of filter
+	// i are strictly inside the unit circle. Returns the number of filters
+	// that are not minimum phase.
+	template <typename T> requires std::is_floating_point_v<T>
+	size_t CheckMinimumPhase( std::span<const T> a0, std::span<const T> a1,
+		std::span<const T> a2, std::span<std::uint8_t> minimumPhase )
+	{
+		const size_t count = a0.size();
+		Detail::CheckSameSize( count, a1, a2, minimumPhase );
+
+		size_t failing = 0;
+
+		#pragma omp simd reduction(+:failing)
+		for (size_t i = 0; i < count; i++)
+		{
+			const bool ok = Detail::MinimumPhaseNumerator( a0[i], a1[i], a2[i] );
+			minimumPhase[i] = static_cast<std::uint8_t>(ok);
+			failing += !ok;
+		}
+
+		return failing;
+	}
+
+	// Array-of-structures overloads for banks of Biquad. The stride keeps them
+	// from vectorizing as well as the span versions above.
+	template <typename T> requires std::is_floating_point_v<T>
+	size_t CheckStability( std::span<const Biquad<T>> biquads, std::span<std::uint8_t> stable )
+	{
+		Detail::CheckSameSize( biquads.size(), stable );
+
+		size_t unstable = 0;
+
+		for (size_t i = 0; i < biquads.size(); i++)
+		{
+			const bool ok = IsStable( biquads[i] );
+			stable[i] = static_cast<std::uint8_t>(ok);
+			unstable += !ok;
+		}
+
+		return unstable;
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	size_t CheckMinimumPhase( std::span<const Biquad<T>> biquads,
+		std::span<std::uint8_t> minimumPhase )
+	{
+		Detail::CheckSameSize( biquads.size(), minimumPhase );
+
+		size_t failing = 0;
+
+		for (size_t i = 0; i < biquads.size(); i++)
+		{
+			const bool ok = IsMinimumPhase( biquads[i] );
+			minimumPhase[i] = static_cast<std::uint8_t>(ok);
+			failing += !ok;
+		}
+
+		return failing;
+	}
+}
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include "Constants.h"
+#include "Parallel.h"
+
+// Reproducible datasets for tests and benchmarks.
+//
+// A Dataset only describes the values (distribution, parameters, seed and
+// size); nothing is generated until asked for. Value i is a pure function of
+// (seed, i): a counter based generator (SplitMix64 of seed and index) instead
+// of a sequential engine. So
+//   - the values are the same on every run and thread count. The hashes and
+//     the Uniform values are also bit-identical on every platform; LogUniform,
+//     Gaussian and LogSweep go through pow, log, cos or exp2, whose last bit
+//     may differ between C libraries,
+//   - any range can be produced on its own: Fill runs in parallel
+//     (Parallel::For) and ForEachChunk streams a dataset of any size through
+//     a fixed buffer,
+//   - generating is cheap: a few ns per value for Uniform and LogSweep, a few
+//     tens of ns for LogUniform and Gaussian (see BM_DatasetsFill).
+//
+// LazyDataset materializes a dataset on first use (once, thread safe), so it
+// can be a global of a test program without costing anything at startup for
+// the tests that do not use it.
+
+namespace DigitalFilters::Datasets
+{
+	enum class Distribution
+	{
+		// Uniform in [a, b).
+		Uniform,
+		// Uniform in log between a and b (a, b > 0).
+		LogUniform,
+		// Normal with mean a and standard deviation b.
+		Gaussian,
+		// Deterministic log spaced sweep from a to b, both included (seed unused).
+		LogSweep
+	};
+
+	struct Dataset
+	{
+		Distribution distribution = Distribution::Uniform;
+		double a = 0;
+		double b = 1;
+		uint64_t seed = 0;
+		size_t size = 0;
+	};
+
+	inline Dataset Uniform( uint64_t seed, size_t size, double min, double max )
+	{
+		return { Distribution::Uniform, min, max, seed, size };
+	}
+
+	inline Dataset LogUniform( uint64_t seed, size_t size, double min, double max )
+	{
+		if (!(min > 0) || !(max > 0))
+		{
+			throw std::invalid_argument( "LogUniform bounds must be positive." );
+		}
+		return { Distribution::LogUniform, min, max, seed, size };
+	}
+
+	inline Dataset Gaussian( uint64_t seed, size_t size, double mean, double deviation )
+	{
+		return { Distribution::Gaussian, mean, deviation, seed, size };
+	}
+
+	inline Dataset LogSweep( size_t size, double first, double last )
+	{
+		if (!(first > 0) || !(last > 0))
+		{
+			throw std::invalid_argument( "LogSweep bounds must be positive." );
+		}
+		return { Distribution::LogSweep, first, last, 0, size };
+	}
+
+	namespace Detail
+	{
+		// SplitMix64 finalizer of the index'th element of stream seed.
+		constexpr uint64_t Hash( uint64_t seed, uint64_t index )
+		{
+			uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+
+		// 53 random bits in [0, 1).
+		constexpr double UnitInterval( uint64_t bits )
+		{
+			return static_cast<double>(bits >> 11) * 0x1.0p-53;
+		}
+
+		// Outputs per Parallel::For chunk: large enough to amortize the
+		// scheduling. Ranges of up to 4 chunks are filled serially.
+		constexpr size_t ParallelGrain = 1 << 16;
+	}
+
+	// Value index of dataset (index < dataset.size is not checked).
+	template <typename T> requires std::is_floating_point_v<T>
+	T Value( const Dataset& dataset, size_t index )
+	{
+		const double a = dataset.a, b = dataset.b;
+
+		switch (dataset.distribution)
+		{
+		case Distribution::Uniform:
+			return static_cast<T>(a + (b - a) * Detail::UnitInterval( Detail::Hash( dataset.seed, index ) ));
+
+		case Distribution::LogUniform:
+			return static_cast<T>(a * std::pow( b / a, Detail::UnitInterval( Detail::Hash( dataset.seed, index ) ) ));
+
+		case Distribution::Gaussian:
+		{
+			// Box-Muller on two values of the index, cosine branch only.
+			const double u1 = 1 - Detail::UnitInterval( Detail::Hash( dataset.seed, 2 * index ) );
+			const double u2 = Detail::UnitInterval( Detail::Hash( dataset.seed, 2 * index + 1 ) );
+			return static_cast<T>(a + b * std::sqrt( -2 * std::log( u1 ) )
+				* std::cos( 2 * Constants::pi<double>() * u2 ));
+		}
+
+		case Distribution::LogSweep:
+			if (dataset.size < 2)
+			{
+				return static_cast<T>(a);
+			}
+			if (index + 1 == dataset.size)
+			{
+				return static_cast<T>(b);
+			}
+			return static_cast<T>(std::exp2( std::log2( a )
+				+ (std::log2( b ) - std::log2( a )) / (dataset.size - 1) * static_cast<double>(index) ));
+		}
+
+		throw std::invalid_argument( "Unknown distribution." );
+	}
+
+	// Values first .. first + output.size() - 1 of dataset, in parallel for
+	// large ranges.
+	template <typename T> requires std::is_floating_point_v<T>
+	void Fill( const Dataset& dataset, size_t first, std::span<T> output )
+	{
+		if (first > dataset.size || output.size() > dataset.size - first)
+		{
+			throw std::out_of_range( "Range outside the dataset." );
+		}
+
+		const size_t count = output.size();
+		const uint64_t seed = dataset.seed;
+		const double a = dataset.a, b = dataset.b;
+		T* out = output.data();
+
+		Parallel::Options options = Parallel::DefaultOptions();
+		options.grain = Detail::ParallelGrain;
+		if (count <= 4 * Detail::ParallelGrain)
+		{
+			options.backend = Parallel::Backend::Serial;
+		}
+
+		// One loop per distribution, so the per value work is branch free.
+		auto run = [&]( auto value )
+		{
+			Parallel::For( count, options, [&]( size_t begin, size_t end )
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						out[i] = static_cast<T>(value( first + i ));
+					}
+				} );
+		};
+
+		switch (dataset.distribution)
+		{
+		case Distribution::Uniform:
+			run( [=]( size_t index ) { return a + (b - a) * Detail::UnitInterval( Detail::Hash( seed, index ) ); } );
+			break;
+
+		case Distribution::LogSweep:
+			if (dataset.size < 3)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					out[i] = Value<T>( dataset, first + i );
+				}
+				break;
+			}
+			{
+				// a * (b / a)^t as exp2 of a linear function of the index.
+				const double logA = std::log2( a );
+				const double step = (std::log2( b ) - logA) / (dataset.size - 1);
+				run( [=]( size_t index ) { return std::exp2( logA + step * static_cast<double>(index) ); } );
+			}
+			if (first + output.size() == dataset.size && count > 0)
+			{
+				out[count - 1] = static_cast<T>(b);
+			}
+			break;
+
+		default:
+			run( [&]( size_t index ) { return Value<double>( dataset, index ); } );
+			break;
+		}
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	std::vector<T> Generate( const Dataset& dataset )
+	{
+		std::vector<T> values( dataset.size );
+		Fill<T>( dataset, 0, values );
+		return values;
+	}
+
+	// Calls onChunk( first, values ) for consecutive chunks of at most
+	// chunkSize values, reusing one buffer.
+	template <typename T, typename OnChunk> requires std::is_floating_point_v<T>
+	void ForEachChunk( const Dataset& dataset, size_t chunkSize, OnChunk&& onChunk )
+	{
+		if (chunkSize == 0)
+		{
+			throw std::invalid_argument( "chunkSize must be positive." );
+		}
+
+		std::vector<T> buffer( std::min( chunkSize, dataset.size ) );
+		for (size_t first = 0; first < dataset.size; first += chunkSize)
+		{
+			const std::span<T> chunk( buffer.data(), std::min( chunkSize, dataset.size - first ) );
+			Fill<T>( dataset, first, chunk );
+			onChunk( first, std::span<const T>( chunk ) );
+		}
+	}
+
+	// A dataset generated on first access.
+	template <typename T> requires std::is_floating_point_v<T>
+	class LazyDataset
+	{
+	public:
+
+		explicit LazyDataset( const Dataset& dataset )
+			: dataset( dataset )
+		{
+		}
+
+		const Dataset& Description() const { return dataset; }
+
+		size_t size() const { return dataset.size; }
+
+		bool Generated() const { return generated.load( std::memory_order_acquire ); }
+
+		const std::vector<T>& Values() const
+		{
+			std::call_once( once, [this]
+				{
+					values = Generate<T>( dataset );
+					generated.store( true, std::memory_order_release );
+				} );
+			return values;
+		}
+
+	private:
+
+		Dataset dataset;
+		mutable std::once_flag once;
+		mutable std::atomic<bool> generated{ false };
+		mutable std::vector<T> values;
+	};
+}
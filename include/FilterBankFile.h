@@ -0,0 +1,566 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <array>
+#include <memory>
+#include <new>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include "Biquad.h"
+#include "BiquadBank.h"
+#include "IIRDesign.h"
+#include "MappedFile.h"
+
+// Binary filter bank files.
+//
+// A filter bank file stores biquad sections as structure-of-arrays
+// coefficients (a0, a1, a2, b1, b2; b0 = 1), optionally grouped into
+// cascades and optionally with the design parameters of every section. On a
+// little endian machine FilterBankFile::Open maps the file and its views
+// point into the mapping: Sections() is a ConstBiquadSpans for the bank
+// evaluators (Eval::CalcMagnitudeResponse, CheckStability, ...) and
+// CascadeSections( k ) gives the sections a CascadeProcessor or Cascade is
+// built from. Opening only checks the header (and its checksum); Verify()
+// also checks the payload checksum, which reads the whole file.
+//
+// File layout, version 1. All values little endian, every array 64 byte
+// aligned, in this order right after the header:
+//
+//   Header (256 bytes)
+//     0    char     magic[8]          "DFBIQUAD"
+//     8    uint32   version           1
+//     12   uint32   flags             bit 0: design parameters present
+//     16   uint64   sectionCount
+//     24   uint64   cascadeCount      0: a flat bank
+//     32   uint64   fileSize
+//     40   uint64   payloadChecksum   XXH64 (seed 0) of bytes 256 .. fileSize - 1
+//     48   uint64   offsets[11]       of the arrays below, 0 when absent
+//     136  (zero)
+//     248  uint64   headerChecksum    XXH64 (seed 0) of bytes 0 .. 247
+//   double  a0[sectionCount], a1[], a2[], b1[], b2[]
+//   uint64  cascadeStarts[cascadeCount + 1]   (cascade k: sections
+//                                              cascadeStarts[k] ..
+//                                              cascadeStarts[k + 1] - 1)
+//   int32   type[sectionCount]       IIR::FilterType, NoDesign (-1) if unknown
+//   double  peakGain[sectionCount], Fc[], Q[], Fs[]
+//
+// The arrays start at the offsets the writer computes from the counts
+// (the reader rejects any other), so a file is fully defined by its content.
+// On a big endian machine Open reads the file into memory and swaps the
+// bytes instead of mapping it.
+
+namespace DigitalFilters::IIR
+{
+	// Design parameters of a section; type NoDesign when unknown.
+	struct SectionDesign
+	{
+		static constexpr int32_t NoDesign = -1;
+
+		int32_t type = NoDesign;
+		double peakGain = 0;
+		double Fc = 0;
+		double Q = 0;
+		double Fs = 0;
+	};
+
+	namespace FilterBankFormat
+	{
+		constexpr std::array<char, 8> Magic = { 'D', 'F', 'B', 'I', 'Q', 'U', 'A', 'D' };
+		constexpr uint32_t Version = 1;
+		constexpr uint32_t HasDesigns = 1;
+		constexpr uint64_t HeaderSize = 256;
+		constexpr uint64_t HeaderChecksumOffset = 248;
+		constexpr uint64_t ArrayAlignment = 64;
+
+		enum Array : size_t
+		{
+			A0, A1, A2, B1, B2, CascadeStarts, Type, PeakGain, Fc, Q, Fs, ArrayCount
+		};
+
+		struct Header
+		{
+			uint32_t version = Version;
+			uint32_t flags = 0;
+			uint64_t sectionCount = 0;
+			uint64_t cascadeCount = 0;
+			uint64_t fileSize = 0;
+			uint64_t payloadChecksum = 0;
+			std::array<uint64_t, ArrayCount> offsets{};
+		};
+	}
+
+	namespace Detail
+	{
+		template <typename T> requires std::is_trivially_copyable_v<T>
+		T ByteSwap( T value )
+		{
+			std::array<std::byte, sizeof( T )> bytes;
+			std::memcpy( bytes.data(), &value, sizeof( T ) );
+			std::reverse( bytes.begin(), bytes.end() );
+			std::memcpy( &value, bytes.data(), sizeof( T ) );
+			return value;
+		}
+
+		template <typename T>
+		T LoadLittleEndian( const std::byte* source )
+		{
+			T value;
+			std::memcpy( &value, source, sizeof( T ) );
+			return std::endian::native == std::endian::little ? value : ByteSwap( value );
+		}
+
+		template <typename T>
+		void StoreLittleEndian( std::byte* target, T value )
+		{
+			if constexpr (std::endian::native != std::endian::little)
+			{
+				value = ByteSwap( value );
+			}
+			std::memcpy( target, &value, sizeof( T ) );
+		}
+
+		constexpr uint64_t RotateLeft( uint64_t value, int bits )
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		// XXH64 of bytes (the reference algorithm, seed 0).
+		inline uint64_t Checksum( std::span<const std::byte> bytes )
+		{
+			constexpr uint64_t P1 = 11400714785074694791ull, P2 = 14029467366897019727ull,
+				P3 = 1609587929392839161ull, P4 = 9650029242287828579ull, P5 = 2870177450012600261ull;
+
+			auto round = []( uint64_t accumulator, uint64_t input )
+			{
+				return RotateLeft( accumulator + input * P2, 31 ) * P1;
+			};
+			auto merge = [&]( uint64_t hash, uint64_t accumulator )
+			{
+				return (hash ^ round( 0, accumulator )) * P1 + P4;
+			};
+
+			const std::byte* p = bytes.data();
+			const std::byte* const end = p + bytes.size();
+			uint64_t hash;
+
+			if (bytes.size() >= 32)
+			{
+				uint64_t v1 = P1 + P2, v2 = P2, v3 = 0, v4 = 0 - P1;
+				for (; end - p >= 32; p += 32)
+				{
+					v1 = round( v1, LoadLittleEndian<uint64_t>( p ) );
+					v2 = round( v2, LoadLittleEndian<uint64_t>( p + 8 ) );
+					v3 = round( v3, LoadLittleEndian<uint64_t>( p + 16 ) );
+					v4 = round( v4, LoadLittleEndian<uint64_t>( p + 24 ) );
+				}
+				hash = RotateLeft( v1, 1 ) + RotateLeft( v2, 7 ) + RotateLeft( v3, 12 ) + RotateLeft( v4, 18 );
+				hash = merge( merge( merge( merge( hash, v1 ), v2 ), v3 ), v4 );
+			}
+			else
+			{
+				hash = P5;
+			}
+
+			hash += bytes.size();
+			for (; end - p >= 8; p += 8)
+			{
+				hash = RotateLeft( hash ^ round( 0, LoadLittleEndian<uint64_t>( p ) ), 27 ) * P1 + P4;
+			}
+			if (end - p >= 4)
+			{
+				hash = RotateLeft( hash ^ (LoadLittleEndian<uint32_t>( p ) * P1), 23 ) * P2 + P3;
+				p += 4;
+			}
+			for (; p < end; p++)
+			{
+				hash = RotateLeft( hash ^ (std::to_integer<uint64_t>( *p ) * P5), 11 ) * P1;
+			}
+
+			hash ^= hash >> 33;
+			hash *= P2;
+			hash ^= hash >> 29;
+			hash *= P3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+
+		// Header of a file with these counts, offsets and size included.
+		inline FilterBankFormat::Header MakeFilterBankHeader( uint64_t sections, uint64_t cascades, bool designs )
+		{
+			using namespace FilterBankFormat;
+
+			Header header;
+			header.flags = designs ? HasDesigns : 0;
+			header.sectionCount = sections;
+			header.cascadeCount = cascades;
+
+			uint64_t offset = HeaderSize;
+			auto place = [&]( Array array, uint64_t bytes )
+			{
+				offset = (offset + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+				header.offsets[array] = offset;
+				offset += bytes;
+			};
+
+			for (Array array : { A0, A1, A2, B1, B2 })
+			{
+				place( array, sections * sizeof( double ) );
+			}
+			if (cascades > 0)
+			{
+				place( CascadeStarts, (cascades + 1) * sizeof( uint64_t ) );
+			}
+			if (designs)
+			{
+				place( Type, sections * sizeof( int32_t ) );
+				for (Array array : { PeakGain, Fc, Q, Fs })
+				{
+					place( array, sections * sizeof( double ) );
+				}
+			}
+			header.fileSize = offset;
+			return header;
+		}
+
+		inline void StoreHeader( std::byte* target, const FilterBankFormat::Header& header )
+		{
+			using namespace FilterBankFormat;
+
+			std::memset( target, 0, HeaderSize );
+			std::memcpy( target, Magic.data(), Magic.size() );
+			StoreLittleEndian( target + 8, header.version );
+			StoreLittleEndian( target + 12, header.flags );
+			StoreLittleEndian( target + 16, header.sectionCount );
+			StoreLittleEndian( target + 24, header.cascadeCount );
+			StoreLittleEndian( target + 32, header.fileSize );
+			StoreLittleEndian( target + 40, header.payloadChecksum );
+			for (size_t a = 0; a < ArrayCount; a++)
+			{
+				StoreLittleEndian( target + 48 + 8 * a, header.offsets[a] );
+			}
+			StoreLittleEndian( target + HeaderChecksumOffset,
+				Checksum( std::span<const std::byte>( target, HeaderChecksumOffset ) ) );
+		}
+
+		inline FilterBankFormat::Header LoadHeader( const std::byte* source )
+		{
+			FilterBankFormat::Header header;
+			header.version = LoadLittleEndian<uint32_t>( source + 8 );
+			header.flags = LoadLittleEndian<uint32_t>( source + 12 );
+			header.sectionCount = LoadLittleEndian<uint64_t>( source + 16 );
+			header.cascadeCount = LoadLittleEndian<uint64_t>( source + 24 );
+			header.fileSize = LoadLittleEndian<uint64_t>( source + 32 );
+			header.payloadChecksum = LoadLittleEndian<uint64_t>( source + 40 );
+			for (size_t a = 0; a < FilterBankFormat::ArrayCount; a++)
+			{
+				header.offsets[a] = LoadLittleEndian<uint64_t>( source + 48 + 8 * a );
+			}
+			return header;
+		}
+	}
+
+	// Writes sections to path. cascadeSizes (empty for a flat bank) groups
+	// consecutive sections into cascades and must add up to sections.size();
+	// designs is empty or has one entry per section.
+	inline void WriteFilterBank( const std::filesystem::path& path, std::span<const Biquad<double>> sections,
+		std::span<const size_t> cascadeSizes = {}, std::span<const SectionDesign> designs = {} )
+	{
+		using namespace FilterBankFormat;
+
+		size_t total = 0;
+		for (size_t size : cascadeSizes)
+		{
+			total += size;
+		}
+		if (!cascadeSizes.empty() && total != sections.size())
+		{
+			throw std::invalid_argument( "The cascade sizes must add up to the section count." );
+		}
+		if (!designs.empty() && designs.size() != sections.size())
+		{
+			throw std::invalid_argument( "designs must be empty or have one entry per section." );
+		}
+		for (const Biquad<double>& section : sections)
+		{
+			if (section.b0 != 1)
+			{
+				throw std::invalid_argument( "Sections must be normalized (b0 = 1)." );
+			}
+		}
+
+		Header header = Detail::MakeFilterBankHeader( sections.size(), cascadeSizes.size(), !designs.empty() );
+		MappedFile file = MappedFile::Create( path, header.fileSize );
+		MappedView view = file.Map();
+		std::byte* data = view.data();
+
+		auto store = [&]( Array array, size_t count, auto value )
+		{
+			using Value = decltype(value( size_t( 0 ) ));
+			std::byte* target = data + header.offsets[array];
+			for (size_t i = 0; i < count; i++)
+			{
+				Detail::StoreLittleEndian<Value>( target + i * sizeof( Value ), value( i ) );
+			}
+		};
+
+		store( A0, sections.size(), [&]( size_t i ) { return sections[i].a0; } );
+		store( A1, sections.size(), [&]( size_t i ) { return sections[i].a1; } );
+		store( A2, sections.size(), [&]( size_t i ) { return sections[i].a2; } );
+		store( B1, sections.size(), [&]( size_t i ) { return sections[i].b1; } );
+		store( B2, sections.size(), [&]( size_t i ) { return sections[i].b2; } );
+
+		if (!cascadeSizes.empty())
+		{
+			uint64_t start = 0;
+			store( CascadeStarts, cascadeSizes.size() + 1, [&]( size_t k )
+			{
+				const uint64_t value = start;
+				start += k < cascadeSizes.size() ? cascadeSizes[k] : 0;
+				return value;
+			} );
+		}
+
+		if (!designs.empty())
+		{
+			store( Type, designs.size(), [&]( size_t i ) { return designs[i].type; } );
+			store( PeakGain, designs.size(), [&]( size_t i ) { return designs[i].peakGain; } );
+			store( Fc, designs.size(), [&]( size_t i ) { return designs[i].Fc; } );
+			store( Q, designs.size(), [&]( size_t i ) { return designs[i].Q; } );
+			store( Fs, designs.size(), [&]( size_t i ) { return designs[i].Fs; } );
+		}
+
+		header.payloadChecksum = Detail::Checksum( std::span<const std::byte>( data + HeaderSize,
+			static_cast<size_t>(header.fileSize - HeaderSize) ) );
+		Detail::StoreHeader( data, header );
+		view.Flush();
+	}
+
+	// A filter bank file opened for reading.
+	class FilterBankFile
+	{
+	public:
+
+		static FilterBankFile Open( const std::filesystem::path& path )
+		{
+			return FilterBankFile( path );
+		}
+
+		size_t size() const { return static_cast<size_t>(header.sectionCount); }
+		size_t CascadeCount() const { return static_cast<size_t>(header.cascadeCount); }
+		bool HasDesigns() const { return (header.flags & FilterBankFormat::HasDesigns) != 0; }
+		const FilterBankFormat::Header& GetHeader() const { return header; }
+
+		// Every section, as views into the file.
+		ConstBiquadSpans<double> Sections() const
+		{
+			return Sections( 0, size() );
+		}
+
+		ConstBiquadSpans<double> Sections( size_t first, size_t count ) const
+		{
+			if (first > size() || count > size() - first)
+			{
+				throw std::out_of_range( "Sections outside the bank." );
+			}
+			using namespace FilterBankFormat;
+			return { Values<double>( A0 ).subspan( first, count ), Values<double>( A1 ).subspan( first, count ),
+				Values<double>( A2 ).subspan( first, count ), Values<double>( B1 ).subspan( first, count ),
+				Values<double>( B2 ).subspan( first, count ) };
+		}
+
+		Biquad<double> operator[]( size_t index ) const
+		{
+			if (index >= size())
+			{
+				throw std::out_of_range( "Section index out of range." );
+			}
+			return Sections()[index];
+		}
+
+		// The sections of cascade k (all the sections of a flat bank for k 0).
+		ConstBiquadSpans<double> Cascade( size_t k ) const
+		{
+			if (CascadeCount() == 0 && k == 0)
+			{
+				return Sections();
+			}
+			if (k >= CascadeCount())
+			{
+				throw std::out_of_range( "Cascade index out of range." );
+			}
+			const std::span<const uint64_t> starts = Values<uint64_t>( FilterBankFormat::CascadeStarts );
+			return Sections( static_cast<size_t>(starts[k]), static_cast<size_t>(starts[k + 1] - starts[k]) );
+		}
+
+		// The sections of cascade k as Biquads, e.g. for a CascadeProcessor.
+		std::vector<Biquad<double>> CascadeSections( size_t k ) const
+		{
+			const ConstBiquadSpans<double> cascade = Cascade( k );
+			std::vector<Biquad<double>> sections( cascade.size() );
+			for (size_t i = 0; i < sections.size(); i++)
+			{
+				sections[i] = cascade[i];
+			}
+			return sections;
+		}
+
+		// Design parameters of section index (type NoDesign without them).
+		SectionDesign Design( size_t index ) const
+		{
+			if (index >= size())
+			{
+				throw std::out_of_range( "Section index out of range." );
+			}
+			if (!HasDesigns())
+			{
+				return {};
+			}
+			using namespace FilterBankFormat;
+			return { Values<int32_t>( Type )[index], Values<double>( PeakGain )[index],
+				Values<double>( Fc )[index], Values<double>( Q )[index], Values<double>( Fs )[index] };
+		}
+
+		// The design parameter arrays (empty without them).
+		std::span<const int32_t> Types() const { return Values<int32_t>( FilterBankFormat::Type ); }
+		std::span<const double> PeakGains() const { return Values<double>( FilterBankFormat::PeakGain ); }
+		std::span<const double> Fcs() const { return Values<double>( FilterBankFormat::Fc ); }
+		std::span<const double> Qs() const { return Values<double>( FilterBankFormat::Q ); }
+		std::span<const double> Fss() const { return Values<double>( FilterBankFormat::Fs ); }
+
+		// True when the payload matches its checksum (reads the whole file).
+		bool Verify() const
+		{
+			return Detail::Checksum( std::span<const std::byte>( raw + FilterBankFormat::HeaderSize,
+				static_cast<size_t>(header.fileSize - FilterBankFormat::HeaderSize) ) ) == header.payloadChecksum;
+		}
+
+	private:
+
+		explicit FilterBankFile( const std::filesystem::path& path )
+			: file( MappedFile::Open( path ) )
+		{
+			using namespace FilterBankFormat;
+
+			const std::string name = path.string();
+			if (file.Size() < HeaderSize)
+			{
+				throw std::runtime_error( "Not a filter bank file: " + name );
+			}
+			view = file.Map();
+			raw = view.data();
+
+			if (std::memcmp( raw, Magic.data(), Magic.size() ) != 0)
+			{
+				throw std::runtime_error( "Not a filter bank file: " + name );
+			}
+			if (Detail::Checksum( std::span<const std::byte>( raw, HeaderChecksumOffset ) )
+				!= Detail::LoadLittleEndian<uint64_t>( raw + HeaderChecksumOffset ))
+			{
+				throw std::runtime_error( "Corrupt filter bank header: " + name );
+			}
+
+			header = Detail::LoadHeader( raw );
+			if (header.version != Version)
+			{
+				throw std::runtime_error( "Unsupported filter bank version: " + name );
+			}
+
+			// Counts that cannot overflow the offsets, and the canonical
+			// layout for them.
+			const uint64_t limit = file.Size() / sizeof( int32_t );
+			if (header.sectionCount > limit || header.cascadeCount > limit || header.fileSize != file.Size())
+			{
+				throw std::runtime_error( "Corrupt filter bank file: " + name );
+			}
+			const Header expected = Detail::MakeFilterBankHeader( header.sectionCount, header.cascadeCount,
+				HasDesigns() );
+			if (expected.offsets != header.offsets || expected.fileSize != header.fileSize
+				|| (header.flags & ~FilterBankFormat::HasDesigns) != 0)
+			{
+				throw std::runtime_error( "Corrupt filter bank file: " + name );
+			}
+
+			if constexpr (std::endian::native != std::endian::little)
+			{
+				SwapToNative();
+			}
+
+			if (CascadeCount() > 0)
+			{
+				const std::span<const uint64_t> starts = Values<uint64_t>( CascadeStarts );
+				const bool ordered = starts.front() == 0 && starts.back() == header.sectionCount
+					&& std::is_sorted( starts.begin(), starts.end() );
+				if (!ordered)
+				{
+					throw std::runtime_error( "Corrupt filter bank cascades: " + name );
+				}
+			}
+		}
+
+		// Big endian machines: a native copy of the file instead of the
+		// mapping (the checksums stay those of the file bytes).
+		void SwapToNative()
+		{
+			using namespace FilterBankFormat;
+
+			const size_t bytes = static_cast<size_t>(header.fileSize);
+			copy.reset( static_cast<std::byte*>(::operator new[]( bytes, std::align_val_t( ArrayAlignment ) )) );
+			std::memcpy( copy.get(), raw, bytes );
+			native = copy.get();
+
+			auto swap = [&]( Array array, auto type, size_t count )
+			{
+				using Value = decltype(type);
+				std::byte* values = copy.get() + header.offsets[array];
+				for (size_t i = 0; i < count; i++)
+				{
+					Detail::StoreLittleEndian( values + i * sizeof( Value ),
+						Detail::LoadLittleEndian<Value>( values + i * sizeof( Value ) ) );
+				}
+			};
+
+			for (Array array : { A0, A1, A2, B1, B2, PeakGain, Fc, Q, Fs })
+			{
+				swap( array, double(), header.offsets[array] != 0 ? size() : 0 );
+			}
+			swap( Type, int32_t(), HasDesigns() ? size() : 0 );
+			swap( CascadeStarts, uint64_t(), CascadeCount() > 0 ? CascadeCount() + 1 : 0 );
+		}
+
+		template <typename T>
+		std::span<const T> Values( FilterBankFormat::Array array ) const
+		{
+			using namespace FilterBankFormat;
+
+			size_t count = 0;
+			if (header.offsets[array] != 0)
+			{
+				count = array == CascadeStarts ? CascadeCount() + 1 : size();
+			}
+			const std::byte* base = native != nullptr ? native : raw;
+			return std::span<const T>( reinterpret_cast<const T*>(base + header.offsets[array]), count );
+		}
+
+		struct AlignedDelete
+		{
+			void operator()( std::byte* data ) const
+			{
+				::operator delete[]( data, std::align_val_t( FilterBankFormat::ArrayAlignment ) );
+			}
+		};
+
+		MappedFile file;
+		MappedView view;
+		const std::byte* raw = nullptr;
+		std::unique_ptr<std::byte[], AlignedDelete> copy;
+		const std::byte* native = nullptr;
+		FilterBankFormat::Header header;
+	};
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "FrequencyResponse.h"
+#include "Utils.h"
+#include "Instrumentation.h"
+
+// Goertzel bank: magnitude and phase of a stream at a few frequencies.
+//
+// Each frequency w (radians per sample) runs the resonator
+//
+//     s0 = x + 2 cos(w) s1 - s2,   s2 = s1,   s1 = s0
+//
+// and after blockLength samples its DFT term is recovered as
+//
+//     X(w) = (s1 - e^-jw s2) e^-jw(N - 1) = sum_n x[n] e^-jwn
+//
+// The resonators of all the frequencies are updated together for every
+// sample (#pragma omp simd across frequencies), so the cost is O(K) per
+// sample for K frequencies. Frequencies do not need to fall on DFT bins.
+//
+// Results are reported as FrequencyResponse: magnitude is the amplitude of a
+// sine at that frequency (2 |X| / N, |X| / N at DC and Nyquist) and phase
+// the phase of a cosine at the start of the block. Input can arrive in
+// blocks of any size; all the storage is allocated at construction.
+
+namespace DigitalFilters::Eval
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	class GoertzelBank
+	{
+	public:
+
+		// frequencies in Hz, in [0, Fs / 2].
+		GoertzelBank( std::span<const T> frequencies, T Fs, size_t blockLength )
+			: blockLength( blockLength ), coefficient( frequencies.size() ), cosine( frequencies.size() ),
+			sine( frequencies.size() ), rotationCos( frequencies.size() ), rotationSin( frequencies.size() ),
+			scale( frequencies.size() ), s1( frequencies.size(), T( 0 ) ), s2( frequencies.size(), T( 0 ) ),
+			results( frequencies.size() )
+		{
+			if (blockLength == 0)
+			{
+				throw std::invalid_argument( "blockLength must be at least 1." );
+			}
+
+			for (size_t k = 0; k < frequencies.size(); k++)
+			{
+				if (!(frequencies[k] >= 0 && frequencies[k] <= Fs / 2))
+				{
+					throw std::invalid_argument( "Frequencies must be in [0, Fs / 2]." );
+				}
+
+				const T omega = Utils::HzToOmega( frequencies[k] ) / Fs;
+				cosine[k] = std::cos( omega );
+				sine[k] = std::sin( omega );
+				coefficient[k] = 2 * cosine[k];
+				rotationCos[k] = std::cos( omega * (blockLength - 1) );
+				rotationSin[k] = -std::sin( omega * (blockLength - 1) );
+
+				const bool edge = frequencies[k] == 0 || frequencies[k] == Fs / 2;
+				scale[k] = (edge ? T( 1 ) : T( 2 )) / blockLength;
+			}
+		}
+
+		GoertzelBank( const std::vector<T>& frequencies, T Fs, size_t blockLength )
+			: GoertzelBank( std::span<const T>( frequencies ), Fs, blockLength )
+		{
+		}
+
+		size_t Frequencies() const { return results.size(); }
+		size_t BlockLength() const { return blockLength; }
+
+		// Samples of the current (incomplete) block.
+		size_t Position() const { return position; }
+
+		// Results of the last completed block, one per frequency.
+		std::span<const FrequencyResponse<T>> Results() const
+		{
+			return results;
+		}
+
+		// Drops the current partial block.
+		void Reset()
+		{
+			std::fill( s1.begin(), s1.end(), T( 0 ) );
+			std::fill( s2.begin(), s2.end(), T( 0 ) );
+			position = 0;
+		}
+
+		// Feeds samples; onBlock( Results() ) is called for every block
+		// completed. Returns the number of blocks completed.
+		template <typename OnBlock>
+		size_t Process( std::span<const T> input, OnBlock&& onBlock )
+		{
+			DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::GoertzelProcess, input.size(), 0 );
+
+			size_t blocks = 0;
+
+			while (!input.empty())
+			{
+				const size_t run = std::min( input.size(), blockLength - position );
+				Accumulate( input.first( run ) );
+				input = input.subspan( run );
+				position += run;
+
+				if (position == blockLength)
+				{
+					Finish();
+					onBlock( Results() );
+					blocks++;
+				}
+			}
+
+			return blocks;
+		}
+
+		size_t Process( std::span<const T> input )
+		{
+			return Process( input, []( std::span<const FrequencyResponse<T>> ) {} );
+		}
+
+	private:
+
+		void Accumulate( std::span<const T> input )
+		{
+			const size_t count = results.size();
+			const T* c = coefficient.data();
+			T* state1 = s1.data();
+			T* state2 = s2.data();
+
+			for (T x : input)
+			{
+				#pragma omp simd
+				for (size_t k = 0; k < count; k++)
+				{
+					const T s0 = x + c[k] * state1[k] - state2[k];
+					state2[k] = state1[k];
+					state1[k] = s0;
+				}
+			}
+		}
+
+		void Finish()
+		{
+			for (size_t k = 0; k < results.size(); k++)
+			{
+				const T re = s1[k] - cosine[k] * s2[k];
+				const T im = sine[k] * s2[k];
+				const T rotatedRe = re * rotationCos[k] - im * rotationSin[k];
+				const T rotatedIm = re * rotationSin[k] + im * rotationCos[k];
+
+				results[k].magnitude = std::hypot( rotatedRe, rotatedIm ) * scale[k];
+				results[k].phase = std::atan2( rotatedIm, rotatedRe );
+			}
+
+			Reset();
+		}
+
+		size_t blockLength;
+		size_t position = 0;
+
+		// Per frequency constants.
+		std::vector<T> coefficient, cosine, sine;
+		std::vector<T> rotationCos, rotationSin;
+		std::vector<T> scale;
+
+		// Resonator state.
+		std::vector<T> s1, s2;
+
+		std::vector<FrequencyResponse<T>> results;
+	};
+}
@@ -0,0 +1,542 @@
+#pragma once
+
+#include <type_traits>
+#include <span>
+#include <cstdint>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include "Constants.h"
+#include "Utils.h"
+
+// Batch (structure-of-arrays) versions of the IIR:: designers.
+//
+// Each function designs N filters from parallel parameter spans and writes
+// the normalized coefficients (b0 = 1 implicit) into parallel output spans.
+// The loops are branch free: boost/cut selection is done with selects and
+// tan/pow are replaced by SIMD friendly kernels, so the compiler can
+// vectorize them (#pragma omp simd).
+//
+// Results match the scalar designers in IIRDesignImpl.h within a few ULP.
+//
+// The kernels are force inlined: a loop calling one of them out of line
+// (the inliner gives up in large translation units) does not vectorize.
+
+#if defined(_MSC_VER)
+#define DIGITALFILTERS_BATCH_INLINE __forceinline
+#else
+#define DIGITALFILTERS_BATCH_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace DigitalFilters::IIR
+{
+	// Output view of N biquads stored as structure of arrays.
+	template <typename T> requires std::is_floating_point_v<T>
+	struct BiquadSpans
+	{
+		std::span<T> a0, a1, a2;
+		std::span<T> b1, b2;
+
+		size_t size() const { return a0.size(); }
+	};
+}
+
+namespace DigitalFilters::Utils
+{
+	namespace Detail
+	{
+		// tan(x) kernel (Cephes rational approximation), ~1 ULP over
+		// |x| < 2^30, written without branches so it vectorizes.
+		DIGITALFILTERS_BATCH_INLINE double SimdTan( double x )
+		{
+			constexpr double DP1 = 7.853981554508209228515625E-1;
+			constexpr double DP2 = 7.94662735614792836714E-9;
+			constexpr double DP3 = 3.06161699786838294307E-17;
+
+			constexpr double P0 = -1.30936939181383777646E4;
+			constexpr double P1 = 1.15351664838587416140E6;
+			constexpr double P2 = -1.79565251976484877988E7;
+
+			constexpr double Q0 = 1.36812963470692954678E4;
+			constexpr double Q1 = -1.32089234440210967447E6;
+			constexpr double Q2 = 2.50083801823357915839E7;
+			constexpr double Q3 = -5.38695755929454629881E7;
+
+			const double ax = std::abs( x );
+
+			// Octant, rounded up to even so z lies in [-pi/4, pi/4]. Integer
+			// (not floor) arithmetic keeps the loop vectorizable under
+			// strict floating point models.
+			int octant = static_cast<int>(ax * (4.0 / Constants::pi<double>()));
+			octant += octant & 1;
+			const double j = static_cast<double>(octant);
+
+			const double z = ((ax - j * DP1) - j * DP2) - j * DP3;
+			const double zz = z * z;
+
+			const double p = (P0 * zz + P1) * zz + P2;
+			const double q = (((zz + Q0) * zz + Q1) * zz + Q2) * zz + Q3;
+
+			// tan(z) = num / den. Odd quadrant: tan(x) = -1 / tan(z), done by
+			// swapping num and den so the only division is unconditional.
+			const double num = z * (q + zz * p);
+			const double den = q;
+			const bool oddQuadrant = (octant & 2) != 0;
+			const double result = (oddQuadrant ? -den : num) / (oddQuadrant ? num : den);
+
+			return std::copysign( result, x );
+		}
+
+		// exp(x) kernel (Cephes rational approximation), ~1 ULP for
+		// |x| < 700, written without branches so it vectorizes.
+		DIGITALFILTERS_BATCH_INLINE double SimdExp( double x )
+		{
+			constexpr double C1 = 6.93145751953125E-1;
+			constexpr double C2 = 1.42860682030941723212E-6;
+
+			constexpr double P0 = 1.26177193074810590878E-4;
+			constexpr double P1 = 3.02994407707441961300E-2;
+			constexpr double P2 = 9.99999999999999999910E-1;
+
+			constexpr double Q0 = 3.00198505138664455042E-6;
+			constexpr double Q1 = 2.52448340349684104192E-3;
+			constexpr double Q2 = 2.27265548208155028766E-1;
+			constexpr double Q3 = 2.00000000000000000009E0;
+
+			// n = round(x / ln2), through int for the same reason as SimdTan.
+			const double nReal = x * Constants::log2e<double>();
+			const double n = static_cast<double>(
+				static_cast<int>(nReal + (nReal < 0 ? -0.5 : 0.5)) );
+			const double r = (x - n * C1) - n * C2;
+			const double rr = r * r;
+
+			const double px = r * ((P0 * rr + P1) * rr + P2);
+			const double qx = ((Q0 * rr + Q1) * rr + Q2) * rr + Q3;
+			const double e = 1.0 + 2.0 * px / (qx - px);
+
+			// 2^n built directly in the exponent field. Adding 2^52 leaves
+			// (n + 1023) in the low mantissa bits.
+			const double biased = n + (1023.0 + 4503599627370496.0);
+			const double scale = std::bit_cast<double>(
+				std::bit_cast<std::uint64_t>(biased) << 52 );
+
+			return e * scale;
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		DIGITALFILTERS_BATCH_INLINE T BatchTan( T x )
+		{
+			if constexpr (sizeof( T ) > sizeof( double ))
+			{
+				return std::tan( x );
+			}
+			else
+			{
+				return static_cast<T>(SimdTan( static_cast<double>(x) ));
+			}
+		}
+
+		// 10^(|dB| / divisor), the scalar DecibelToLinearGain for divisor 20.
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		DIGITALFILTERS_BATCH_INLINE T BatchDecibelToLinear( T dB, T divisor )
+		{
+			if constexpr (sizeof( T ) > sizeof( double ))
+			{
+				return std::pow( static_cast<T>(10), std::abs( dB ) / divisor );
+			}
+			else
+			{
+				const double magnitude = std::abs( static_cast<double>(dB) );
+				return static_cast<T>(SimdExp(
+					magnitude * Constants::ln10<double>() / static_cast<double>(divisor) ));
+			}
+		}
+
+		template <typename T>
+		void CheckBatchSizes( size_t count, std::span<T> values )
+		{
+			if (values.size() != count)
+			{
+				throw std::invalid_argument(
+					"All batch spans must have the same number of elements." );
+			}
+		}
+
+		template <typename T, typename... Spans>
+		void CheckBatchSizes( size_t count, std::span<T> values, Spans... rest )
+		{
+			CheckBatchSizes( count, values );
+			CheckBatchSizes( count, rest... );
+		}
+	}
+
+	// Vectorized PrewarpFrequency over parallel spans.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	void PrewarpFrequencyBatch(
+		std::span<const T> cutoffFrequencyHz,
+		std::span<const T> samplingFrequencyHz,
+		std::span<T> omega )
+	{
+		const size_t count = omega.size();
+		Detail::CheckBatchSizes( count, cutoffFrequencyHz, samplingFrequencyHz );
+
+		const T* fc = cutoffFrequencyHz.data();
+		const T* fs = samplingFrequencyHz.data();
+		T* out = omega.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+		}
+	}
+
+	// Vectorized DecibelToLinearGain over a span.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	void DecibelToLinearGainBatch( std::span<const T> dB, std::span<T> gain )
+	{
+		const size_t count = gain.size();
+		Detail::CheckBatchSizes( count, dB );
+
+		const T* in = dB.data();
+		T* out = gain.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = Detail::BatchDecibelToLinear( in[i], static_cast<T>(20) );
+		}
+	}
+}
+
+namespace DigitalFilters::IIR
+{
+	namespace Detail
+	{
+		// Writes one section from the "gain" (G) and "unity" (U) polynomials
+		// of a boost/cut design: boost uses G as numerator and U as
+		// denominator, cut swaps them.
+		template <typename T>
+		DIGITALFILTERS_BATCH_INLINE void StoreBoostCut( bool boost,
+			T g0, T g1, T g2, T u0, T u1, T u2,
+			T& a0, T& a1, T& a2, T& b1, T& b2 )
+		{
+			const T n0 = boost ? g0 : u0;
+			const T n1 = boost ? g1 : u1;
+			const T n2 = boost ? g2 : u2;
+			const T d0 = boost ? u0 : g0;
+			const T d1 = boost ? u1 : g1;
+			const T d2 = boost ? u2 : g2;
+
+			const T norm = 1 / d0;
+			a0 = n0 * norm;
+			a1 = n1 * norm;
+			a2 = n2 * norm;
+			b1 = d1 * norm;
+			b2 = d2 * norm;
+		}
+	}
+
+	// Batch IIR::PeakEq.
+	template <typename T> requires std::is_floating_point_v<T>
+	void PeakEqBatch(
+		std::span<const T> peakGain, std::span<const T> Fc,
+		std::span<const T> Q, std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, peakGain, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* pg = peakGain.data();
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T gain = Utils::Detail::BatchDecibelToLinear( pg[i], static_cast<T>(20) );
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+
+			const T g0 = 1 + gain * invQ * omega + omega2;
+			const T g2 = 1 - gain * invQ * omega + omega2;
+			const T u0 = 1 + invQ * omega + omega2;
+			const T u2 = 1 - invQ * omega + omega2;
+			const T m1 = 2 * (omega2 - 1);
+
+			Detail::StoreBoostCut( pg[i] >= 0, g0, m1, g2, u0, m1, u2,
+				a0[i], a1[i], a2[i], b1[i], b2[i] );
+		}
+	}
+
+	// Batch IIR::HighShelfQ.
+	template <typename T> requires std::is_floating_point_v<T>
+	void HighShelfQBatch(
+		std::span<const T> peakGain, std::span<const T> Fc,
+		std::span<const T> Q, std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, peakGain, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* pg = peakGain.data();
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T gain = Utils::Detail::BatchDecibelToLinear( pg[i], static_cast<T>(20) );
+			// sqrt(2 * gain) = sqrt2 * 10^(|dB| / 40)
+			const T sqrt2Gain = Constants::sqrt2<T>()
+				* Utils::Detail::BatchDecibelToLinear( pg[i], static_cast<T>(40) );
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+
+			const T g0 = gain + sqrt2Gain * omega + omega2;
+			const T g1 = 2 * (omega2 - gain);
+			const T g2 = gain - sqrt2Gain * omega + omega2;
+			const T u0 = 1 + invQ * omega + omega2;
+			const T u1 = 2 * (omega2 - 1);
+			const T u2 = 1 - invQ * omega + omega2;
+
+			Detail::StoreBoostCut( pg[i] >= 0, g0, g1, g2, u0, u1, u2,
+				a0[i], a1[i], a2[i], b1[i], b2[i] );
+		}
+	}
+
+	// Batch IIR::LowShelfQ.
+	template <typename T> requires std::is_floating_point_v<T>
+	void LowShelfQBatch(
+		std::span<const T> peakGain, std::span<const T> Fc,
+		std::span<const T> Q, std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, peakGain, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* pg = peakGain.data();
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T gain = Utils::Detail::BatchDecibelToLinear( pg[i], static_cast<T>(20) );
+			// sqrt(gain) = 10^(|dB| / 40)
+			const T sqrtGain = Utils::Detail::BatchDecibelToLinear( pg[i], static_cast<T>(40) );
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+
+			const T g0 = 1 + sqrtGain * invQ * omega + gain * omega2;
+			const T g1 = 2 * (gain * omega2 - 1);
+			const T g2 = 1 - sqrtGain * invQ * omega + gain * omega2;
+			const T u0 = 1 + invQ * omega + omega2;
+			const T u1 = 2 * (omega2 - 1);
+			const T u2 = 1 - invQ * omega + omega2;
+
+			Detail::StoreBoostCut( pg[i] >= 0, g0, g1, g2, u0, u1, u2,
+				a0[i], a1[i], a2[i], b1[i], b2[i] );
+		}
+	}
+
+	// Batch IIR::LowPass.
+	template <typename T> requires std::is_floating_point_v<T>
+	void LowPassBatch(
+		std::span<const T> Fc, std::span<const T> Q,
+		std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+			const T norm = 1 / (1 + invQ * omega + omega2);
+
+			a0[i] = omega2 * norm;
+			a1[i] = 2 * a0[i];
+			a2[i] = a0[i];
+			b1[i] = 2 * (omega2 - 1) * norm;
+			b2[i] = (1 - invQ * omega + omega2) * norm;
+		}
+	}
+
+	// Batch IIR::HighPass.
+	template <typename T> requires std::is_floating_point_v<T>
+	void HighPassBatch(
+		std::span<const T> Fc, std::span<const T> Q,
+		std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+			const T norm = 1 / (1 + invQ * omega + omega2);
+
+			a0[i] = norm;
+			a1[i] = -2 * norm;
+			a2[i] = norm;
+			b1[i] = 2 * (omega2 - 1) * norm;
+			b2[i] = (1 - invQ * omega + omega2) * norm;
+		}
+	}
+
+	// Batch IIR::BandPass.
+	template <typename T> requires std::is_floating_point_v<T>
+	void BandPassBatch(
+		std::span<const T> Fc, std::span<const T> Q,
+		std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+			const T norm = 1 / (1 + invQ * omega + omega2);
+
+			a0[i] = invQ * omega * norm;
+			a1[i] = 0;
+			a2[i] = -a0[i];
+			b1[i] = 2 * (omega2 - 1) * norm;
+			b2[i] = (1 - invQ * omega + omega2) * norm;
+		}
+	}
+
+	// Batch IIR::Notch.
+	template <typename T> requires std::is_floating_point_v<T>
+	void NotchBatch(
+		std::span<const T> Fc, std::span<const T> Q,
+		std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+			const T norm = 1 / (1 + invQ * omega + omega2);
+
+			a0[i] = (1 + omega2) * norm;
+			a1[i] = 2 * (omega2 - 1) * norm;
+			a2[i] = a0[i];
+			b1[i] = a1[i];
+			b2[i] = (1 - invQ * omega + omega2) * norm;
+		}
+	}
+
+	// Batch IIR::AllPassQ.
+	template <typename T> requires std::is_floating_point_v<T>
+	void AllPassQBatch(
+		std::span<const T> Fc, std::span<const T> Q,
+		std::span<const T> Fs, BiquadSpans<T> out )
+	{
+		const size_t count = out.size();
+		Utils::Detail::CheckBatchSizes( count, Fc, Q, Fs,
+			out.a1, out.a2, out.b1, out.b2 );
+
+		const T* fc = Fc.data();
+		const T* q = Q.data();
+		const T* fs = Fs.data();
+		T* a0 = out.a0.data();
+		T* a1 = out.a1.data();
+		T* a2 = out.a2.data();
+		T* b1 = out.b1.data();
+		T* b2 = out.b2.data();
+
+		#pragma omp simd
+		for (size_t i = 0; i < count; ++i)
+		{
+			const T omega = Utils::Detail::BatchTan( Constants::pi<T>() * fc[i] / fs[i] );
+			const T omega2 = omega * omega;
+			const T invQ = 1 / q[i];
+			const T norm = 1 / (1 + invQ * omega + omega2);
+
+			a0[i] = (1 - invQ * omega + omega2) * norm;
+			a1[i] = 2 * (omega2 - 1) * norm;
+			a2[i] = 1;
+			b1[i] = a1[i];
+			b2[i] = a0[i];
+		}
+	}
+}
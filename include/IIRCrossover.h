@@ -0,0 +1,208 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <stdexcept>
+#include "Biquad.h"
+#include "IIRDesign.h"
+#include "Constants.h"
+#include "Instrumentation.h"
+
+// Linkwitz-Riley (4th order) crossover network.
+//
+// Every crossover at frequency f splits a signal into LowPass12dbOct(f)^2 and
+// HighPass12dbOct(f)^2; the two outputs sum to AllPassQ(f, 1 / sqrt(2)).
+// The bands are split as a binary tree: the middle crossover of a band range
+// splits first and each side continues with its own half. Before going on,
+// each side is compensated with the allpasses of the crossovers of the other
+// side, so all the bands sum to the product of the allpasses of all the
+// crossovers (flat magnitude). Branches share the filtering of their common
+// ancestors and the compensation of a whole side is done once.
+//
+// The tree is flattened at construction into a list of branches (source
+// value, sections, target value) in evaluation order. Process runs the list
+// once per input sample and writes all the bands, so the input is read once
+// and no memory is allocated.
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	class LinkwitzRileyCrossover
+	{
+	public:
+
+		// frequencies: crossover frequencies in Hz, strictly increasing;
+		// N frequencies give N + 1 bands.
+		LinkwitzRileyCrossover( std::span<const T> frequencies, T Fs )
+			: frequencies( frequencies.begin(), frequencies.end() ), Fs( Fs )
+		{
+			if (frequencies.empty())
+			{
+				throw std::invalid_argument( "At least one crossover frequency is required." );
+			}
+
+			for (size_t i = 0; i < frequencies.size(); i++)
+			{
+				if (!(frequencies[i] > 0 && frequencies[i] < Fs / 2))
+				{
+					throw std::invalid_argument( "Crossover frequencies must be in (0, Fs / 2)." );
+				}
+				if (i > 0 && !(frequencies[i] > frequencies[i - 1]))
+				{
+					throw std::invalid_argument( "Crossover frequencies must be strictly increasing." );
+				}
+			}
+
+			bandValue.resize( Bands() );
+			values.push_back( 0 );
+			Split( 0, Bands(), 0 );
+			state.assign( 2 * sections.size(), T( 0 ) );
+		}
+
+		LinkwitzRileyCrossover( const std::vector<T>& frequencies, T Fs )
+			: LinkwitzRileyCrossover( std::span<const T>( frequencies ), Fs )
+		{
+		}
+
+		size_t Bands() const { return frequencies.size() + 1; }
+
+		std::span<const T> Frequencies() const { return frequencies; }
+
+		// Total biquad sections run per sample.
+		size_t Sections() const { return sections.size(); }
+
+		void Reset()
+		{
+			std::fill( state.begin(), state.end(), T( 0 ) );
+		}
+
+		// Band b of input[i] goes to outputs[b][i], lowest band first. Every
+		// output must have input.size() samples; input may be one of the
+		// outputs.
+		void Process( std::span<const T> input, std::span<const std::span<T>> outputs )
+		{
+			if (outputs.size() != Bands())
+			{
+				throw std::invalid_argument( "One output per band is required." );
+			}
+			for (const std::span<T>& output : outputs)
+			{
+				if (output.size() != input.size())
+				{
+					throw std::invalid_argument( "Every output must have the size of the input." );
+				}
+			}
+
+			DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::CrossoverProcess, input.size(), 0 );
+
+			T* value = values.data();
+
+			for (size_t i = 0; i < input.size(); i++)
+			{
+				value[0] = input[i];
+
+				for (const Branch& branch : branches)
+				{
+					T x = value[branch.source];
+					T* s = state.data() + 2 * branch.first;
+					const Biquad<T>* section = sections.data() + branch.first;
+
+					for (size_t k = 0; k < branch.count; k++, s += 2)
+					{
+						const T y = section[k].a0 * x + s[0];
+						s[0] = section[k].a1 * x - section[k].b1 * y + s[1];
+						s[1] = section[k].a2 * x - section[k].b2 * y;
+						x = y;
+					}
+
+					value[branch.target] = x;
+				}
+
+				for (size_t b = 0; b < bandValue.size(); b++)
+				{
+					outputs[b][i] = value[bandValue[b]];
+				}
+			}
+		}
+
+	private:
+
+		// sections[first, first + count) applied to values[source], result in
+		// values[target].
+		struct Branch
+		{
+			size_t source;
+			size_t target;
+			size_t first;
+			size_t count;
+		};
+
+		// Splits bands [low, high) whose signal is values[source].
+		void Split( size_t low, size_t high, size_t source )
+		{
+			if (high - low == 1)
+			{
+				bandValue[low] = source;
+				return;
+			}
+
+			const size_t middle = (low + high) / 2;
+			const T Fc = frequencies[middle - 1];
+
+			// Low side: LR low pass, compensated with the high side crossovers.
+			const size_t lowValue = AddBranch( source, [&]
+			{
+				sections.push_back( LowPass12dbOct( Fc, Fs ) );
+				sections.push_back( LowPass12dbOct( Fc, Fs ) );
+				AddAllPasses( middle, high - 1 );
+			} );
+
+			// High side: LR high pass, compensated with the low side crossovers.
+			const size_t highValue = AddBranch( source, [&]
+			{
+				sections.push_back( HighPass12dbOct( Fc, Fs ) );
+				sections.push_back( HighPass12dbOct( Fc, Fs ) );
+				AddAllPasses( low, middle - 1 );
+			} );
+
+			Split( low, middle, lowValue );
+			Split( middle, high, highValue );
+		}
+
+		template <typename AddSections>
+		size_t AddBranch( size_t source, AddSections addSections )
+		{
+			const size_t first = sections.size();
+			addSections();
+
+			values.push_back( 0 );
+			branches.push_back( { source, values.size() - 1, first, sections.size() - first } );
+			return values.size() - 1;
+		}
+
+		// Allpasses of crossovers [first, last).
+		void AddAllPasses( size_t first, size_t last )
+		{
+			for (size_t j = first; j < last; j++)
+			{
+				sections.push_back( AllPassQ( frequencies[j], Constants::one_over_sqrt2<T>(), Fs ) );
+			}
+		}
+
+		std::vector<T> frequencies;
+		T Fs;
+
+		std::vector<Biquad<T>> sections;
+		std::vector<Branch> branches;
+
+		// s1, s2 per section.
+		std::vector<T> state;
+
+		// Signals of the current sample: values[0] is the input, then one per
+		// branch. bandValue[b] indexes the signal of band b.
+		std::vector<T> values;
+		std::vector<size_t> bandValue;
+	};
+}
@@ -11,81 +11,117 @@ namespace DigitalFilters::IIR
 	//   - Q: Quality factor of the filter.
 	//   - Fs: Sampling frequency in Hz.
 
+	// Identifies one of the single section designers below, e.g. to key
+	// cached or stored designs.
+	enum class FilterType : int
+	{
+		AllPass1stOrder,
+		AllPassQ,
+		BandPass,
+		HighPass,
+		HighPass12dbOct,
+		HighPass1stOrder,
+		HighShelf,
+		HighShelf1stOrder,
+		HighShelfQ,
+		LowPass,
+		LowPass12dbOct,
+		LowPass1stOrder,
+		LowShelf,
+		LowShelf1stOrder,
+		LowShelfQ,
+		Notch,
+		OnePoleHighPass,
+		OnePoleLowPass,
+		PeakEq
+	};
+
 	// calculate coefficients for a 1stOrder AllPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> AllPass1stOrder	( T Fc, T Fs );
+	constexpr Biquad<T> AllPass1stOrder	( T Fc, T Fs );
 
 	// calculate coefficients for a AllPass filter with Q factor.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>AllPassQ( T Fc, T Q, T Fs );
+	constexpr Biquad<T> AllPassQ( T Fc, T Q, T Fs );
 
 	// calculate coefficients for a BandPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>BandPass( T Fc, T Q, T Fs );
+	constexpr Biquad<T> BandPass( T Fc, T Q, T Fs );
 
 	// calculate coefficients for a HighPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>HighPass( T Fc, T Q, T Fs );
+	constexpr Biquad<T> HighPass( T Fc, T Q, T Fs );
 
 	// calculate coefficients for a HighPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>HighPass12dbOct( T Fc, T Fs );
+	constexpr Biquad<T> HighPass12dbOct( T Fc, T Fs );
 
 	// calculate coefficients for a 1stOrder HighPass1stOrder filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>HighPass1stOrder( T Fc, T Fs );
+	constexpr Biquad<T> HighPass1stOrder( T Fc, T Fs );
 
 	// calculate coefficients for a HighPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>HighShelf( T peakGain, T Fc, T Fs );
+	constexpr Biquad<T> HighShelf( T peakGain, T Fc, T Fs );
 
 	// calculate coefficients for a 1stOrder HighShelf filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>HighShelf1stOrder( T peakGain, T Fc, T Fs );
+	constexpr Biquad<T> HighShelf1stOrder( T peakGain, T Fc, T Fs );
 
 	// calculate coefficients for a HighPass filter with Q factor.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>HighShelfQ( T peakGain, T Fc, T Q, T Fs );
+	constexpr Biquad<T> HighShelfQ( T peakGain, T Fc, T Q, T Fs );
 
 	// calculate coefficients for a LowPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>LowPass( T Fc, T Q, T Fs );
+	constexpr Biquad<T> LowPass( T Fc, T Q, T Fs );
 
 	// calculate coefficients for a LowPass with 12dbOct Butterworth decay filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>LowPass12dbOct( T Fc, T Fs );
+	constexpr Biquad<T> LowPass12dbOct( T Fc, T Fs );
 
 	// calculate coefficients for a 1stOrder LowPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>LowPass1stOrder( T Fc, T Fs );
+	constexpr Biquad<T> LowPass1stOrder( T Fc, T Fs );
 
 	// calculate coefficients for a LowShelf filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>LowShelf( T peakGain, T Fc, T Fs );
+	constexpr Biquad<T> LowShelf( T peakGain, T Fc, T Fs );
 
 	// calculate coefficients for a 1stOrder LowShelffilter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>LowShelf1stOrder( T peakGain, T Fc, T Fs );
+	constexpr Biquad<T> LowShelf1stOrder( T peakGain, T Fc, T Fs );
 
 	// calculate coefficients for a LowShelf filter with Q factor.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>LowShelfQ( T peakGain, T Fc, T Q, T Fs );
+	constexpr Biquad<T> LowShelfQ( T peakGain, T Fc, T Q, T Fs );
 
 	// calculate coefficients for a Notch filter with Q factor.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>Notch( T Fc, T Q, T Fs );
+	constexpr Biquad<T> Notch( T Fc, T Q, T Fs );
 
 	// calculate coefficients for a OnePoleHighPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>OnePoleHighPass( T Fc, T Fs );
+	constexpr Biquad<T> OnePoleHighPass( T Fc, T Fs );
 
 	// calculate coefficients for a OnePoleLowPass filter.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>OnePoleLowPass( T Fc, T Fs );
+	constexpr Biquad<T> OnePoleLowPass( T Fc, T Fs );
 
 	// calculate coefficients for a Peaking EQ filter with Q factor.
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T>PeakEq( T peakGain, T Fc, T Q, T Fs );
+	constexpr Biquad<T> PeakEq( T peakGain, T Fc, T Q, T Fs );
+
+	// calculate coefficients for the designer selected by type.
+	// Parameters the designer does not take are ignored.
+	template <typename T> requires std::is_floating_point_v<T>
+	constexpr Biquad<T> Design( FilterType type, T peakGain, T Fc, T Q, T Fs );
+
+	// true when the designer selected by type takes a peakGain parameter.
+	constexpr bool UsesGain( FilterType type );
+
+	// true when the designer selected by type takes a Q parameter.
+	constexpr bool UsesQ( FilterType type );
 
 	// calculate the  q factors for ButterworthResponce filter
 	template <typename T> requires std::is_floating_point_v<T>
@@ -102,6 +138,6 @@ namespace DigitalFilters::IIR
 	std::vector< Biquad<T> > HighPassCascadeAsButterworth( int order, T Fc, T Fs );
 }
 
-#include "IIRDesignimpl.h"
+#include "IIRDesignImpl.h"
 
 
@@ -0,0 +1,514 @@
+#pragma once
+
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <cstdint>
+#include <cmath>
+#include <bit>
+#include "Biquad.h"
+#include "IIRDesign.h"
+
+// Optional memoization in front of the IIR:: designers.
+//
+// DesignCache<T> is a bounded, thread-safe cache keyed by filter type and
+// the bit pattern of the parameters (after optional quantization). Lookups
+// are lock-free: each slot is protected by a sequence counter (seqlock),
+// so readers never block and retry only if a writer replaced the slot
+// under them. Misses design outside any lock and insert under a mutex.
+//
+// Storage is 4-way set associative. Eviction is LRU within a set, using
+// an access stamp that readers refresh with a relaxed store.
+//
+// Call sites opt in by replacing IIR::PeakEq( ... ) with
+// cache.PeakEq( ... ), or IIR::Cached::PeakEq( ... ) for a process wide
+// cache per T.
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	struct DesignCacheOptions
+	{
+		// Maximum number of cached designs. Storage is 4 ways times a power
+		// of two set count, so this is rounded up to 4 * 2^k (6000 gives 8192).
+		size_t capacity = 4096;
+
+		// Parameters are rounded to the nearest multiple of these steps
+		// before lookup and design. 0 keeps them bit exact. A positive Fc or
+		// Q below half a step rounds up to one step, not to 0.
+		T gainStep = 0;       // dB
+		T frequencyStep = 0;  // Hz, applied to Fc
+		T qStep = 0;
+	};
+
+	struct DesignCacheStats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class DesignCache
+	{
+	public:
+
+		explicit DesignCache( DesignCacheOptions<T> options = {} )
+			: options( options )
+		{
+			size_t sets = 1;
+			while (sets * Ways < options.capacity)
+			{
+				sets <<= 1;
+			}
+
+			setMask = sets - 1;
+			slots = std::make_unique<Slot[]>( sets * Ways );
+		}
+
+		DesignCache( const DesignCache& ) = delete;
+		DesignCache& operator=( const DesignCache& ) = delete;
+
+		// Returns the cached design; on a miss designs and caches it.
+		Biquad<T> Design( FilterType type, T peakGain, T Fc, T Q, T Fs )
+		{
+			const Key key = MakeKey( type, peakGain, Fc, Q, Fs );
+			const uint64_t hash = Hash( key );
+
+			if (auto cached = Find( key, hash ))
+			{
+				hits.fetch_add( 1, std::memory_order_relaxed );
+				return *cached;
+			}
+
+			misses.fetch_add( 1, std::memory_order_relaxed );
+
+			Biquad<T> designed =
+				IIR::Design( type, key.peakGain, key.Fc, key.Q, key.Fs );
+
+			Insert( key, hash, designed );
+			return designed;
+		}
+
+		Biquad<T> AllPass1stOrder( T Fc, T Fs )
+		{ return Design( FilterType::AllPass1stOrder, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> AllPassQ( T Fc, T Q, T Fs )
+		{ return Design( FilterType::AllPassQ, T( 0 ), Fc, Q, Fs ); }
+
+		Biquad<T> BandPass( T Fc, T Q, T Fs )
+		{ return Design( FilterType::BandPass, T( 0 ), Fc, Q, Fs ); }
+
+		Biquad<T> HighPass( T Fc, T Q, T Fs )
+		{ return Design( FilterType::HighPass, T( 0 ), Fc, Q, Fs ); }
+
+		Biquad<T> HighPass12dbOct( T Fc, T Fs )
+		{ return Design( FilterType::HighPass12dbOct, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> HighPass1stOrder( T Fc, T Fs )
+		{ return Design( FilterType::HighPass1stOrder, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> HighShelf( T peakGain, T Fc, T Fs )
+		{ return Design( FilterType::HighShelf, peakGain, Fc, T( 0 ), Fs ); }
+
+		Biquad<T> HighShelf1stOrder( T peakGain, T Fc, T Fs )
+		{ return Design( FilterType::HighShelf1stOrder, peakGain, Fc, T( 0 ), Fs ); }
+
+		Biquad<T> HighShelfQ( T peakGain, T Fc, T Q, T Fs )
+		{ return Design( FilterType::HighShelfQ, peakGain, Fc, Q, Fs ); }
+
+		Biquad<T> LowPass( T Fc, T Q, T Fs )
+		{ return Design( FilterType::LowPass, T( 0 ), Fc, Q, Fs ); }
+
+		Biquad<T> LowPass12dbOct( T Fc, T Fs )
+		{ return Design( FilterType::LowPass12dbOct, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> LowPass1stOrder( T Fc, T Fs )
+		{ return Design( FilterType::LowPass1stOrder, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> LowShelf( T peakGain, T Fc, T Fs )
+		{ return Design( FilterType::LowShelf, peakGain, Fc, T( 0 ), Fs ); }
+
+		Biquad<T> LowShelf1stOrder( T peakGain, T Fc, T Fs )
+		{ return Design( FilterType::LowShelf1stOrder, peakGain, Fc, T( 0 ), Fs ); }
+
+		Biquad<T> LowShelfQ( T peakGain, T Fc, T Q, T Fs )
+		{ return Design( FilterType::LowShelfQ, peakGain, Fc, Q, Fs ); }
+
+		Biquad<T> Notch( T Fc, T Q, T Fs )
+		{ return Design( FilterType::Notch, T( 0 ), Fc, Q, Fs ); }
+
+		Biquad<T> OnePoleHighPass( T Fc, T Fs )
+		{ return Design( FilterType::OnePoleHighPass, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> OnePoleLowPass( T Fc, T Fs )
+		{ return Design( FilterType::OnePoleLowPass, T( 0 ), Fc, T( 0 ), Fs ); }
+
+		Biquad<T> PeakEq( T peakGain, T Fc, T Q, T Fs )
+		{ return Design( FilterType::PeakEq, peakGain, Fc, Q, Fs ); }
+
+		DesignCacheStats Stats() const
+		{
+			DesignCacheStats stats;
+			stats.hits = hits.load( std::memory_order_relaxed );
+			stats.misses = misses.load( std::memory_order_relaxed );
+			stats.evictions = evictions.load( std::memory_order_relaxed );
+			return stats;
+		}
+
+		size_t Capacity() const
+		{
+			return (setMask + 1) * Ways;
+		}
+
+		// Drops every entry. Counters are kept.
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock( writeMutex );
+
+			for (size_t idx = 0; idx < Capacity(); idx++)
+			{
+				Slot& slot = slots[idx];
+				BeginWrite( slot );
+				slot.type.store( EmptySlot, std::memory_order_relaxed );
+				EndWrite( slot );
+			}
+		}
+
+		// Process wide cache with default options.
+		static DesignCache& Default()
+		{
+			static DesignCache cache;
+			return cache;
+		}
+
+	private:
+
+		static constexpr size_t Ways = 4;
+		static constexpr int EmptySlot = -1;
+
+		struct Key
+		{
+			FilterType type;
+			T peakGain, Fc, Q, Fs;
+		};
+
+		struct alignas(64) Slot
+		{
+			std::atomic<uint64_t> sequence{ 0 };
+			std::atomic<uint64_t> stamp{ 0 };
+			std::atomic<int> type{ EmptySlot };
+			std::atomic<T> params[4];
+			std::atomic<T> coeffs[6];
+		};
+
+		static T Quantize( T value, T step )
+		{
+			return step > 0 ? std::round( value / step ) * step : value;
+		}
+
+		// Fc and Q are divided by (Fc through the prewarped frequency), so a
+		// positive value stays in the first non-zero bin.
+		static T QuantizePositive( T value, T step )
+		{
+			const T quantized = Quantize( value, step );
+			return value > 0 && quantized == 0 ? step : quantized;
+		}
+
+		Key MakeKey( FilterType type, T peakGain, T Fc, T Q, T Fs ) const
+		{
+			// Unused parameters are zeroed so they do not split entries.
+			Key key;
+			key.type = type;
+			key.peakGain = UsesGain( type ) ? Quantize( peakGain, options.gainStep ) : T( 0 );
+			key.Fc = QuantizePositive( Fc, options.frequencyStep );
+			key.Q = UsesQ( type ) ? QuantizePositive( Q, options.qStep ) : T( 0 );
+			key.Fs = Fs;
+			return key;
+		}
+
+		static uint64_t Bits( T value )
+		{
+			if constexpr (sizeof( T ) == sizeof( uint64_t ))
+			{
+				return std::bit_cast<uint64_t>(value);
+			}
+			else if constexpr (sizeof( T ) == sizeof( uint32_t ))
+			{
+				return std::bit_cast<uint32_t>(value);
+			}
+			else
+			{
+				// long double (padded storage): hash the value as double.
+				return std::bit_cast<uint64_t>(static_cast<double>(value));
+			}
+		}
+
+		static bool SameBits( T x, T y )
+		{
+			if constexpr (sizeof( T ) <= sizeof( uint64_t ))
+			{
+				return Bits( x ) == Bits( y );
+			}
+			else
+			{
+				// Compared by value, so -0.0 and 0.0 share an entry here.
+				return x == y || (x != x && y != y);
+			}
+		}
+
+		static uint64_t Mix( uint64_t h )
+		{
+			// splitmix64 finalizer
+			h ^= h >> 30;
+			h *= 0xbf58476d1ce4e5b9ULL;
+			h ^= h >> 27;
+			h *= 0x94d049bb133111ebULL;
+			h ^= h >> 31;
+			return h;
+		}
+
+		static uint64_t Hash( const Key& key )
+		{
+			uint64_t h = Mix( static_cast<uint64_t>(key.type) + 1 );
+			h = Mix( h ^ Bits( key.peakGain ) );
+			h = Mix( h ^ Bits( key.Fc ) );
+			h = Mix( h ^ Bits( key.Q ) );
+			h = Mix( h ^ Bits( key.Fs ) );
+			return h;
+		}
+
+		static bool Matches( const Slot& slot, const Key& key )
+		{
+			return slot.type.load( std::memory_order_relaxed ) == static_cast<int>(key.type)
+				&& SameBits( slot.params[0].load( std::memory_order_relaxed ), key.peakGain )
+				&& SameBits( slot.params[1].load( std::memory_order_relaxed ), key.Fc )
+				&& SameBits( slot.params[2].load( std::memory_order_relaxed ), key.Q )
+				&& SameBits( slot.params[3].load( std::memory_order_relaxed ), key.Fs );
+		}
+
+		Slot* SetOf( uint64_t hash ) const
+		{
+			return &slots[(hash & setMask) * Ways];
+		}
+
+		std::optional<Biquad<T>> Find( const Key& key, uint64_t hash ) const
+		{
+			Slot* set = SetOf( hash );
+
+			for (size_t way = 0; way < Ways; way++)
+			{
+				Slot& slot = set[way];
+
+				for (;;)
+				{
+					const uint64_t before = slot.sequence.load( std::memory_order_acquire );
+					if (before & 1)
+					{
+						// Writer in progress, treat as a miss for this way.
+						break;
+					}
+
+					const bool match = Matches( slot, key );
+					T c[6];
+					for (int idx = 0; idx < 6; idx++)
+					{
+						c[idx] = slot.coeffs[idx].load( std::memory_order_relaxed );
+					}
+
+					std::atomic_thread_fence( std::memory_order_acquire );
+					if (slot.sequence.load( std::memory_order_relaxed ) != before)
+					{
+						continue;
+					}
+
+					if (!match)
+					{
+						break;
+					}
+
+					const uint64_t now = clock.load( std::memory_order_relaxed );
+					if (slot.stamp.load( std::memory_order_relaxed ) != now)
+					{
+						slot.stamp.store( now, std::memory_order_relaxed );
+					}
+
+					// Stored coefficients are already normalized, so copy them
+					// without going through the normalizing constructor.
+					Biquad<T> result;
+					result.a0 = c[0];
+					result.a1 = c[1];
+					result.a2 = c[2];
+					result.b0 = c[3];
+					result.b1 = c[4];
+					result.b2 = c[5];
+					return result;
+				}
+			}
+
+			return std::nullopt;
+		}
+
+		static void BeginWrite( Slot& slot )
+		{
+			const uint64_t sequence = slot.sequence.load( std::memory_order_relaxed );
+			slot.sequence.store( sequence + 1, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_release );
+		}
+
+		static void EndWrite( Slot& slot )
+		{
+			const uint64_t sequence = slot.sequence.load( std::memory_order_relaxed );
+			slot.sequence.store( sequence + 1, std::memory_order_release );
+		}
+
+		void Insert( const Key& key, uint64_t hash, const Biquad<T>& designed )
+		{
+			std::lock_guard<std::mutex> lock( writeMutex );
+
+			Slot* set = SetOf( hash );
+			Slot* victim = nullptr;
+
+			for (size_t way = 0; way < Ways; way++)
+			{
+				// Another thread may have inserted the same key meanwhile.
+				if (Matches( set[way], key ))
+				{
+					return;
+				}
+			}
+
+			for (size_t way = 0; way < Ways; way++)
+			{
+				Slot& slot = set[way];
+				if (slot.type.load( std::memory_order_relaxed ) == EmptySlot)
+				{
+					victim = &slot;
+					break;
+				}
+
+				if (!victim || slot.stamp.load( std::memory_order_relaxed )
+					< victim->stamp.load( std::memory_order_relaxed ))
+				{
+					victim = &slot;
+				}
+			}
+
+			if (victim->type.load( std::memory_order_relaxed ) != EmptySlot)
+			{
+				evictions.fetch_add( 1, std::memory_order_relaxed );
+			}
+
+			const uint64_t now = clock.fetch_add( 1, std::memory_order_relaxed ) + 1;
+
+			BeginWrite( *victim );
+			victim->type.store( static_cast<int>(key.type), std::memory_order_relaxed );
+			victim->params[0].store( key.peakGain, std::memory_order_relaxed );
+			victim->params[1].store( key.Fc, std::memory_order_relaxed );
+			victim->params[2].store( key.Q, std::memory_order_relaxed );
+			victim->params[3].store( key.Fs, std::memory_order_relaxed );
+			victim->coeffs[0].store( designed.a0, std::memory_order_relaxed );
+			victim->coeffs[1].store( designed.a1, std::memory_order_relaxed );
+			victim->coeffs[2].store( designed.a2, std::memory_order_relaxed );
+			victim->coeffs[3].store( designed.b0, std::memory_order_relaxed );
+			victim->coeffs[4].store( designed.b1, std::memory_order_relaxed );
+			victim->coeffs[5].store( designed.b2, std::memory_order_relaxed );
+			victim->stamp.store( now, std::memory_order_relaxed );
+			EndWrite( *victim );
+		}
+
+		DesignCacheOptions<T> options;
+		size_t setMask = 0;
+		std::unique_ptr<Slot[]> slots;
+
+		std::mutex writeMutex;
+		std::atomic<uint64_t> clock{ 0 };
+
+		alignas(64) std::atomic<uint64_t> hits{ 0 };
+		std::atomic<uint64_t> misses{ 0 };
+		std::atomic<uint64_t> evictions{ 0 };
+	};
+
+	// Drop-in replacements for the IIR:: designers that go through
+	// DesignCache<T>::Default().
+	namespace Cached
+	{
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> AllPass1stOrder( T Fc, T Fs )
+		{ return DesignCache<T>::Default().AllPass1stOrder( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> AllPassQ( T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().AllPassQ( Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> BandPass( T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().BandPass( Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> HighPass( T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().HighPass( Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> HighPass12dbOct( T Fc, T Fs )
+		{ return DesignCache<T>::Default().HighPass12dbOct( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> HighPass1stOrder( T Fc, T Fs )
+		{ return DesignCache<T>::Default().HighPass1stOrder( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> HighShelf( T peakGain, T Fc, T Fs )
+		{ return DesignCache<T>::Default().HighShelf( peakGain, Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> HighShelf1stOrder( T peakGain, T Fc, T Fs )
+		{ return DesignCache<T>::Default().HighShelf1stOrder( peakGain, Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> HighShelfQ( T peakGain, T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().HighShelfQ( peakGain, Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> LowPass( T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().LowPass( Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> LowPass12dbOct( T Fc, T Fs )
+		{ return DesignCache<T>::Default().LowPass12dbOct( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> LowPass1stOrder( T Fc, T Fs )
+		{ return DesignCache<T>::Default().LowPass1stOrder( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> LowShelf( T peakGain, T Fc, T Fs )
+		{ return DesignCache<T>::Default().LowShelf( peakGain, Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> LowShelf1stOrder( T peakGain, T Fc, T Fs )
+		{ return DesignCache<T>::Default().LowShelf1stOrder( peakGain, Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> LowShelfQ( T peakGain, T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().LowShelfQ( peakGain, Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> Notch( T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().Notch( Fc, Q, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> OnePoleHighPass( T Fc, T Fs )
+		{ return DesignCache<T>::Default().OnePoleHighPass( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> OnePoleLowPass( T Fc, T Fs )
+		{ return DesignCache<T>::Default().OnePoleLowPass( Fc, Fs ); }
+
+		template <typename T> requires std::is_floating_point_v<T>
+		Biquad<T> PeakEq( T peakGain, T Fc, T Q, T Fs )
+		{ return DesignCache<T>::Default().PeakEq( peakGain, Fc, Q, Fs ); }
+	}
+}
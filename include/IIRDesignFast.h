@@ -0,0 +1,524 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <bit>
+#include <stdexcept>
+#include "Biquad.h"
+#include "Constants.h"
+#include "IIRDesign.h"
+
+// Approximate versions of the IIR:: designers for audio rate parameter
+// modulation.
+//
+// IIR::Fast::X takes the same parameters as IIR::X but replaces
+//   - tan in PrewarpFrequency by a [7/6] Pade approximant, kept as a
+//     numerator / denominator pair and folded into the normalization,
+//   - pow/exp by a range reduced exp2 polynomial,
+//   - the normalizing division by a bit-trick reciprocal estimate refined
+//     with Newton steps.
+// Every design costs a single reciprocal (two if Fs is not loop invariant)
+// and no transcendental calls.
+//
+// Valid range: 0 < Fc <= 0.45 * Fs (tan relative error < 3.5e-9 there),
+// |peakGain| <= 48 dB, Q >= 0.05.
+//
+// Measured over that range (all single section designers, Fs of 44.1, 48
+// and 96 kHz, log grid from 10 Hz to Fs / 2), the magnitude response of a
+// double design differs from the exact design by at most 1e-4 dB and the
+// phase by at most 1e-6 rad, ignoring points more than 100 dB below unity
+// where notch zeros make the comparison meaningless. Test_FastDesign in
+// Sample-Test1 checks this bound.
+//
+// Speed (BM_DesignFast against BM_Design, x86-64, random parameters): most
+// designers run 1.4x to 2x faster, PeakEq and the shelves 1.2x to 1.6x and
+// HighShelf / HighShelfQ about as fast as the exact design: on CPUs with a
+// fast divider the Newton steps of FastReciprocal cost about as much as the
+// division they replace. For throughput over many filters use the batch
+// designers of IIRBatchDesign.h.
+
+namespace DigitalFilters::Utils
+{
+	// 1 / x from an integer estimate plus Newton-Raphson steps (four for
+	// double, three for float), accurate to a few ulp. x must be finite and
+	// non zero.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline T FastReciprocal( T x )
+	{
+		if constexpr (std::is_same_v<T, double>)
+		{
+			const double magnitude = x < 0 ? -x : x;
+			double r = std::bit_cast<double>(
+				0x7FDE623822FC16E6ULL - std::bit_cast<std::uint64_t>(magnitude) );
+			r = r * (2.0 - magnitude * r);
+			r = r * (2.0 - magnitude * r);
+			r = r * (2.0 - magnitude * r);
+			r = r * (2.0 - magnitude * r);
+			return x < 0 ? -r : r;
+		}
+		else if constexpr (std::is_same_v<T, float>)
+		{
+			const float magnitude = x < 0 ? -x : x;
+			float r = std::bit_cast<float>(
+				0x7EF311C7U - std::bit_cast<std::uint32_t>(magnitude) );
+			r = r * (2.0f - magnitude * r);
+			r = r * (2.0f - magnitude * r);
+			r = r * (2.0f - magnitude * r);
+			return x < 0 ? -r : r;
+		}
+		else
+		{
+			return 1 / x;
+		}
+	}
+
+	// tan(x) = numerator / denominator, not yet divided.
+	template <typename T>
+	struct FastTanRatio
+	{
+		T numerator;
+		T denominator;
+	};
+
+	// [7/6] Pade approximant of tan(x), for 0 <= x <= 0.45 * pi.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline FastTanRatio<T> FastTanAsRatio( T x )
+	{
+		const T x2 = x * x;
+		return {
+			x * (T( 135135 ) + x2 * (T( -17325 ) + x2 * (T( 378 ) - x2))),
+			T( 135135 ) + x2 * (T( -62370 ) + x2 * (T( 3150 ) - T( 28 ) * x2)) };
+	}
+
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline T FastTan( T x )
+	{
+		const FastTanRatio<T> ratio = FastTanAsRatio( x );
+		return ratio.numerator * FastReciprocal( ratio.denominator );
+	}
+
+	// 2^x, rounded range reduction and a degree 7 Taylor polynomial
+	// (relative error < 1e-8). |x| < 1000 (|x| < 126 for float).
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline T FastExp2( T x )
+	{
+		const int n = static_cast<int>(x + (x < 0 ? T( -0.5 ) : T( 0.5 )));
+		const T f = (x - static_cast<T>(n)) * Constants::ln2<T>();
+
+		T p = T( 1 ) / T( 5040 );
+		p = p * f + T( 1 ) / T( 720 );
+		p = p * f + T( 1 ) / T( 120 );
+		p = p * f + T( 1 ) / T( 24 );
+		p = p * f + T( 1 ) / T( 6 );
+		p = p * f + T( 0.5 );
+		p = p * f + T( 1 );
+		p = p * f + T( 1 );
+
+		if constexpr (std::is_same_v<T, double>)
+		{
+			return p * std::bit_cast<double>(static_cast<std::uint64_t>(n + 1023) << 52);
+		}
+		else if constexpr (std::is_same_v<T, float>)
+		{
+			return p * std::bit_cast<float>(static_cast<std::uint32_t>(n + 127) << 23);
+		}
+		else
+		{
+			T scale = 1;
+			const T step = n < 0 ? T( 0.5 ) : T( 2 );
+			for (int k = n < 0 ? -n : n; k > 0; k--)
+			{
+				scale *= step;
+			}
+			return p * scale;
+		}
+	}
+
+	// e^x via FastExp2.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline T FastExp( T x )
+	{
+		return FastExp2( x * Constants::log2e<T>() );
+	}
+
+	// Approximate DecibelToLinearGain.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline T FastDecibelToLinearGain( T dB )
+	{
+		// 10^(|dB| / 20) = 2^(|dB| * log2(10) / 20)
+		constexpr T scale = static_cast<T>(Constants::ln10_ld * Constants::log2e_ld / 20);
+		return FastExp2( (dB < 0 ? -dB : dB) * scale );
+	}
+
+	// Approximate PrewarpFrequency as a numerator / denominator pair.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline FastTanRatio<T> FastPrewarpFrequencyAsRatio( T cutoffFrequencyHz, T samplingFrequencyHz )
+	{
+		return FastTanAsRatio(
+			Constants::pi<T>() * cutoffFrequencyHz * FastReciprocal( samplingFrequencyHz ) );
+	}
+
+	// Approximate PrewarpFrequency.
+	template <typename T>
+		requires std::is_floating_point_v<T>
+	inline T FastPrewarpFrequency( T cutoffFrequencyHz, T samplingFrequencyHz )
+	{
+		return FastTan(
+			Constants::pi<T>() * cutoffFrequencyHz * FastReciprocal( samplingFrequencyHz ) );
+	}
+}
+
+namespace DigitalFilters::IIR::Fast
+{
+	using namespace Utils;
+	using namespace Constants;
+
+	// With omega = n / d every design below is the exact design multiplied
+	// through by d^2 (and by Q where 1 / Q appears), so only the final
+	// normalization needs a reciprocal.
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> HighShelf1stOrder( T peakGain, T Fc, T Fs )
+	{
+		const T gain = FastDecibelToLinearGain( peakGain );
+		const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+
+		if (peakGain >= 0)
+		{
+			const T norm = FastReciprocal( n + d );
+			return Biquad<T>( (n + gain * d) * norm, (n - gain * d) * norm, 0,
+				(n - d) * norm, 0 );
+		}
+
+		const T norm = FastReciprocal( n + gain * d );
+		return Biquad<T>( (n + d) * norm, (n - d) * norm, 0,
+			(n - gain * d) * norm, 0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> LowShelf1stOrder( T peakGain, T Fc, T Fs )
+	{
+		const T gain = FastDecibelToLinearGain( peakGain );
+		const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+
+		if (peakGain >= 0)
+		{
+			const T norm = FastReciprocal( n + d );
+			return Biquad<T>( (gain * n + d) * norm, (gain * n - d) * norm, 0,
+				(n - d) * norm, 0 );
+		}
+
+		const T norm = FastReciprocal( gain * n + d );
+		return Biquad<T>( (n + d) * norm, (n - d) * norm, 0,
+			(gain * n - d) * norm, 0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> HighPass1stOrder( T Fc, T Fs )
+	{
+		const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+		const T norm = FastReciprocal( n + d );
+		const T a0 = d * norm;
+
+		return Biquad<T>( a0, -a0, 0, (n - d) * norm, 0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> LowPass1stOrder( T Fc, T Fs )
+	{
+		const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+		const T norm = FastReciprocal( n + d );
+		const T a0 = n * norm;
+
+		return Biquad<T>( a0, a0, 0, (n - d) * norm, 0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> AllPass1stOrder( T Fc, T Fs )
+	{
+		const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+		const T a0 = (d - n) * FastReciprocal( d + n );
+
+		return Biquad<T>( a0, -1, 0, -a0, 0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> OnePoleLowPass( T Fc, T Fs )
+	{
+		const T b1 = FastExp( -2 * pi<T>() * Fc * FastReciprocal( Fs ) );
+		return Biquad<T>( 1 - b1, 0, 0, -b1, 0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> OnePoleHighPass( T Fc, T Fs )
+	{
+		const T b1 = -FastExp( -2 * pi<T>() * (T( 0.5 ) - Fc * FastReciprocal( Fs )) );
+		return Biquad<T>( 1 + b1, 0, 0, -b1, 0 );
+	}
+
+	namespace Detail
+	{
+		// Second order terms scaled by Q * d^2: unit for 1, cross for
+		// omega / Q and square for omega^2.
+		template <typename T>
+		struct FastSecondOrderTerms
+		{
+			T unit;
+			T cross;
+			T square;
+		};
+
+		template <typename T>
+		inline FastSecondOrderTerms<T> SecondOrderTerms( T Fc, T Q, T Fs )
+		{
+			const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+			return { Q * d * d, n * d, Q * n * n };
+		}
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> AllPassQ( T Fc, T Q, T Fs )
+	{
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T norm = FastReciprocal( unit + cross + square );
+
+		const T a0 = (unit - cross + square) * norm;
+		const T a1 = 2 * (square - unit) * norm;
+		return Biquad<T>( a0, a1, 1, a1, a0 );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> LowPass( T Fc, T Q, T Fs )
+	{
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T norm = FastReciprocal( unit + cross + square );
+
+		const T a0 = square * norm;
+		return Biquad<T>( a0, 2 * a0, a0,
+			2 * (square - unit) * norm, (unit - cross + square) * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> LowPass12dbOct( T Fc, T Fs )
+	{
+		return Fast::LowPass( Fc, one_over_sqrt2<T>(), Fs );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> HighPass( T Fc, T Q, T Fs )
+	{
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T norm = FastReciprocal( unit + cross + square );
+
+		const T a0 = unit * norm;
+		return Biquad<T>( a0, -2 * a0, a0,
+			2 * (square - unit) * norm, (unit - cross + square) * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> HighPass12dbOct( T Fc, T Fs )
+	{
+		return Fast::HighPass( Fc, one_over_sqrt2<T>(), Fs );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> BandPass( T Fc, T Q, T Fs )
+	{
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T norm = FastReciprocal( unit + cross + square );
+
+		const T a0 = cross * norm;
+		return Biquad<T>( a0, 0, -a0,
+			2 * (square - unit) * norm, (unit - cross + square) * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> Notch( T Fc, T Q, T Fs )
+	{
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T norm = FastReciprocal( unit + cross + square );
+
+		const T a0 = (unit + square) * norm;
+		const T a1 = 2 * (square - unit) * norm;
+		return Biquad<T>( a0, a1, a0, a1, (unit - cross + square) * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> PeakEq( T peakGain, T Fc, T Q, T Fs )
+	{
+		const T gain = FastDecibelToLinearGain( peakGain );
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T mid = 2 * (square - unit);
+
+		const T unity0 = unit + cross + square;
+		const T unity2 = unit - cross + square;
+		const T gain0 = unit + gain * cross + square;
+		const T gain2 = unit - gain * cross + square;
+
+		if (peakGain >= 0)
+		{
+			const T norm = FastReciprocal( unity0 );
+			return Biquad<T>( gain0 * norm, mid * norm, gain2 * norm,
+				mid * norm, unity2 * norm );
+		}
+
+		const T norm = FastReciprocal( gain0 );
+		return Biquad<T>( unity0 * norm, mid * norm, unity2 * norm,
+			mid * norm, gain2 * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> HighShelfQ( T peakGain, T Fc, T Q, T Fs )
+	{
+		const T gain = FastDecibelToLinearGain( peakGain );
+		// sqrt(2 * gain) = sqrt2 * 10^(|dB| / 40); it multiplies omega, not
+		// omega / Q, hence the extra Q.
+		const T sqrt2Gain = sqrt2<T>() * FastDecibelToLinearGain( peakGain / 2 );
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+		const T sqrt2GainOmega = sqrt2Gain * Q * cross;
+
+		const T unity0 = unit + cross + square;
+		const T unity1 = 2 * (square - unit);
+		const T unity2 = unit - cross + square;
+		const T gain0 = gain * unit + sqrt2GainOmega + square;
+		const T gain1 = 2 * (square - gain * unit);
+		const T gain2 = gain * unit - sqrt2GainOmega + square;
+
+		if (peakGain >= 0)
+		{
+			const T norm = FastReciprocal( unity0 );
+			return Biquad<T>( gain0 * norm, gain1 * norm, gain2 * norm,
+				unity1 * norm, unity2 * norm );
+		}
+
+		const T norm = FastReciprocal( gain0 );
+		return Biquad<T>( unity0 * norm, unity1 * norm, unity2 * norm,
+			gain1 * norm, gain2 * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> HighShelf( T peakGain, T Fc, T Fs )
+	{
+		return Fast::HighShelfQ( peakGain, Fc, one_over_sqrt2<T>(), Fs );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> LowShelf( T peakGain, T Fc, T Fs )
+	{
+		const T gain = FastDecibelToLinearGain( peakGain );
+		const T sqrt2Gain = sqrt2<T>() * FastDecibelToLinearGain( peakGain / 2 );
+		const auto [n, d] = FastPrewarpFrequencyAsRatio( Fc, Fs );
+		const T unit = d * d;
+		const T cross = n * d;
+		const T square = n * n;
+
+		const T unity0 = unit + sqrt2<T>() * cross + square;
+		const T unity1 = 2 * (square - unit);
+		const T unity2 = unit - sqrt2<T>() * cross + square;
+		const T gain0 = unit + sqrt2Gain * cross + gain * square;
+		const T gain1 = 2 * (gain * square - unit);
+		const T gain2 = unit - sqrt2Gain * cross + gain * square;
+
+		if (peakGain >= 0)
+		{
+			const T norm = FastReciprocal( unity0 );
+			return Biquad<T>( gain0 * norm, gain1 * norm, gain2 * norm,
+				unity1 * norm, unity2 * norm );
+		}
+
+		const T norm = FastReciprocal( gain0 );
+		return Biquad<T>( unity0 * norm, unity1 * norm, unity2 * norm,
+			gain1 * norm, gain2 * norm );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> LowShelfQ( T peakGain, T Fc, T Q, T Fs )
+	{
+		const T gain = FastDecibelToLinearGain( peakGain );
+		// sqrt(gain) = 10^(|dB| / 40)
+		const T sqrtGain = FastDecibelToLinearGain( peakGain / 2 );
+		const auto [unit, cross, square] = Detail::SecondOrderTerms( Fc, Q, Fs );
+
+		const T unity0 = unit + cross + square;
+		const T unity1 = 2 * (square - unit);
+		const T unity2 = unit - cross + square;
+		const T gain0 = unit + sqrtGain * cross + gain * square;
+		const T gain1 = 2 * (gain * square - unit);
+		const T gain2 = unit - sqrtGain * cross + gain * square;
+
+		if (peakGain >= 0)
+		{
+			const T norm = FastReciprocal( unity0 );
+			return Biquad<T>( gain0 * norm, gain1 * norm, gain2 * norm,
+				unity1 * norm, unity2 * norm );
+		}
+
+		const T norm = FastReciprocal( gain0 );
+		return Biquad<T>( unity0 * norm, unity1 * norm, unity2 * norm,
+			gain1 * norm, gain2 * norm );
+	}
+
+	// Fast counterpart of IIR::Design.
+	template <typename T> requires std::is_floating_point_v<T>
+	Biquad<T> Design( FilterType type, T peakGain, T Fc, T Q, T Fs )
+	{
+		switch (type)
+		{
+		case FilterType::AllPass1stOrder:   return Fast::AllPass1stOrder( Fc, Fs );
+		case FilterType::AllPassQ:          return Fast::AllPassQ( Fc, Q, Fs );
+		case FilterType::BandPass:          return Fast::BandPass( Fc, Q, Fs );
+		case FilterType::HighPass:          return Fast::HighPass( Fc, Q, Fs );
+		case FilterType::HighPass12dbOct:   return Fast::HighPass12dbOct( Fc, Fs );
+		case FilterType::HighPass1stOrder:  return Fast::HighPass1stOrder( Fc, Fs );
+		case FilterType::HighShelf:         return Fast::HighShelf( peakGain, Fc, Fs );
+		case FilterType::HighShelf1stOrder: return Fast::HighShelf1stOrder( peakGain, Fc, Fs );
+		case FilterType::HighShelfQ:        return Fast::HighShelfQ( peakGain, Fc, Q, Fs );
+		case FilterType::LowPass:           return Fast::LowPass( Fc, Q, Fs );
+		case FilterType::LowPass12dbOct:    return Fast::LowPass12dbOct( Fc, Fs );
+		case FilterType::LowPass1stOrder:   return Fast::LowPass1stOrder( Fc, Fs );
+		case FilterType::LowShelf:          return Fast::LowShelf( peakGain, Fc, Fs );
+		case FilterType::LowShelf1stOrder:  return Fast::LowShelf1stOrder( peakGain, Fc, Fs );
+		case FilterType::LowShelfQ:         return Fast::LowShelfQ( peakGain, Fc, Q, Fs );
+		case FilterType::Notch:             return Fast::Notch( Fc, Q, Fs );
+		case FilterType::OnePoleHighPass:   return Fast::OnePoleHighPass( Fc, Fs );
+		case FilterType::OnePoleLowPass:    return Fast::OnePoleLowPass( Fc, Fs );
+		case FilterType::PeakEq:            return Fast::PeakEq( peakGain, Fc, Q, Fs );
+		}
+
+		throw std::invalid_argument( "Unknown filter type." );
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	std::vector<Biquad<T>> LowPassCascadeAsButterworth( int order, T Fc, T Fs )
+	{
+		std::vector<Biquad<T>> coefficients;
+
+		for (T q : ButterworthResponceQfactors<T>( order ))
+		{
+			coefficients.push_back( Fast::LowPass( Fc, q, Fs ) );
+		}
+
+		return coefficients;
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	std::vector<Biquad<T>> HighPassCascadeAsButterworth( int order, T Fc, T Fs )
+	{
+		std::vector<Biquad<T>> coefficients;
+
+		for (T q : ButterworthResponceQfactors<T>( order ))
+		{
+			coefficients.push_back( Fast::HighPass( Fc, q, Fs ) );
+		}
+
+		return coefficients;
+	}
+}
@@ -12,7 +12,7 @@ namespace DigitalFilters::IIR
 	using std::vector;
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> HighShelf1stOrder( T peakGain, T Fc, T Fs )
+	constexpr Biquad<T> HighShelf1stOrder( T peakGain, T Fc, T Fs )
 	{
 		const T gain = DecibelToLinearGain( peakGain );
 		const T omega = PrewarpFrequency( Fc, Fs );
@@ -43,7 +43,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> LowShelf1stOrder( T peakGain, T Fc, T Fs )
+	constexpr Biquad<T> LowShelf1stOrder( T peakGain, T Fc, T Fs )
 	{
 		T gain = DecibelToLinearGain( peakGain );
 		T omega = PrewarpFrequency( Fc, Fs );
@@ -75,7 +75,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> HighPass1stOrder( T Fc, T Fs )
+	constexpr Biquad<T> HighPass1stOrder( T Fc, T Fs )
 	{
 		T omega = PrewarpFrequency( Fc, Fs );
 		T norm;
@@ -93,7 +93,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> LowPass1stOrder( T Fc, T Fs )
+	constexpr Biquad<T> LowPass1stOrder( T Fc, T Fs )
 	{
 		T omega = PrewarpFrequency( Fc, Fs );
 		T norm;
@@ -110,7 +110,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> AllPass1stOrder( T Fc, T Fs )
+	constexpr Biquad<T> AllPass1stOrder( T Fc, T Fs )
 	{
 
 		T omega = PrewarpFrequency( Fc, Fs );
@@ -126,7 +126,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> AllPassQ( T Fc, T Q, T Fs )
+	constexpr Biquad<T> AllPassQ( T Fc, T Q, T Fs )
 	{
 		T omega = PrewarpFrequency( Fc, Fs );
 		T norm;
@@ -144,12 +144,12 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> OnePoleLowPass( T Fc, T Fs )
+	constexpr Biquad<T> OnePoleLowPass( T Fc, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
 
-		b1 = exp( -2.0 * pi<T>() * (Fc / Fs) );
+		b1 = Exp( -2.0 * pi<T>() * (Fc / Fs) );
 		a0 = 1.0 - b1;
 		b1 = -b1;
 		a1 = a2 = b2 = 0;
@@ -157,12 +157,12 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> OnePoleHighPass( T Fc, T Fs )
+	constexpr Biquad<T> OnePoleHighPass( T Fc, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
 
-		b1 = -exp( -2.0 * pi<T>() * (0.5 - Fc / Fs) ); //dubious -exp
+		b1 = -Exp( -2.0 * pi<T>() * (0.5 - Fc / Fs) ); //dubious -exp
 		a0 = 1.0 + b1;
 		b1 = -b1;
 		a1 = a2 = b2 = 0;
@@ -170,7 +170,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> LowPass( T Fc, T Q, T Fs )
+	constexpr Biquad<T> LowPass( T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -188,7 +188,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> LowPass12dbOct( T Fc, T Fs )
+	constexpr Biquad<T> LowPass12dbOct( T Fc, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -205,7 +205,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> HighPass( T Fc, T Q, T Fs )
+	constexpr Biquad<T> HighPass( T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -223,7 +223,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> HighPass12dbOct( T Fc, T Fs )
+	constexpr Biquad<T> HighPass12dbOct( T Fc, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -241,7 +241,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> BandPass( T Fc, T Q, T Fs )
+	constexpr Biquad<T> BandPass( T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -259,7 +259,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> Notch( T Fc, T Q, T Fs )
+	constexpr Biquad<T> Notch( T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -276,7 +276,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> PeakEq( T peakGain, T Fc, T Q, T Fs )
+	constexpr Biquad<T> PeakEq( T peakGain, T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -308,7 +308,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> HighShelf( T peakGain, T Fc, T Fs )
+	constexpr Biquad<T> HighShelf( T peakGain, T Fc, T Fs )
 	{
 
 		T a0, a1, a2;
@@ -321,26 +321,26 @@ namespace DigitalFilters::IIR
 		if (peakGain >= 0)
 		{
 			norm = 1 / (1 + sqrt2 <T>() * omega + omega * omega);
-			a0 = (gain + sqrt( 2 * gain ) * omega + omega * omega) * norm;
+			a0 = (gain + Sqrt( 2 * gain ) * omega + omega * omega) * norm;
 			a1 = 2 * (omega * omega - gain) * norm;
-			a2 = (gain - sqrt( 2 * gain ) * omega + omega * omega) * norm;
+			a2 = (gain - Sqrt( 2 * gain ) * omega + omega * omega) * norm;
 			b1 = 2 * (omega * omega - 1) * norm;
 			b2 = (1 - sqrt2<T>() * omega + omega * omega) * norm;
 		}
 		else
 		{
-			norm = 1 / (gain + sqrt( 2 * gain ) * omega + omega * omega);
+			norm = 1 / (gain + Sqrt( 2 * gain ) * omega + omega * omega);
 			a0 = (1 + sqrt2<T>() * omega + omega * omega) * norm;
 			a1 = 2 * (omega * omega - 1) * norm;
 			a2 = (1 - sqrt2<T>() * omega + omega * omega) * norm;
 			b1 = 2 * (omega * omega - gain) * norm;
-			b2 = (gain - sqrt( 2 * gain ) * omega + omega * omega) * norm;
+			b2 = (gain - Sqrt( 2 * gain ) * omega + omega * omega) * norm;
 		}
 		return 	Biquad<T>( a0, a1, a2, b1, b2 );
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> HighShelfQ( T peakGain, T Fc, T Q, T Fs )
+	constexpr Biquad<T> HighShelfQ( T peakGain, T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -352,26 +352,26 @@ namespace DigitalFilters::IIR
 		if (peakGain >= 0)
 		{
 			norm = 1 / (1 + 1 / Q * omega + omega * omega);
-			a0 = (gain + sqrt( 2 * gain ) * omega + omega * omega) * norm;
+			a0 = (gain + Sqrt( 2 * gain ) * omega + omega * omega) * norm;
 			a1 = 2 * (omega * omega - gain) * norm;
-			a2 = (gain - sqrt( 2 * gain ) * omega + omega * omega) * norm;
+			a2 = (gain - Sqrt( 2 * gain ) * omega + omega * omega) * norm;
 			b1 = 2 * (omega * omega - 1) * norm;
 			b2 = (1 - 1 / Q * omega + omega * omega) * norm;
 		}
 		else
 		{
-			norm = 1 / (gain + sqrt( 2 * gain ) * omega + omega * omega);
+			norm = 1 / (gain + Sqrt( 2 * gain ) * omega + omega * omega);
 			a0 = (1 + 1 / Q * omega + omega * omega) * norm;
 			a1 = 2 * (omega * omega - 1) * norm;
 			a2 = (1 - 1 / Q * omega + omega * omega) * norm;
 			b1 = 2 * (omega * omega - gain) * norm;
-			b2 = (gain - sqrt( 2 * gain ) * omega + omega * omega) * norm;
+			b2 = (gain - Sqrt( 2 * gain ) * omega + omega * omega) * norm;
 		}
 		return 	Biquad<T>( a0, a1, a2, b1, b2 );
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> LowShelf( T peakGain, T Fc, T Fs )
+	constexpr Biquad<T> LowShelf( T peakGain, T Fc, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -383,20 +383,20 @@ namespace DigitalFilters::IIR
 		if (peakGain >= 0)
 		{
 			norm = 1 / (1 + sqrt2<T>() * omega + omega * omega);
-			a0 = (1 + sqrt( 2 * gain ) * omega + gain * omega * omega) * norm;
+			a0 = (1 + Sqrt( 2 * gain ) * omega + gain * omega * omega) * norm;
 			a1 = 2 * (gain * omega * omega - 1) * norm;
-			a2 = (1 - sqrt( 2 * gain ) * omega + gain * omega * omega) * norm;
+			a2 = (1 - Sqrt( 2 * gain ) * omega + gain * omega * omega) * norm;
 			b1 = 2 * (omega * omega - 1) * norm;
 			b2 = (1 - sqrt2<T>() * omega + omega * omega) * norm;
 		}
 		else
 		{
-			norm = 1 / (1 + sqrt( 2 * gain ) * omega + gain * omega * omega);
+			norm = 1 / (1 + Sqrt( 2 * gain ) * omega + gain * omega * omega);
 			a0 = (1 + sqrt2<T>() * omega + omega * omega) * norm;
 			a1 = 2 * (omega * omega - 1) * norm;
 			a2 = (1 - sqrt2<T>() * omega + omega * omega) * norm;
 			b1 = 2 * (gain * omega * omega - 1) * norm;
-			b2 = (1 - sqrt( 2 * gain ) * omega + gain * omega * omega) * norm;
+			b2 = (1 - Sqrt( 2 * gain ) * omega + gain * omega * omega) * norm;
 		}
 
 		return 	Biquad<T>( a0, a1, a2, b1, b2 );
@@ -404,7 +404,7 @@ namespace DigitalFilters::IIR
 	}
 
 	template <typename T> requires std::is_floating_point_v<T>
-	Biquad<T> LowShelfQ( T peakGain, T Fc, T Q, T Fs )
+	constexpr Biquad<T> LowShelfQ( T peakGain, T Fc, T Q, T Fs )
 	{
 		T a0, a1, a2;
 		T b1, b2;
@@ -416,26 +416,90 @@ namespace DigitalFilters::IIR
 		if (peakGain >= 0)
 		{    // boost
 			norm = 1 / (1 + 1 / Q * omega + omega * omega);
-			a0 = (1 + sqrt( gain ) / Q * omega + gain * omega * omega) * norm;
+			a0 = (1 + Sqrt( gain ) / Q * omega + gain * omega * omega) * norm;
 			a1 = 2 * (gain * omega * omega - 1) * norm;
-			a2 = (1 - sqrt( gain ) / Q * omega + gain * omega * omega) * norm;
+			a2 = (1 - Sqrt( gain ) / Q * omega + gain * omega * omega) * norm;
 			b1 = 2 * (omega * omega - 1) * norm;
 			b2 = (1 - 1 / Q * omega + omega * omega) * norm;
 		}
 		else
 		{    // cut
-			norm = 1 / (1 + sqrt( gain ) / Q * omega + gain * omega * omega);
+			norm = 1 / (1 + Sqrt( gain ) / Q * omega + gain * omega * omega);
 			a0 = (1 + 1 / Q * omega + omega * omega) * norm;
 			a1 = 2 * (omega * omega - 1) * norm;
 			a2 = (1 - 1 / Q * omega + omega * omega) * norm;
 			b1 = 2 * (gain * omega * omega - 1) * norm;
-			b2 = (1 - sqrt( gain ) / Q * omega + gain * omega * omega) * norm;
+			b2 = (1 - Sqrt( gain ) / Q * omega + gain * omega * omega) * norm;
 		}
 
 		return 	Biquad<T>( a0, a1, a2, b1, b2 );
 
 	}
 
+	constexpr bool UsesGain( FilterType type )
+	{
+		switch (type)
+		{
+		case FilterType::HighShelf:
+		case FilterType::HighShelf1stOrder:
+		case FilterType::HighShelfQ:
+		case FilterType::LowShelf:
+		case FilterType::LowShelf1stOrder:
+		case FilterType::LowShelfQ:
+		case FilterType::PeakEq:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	constexpr bool UsesQ( FilterType type )
+	{
+		switch (type)
+		{
+		case FilterType::AllPassQ:
+		case FilterType::BandPass:
+		case FilterType::HighPass:
+		case FilterType::HighShelfQ:
+		case FilterType::LowPass:
+		case FilterType::LowShelfQ:
+		case FilterType::Notch:
+		case FilterType::PeakEq:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	constexpr Biquad<T> Design( FilterType type, T peakGain, T Fc, T Q, T Fs )
+	{
+		switch (type)
+		{
+		case FilterType::AllPass1stOrder:   return AllPass1stOrder( Fc, Fs );
+		case FilterType::AllPassQ:          return AllPassQ( Fc, Q, Fs );
+		case FilterType::BandPass:          return BandPass( Fc, Q, Fs );
+		case FilterType::HighPass:          return HighPass( Fc, Q, Fs );
+		case FilterType::HighPass12dbOct:   return HighPass12dbOct( Fc, Fs );
+		case FilterType::HighPass1stOrder:  return HighPass1stOrder( Fc, Fs );
+		case FilterType::HighShelf:         return HighShelf( peakGain, Fc, Fs );
+		case FilterType::HighShelf1stOrder: return HighShelf1stOrder( peakGain, Fc, Fs );
+		case FilterType::HighShelfQ:        return HighShelfQ( peakGain, Fc, Q, Fs );
+		case FilterType::LowPass:           return LowPass( Fc, Q, Fs );
+		case FilterType::LowPass12dbOct:    return LowPass12dbOct( Fc, Fs );
+		case FilterType::LowPass1stOrder:   return LowPass1stOrder( Fc, Fs );
+		case FilterType::LowShelf:          return LowShelf( peakGain, Fc, Fs );
+		case FilterType::LowShelf1stOrder:  return LowShelf1stOrder( peakGain, Fc, Fs );
+		case FilterType::LowShelfQ:         return LowShelfQ( peakGain, Fc, Q, Fs );
+		case FilterType::Notch:             return Notch( Fc, Q, Fs );
+		case FilterType::OnePoleHighPass:   return OnePoleHighPass( Fc, Fs );
+		case FilterType::OnePoleLowPass:    return OnePoleLowPass( Fc, Fs );
+		case FilterType::PeakEq:            return PeakEq( peakGain, Fc, Q, Fs );
+		}
+
+		throw std::invalid_argument( "Unknown filter type." );
+	}
+
 	template <typename T> requires std::is_floating_point_v<T>
 	vector< T > ButterworthResponceQfactors( int fiterOrder )
 	{
@@ -458,7 +522,7 @@ namespace DigitalFilters::IIR
 		for (int idx = 0; idx < pairs; idx++)
 		{
 			T qVal = static_cast<T>( 1.0 ) /
-				(static_cast<T>( 2.0 ) * cos( firstAngle + idx * poleInc ));
+				(static_cast<T>( 2.0 ) * Cos( firstAngle + idx * poleInc ));
 			qVals.push_back( qVal );
 		}
 
@@ -470,7 +534,7 @@ namespace DigitalFilters::IIR
 	{
 		vector<Biquad<T>> coefficients;
 
-		vector<T> qfactors = ButterworthResponseQfactors<T>( order );
+		vector<T> qfactors = ButterworthResponceQfactors<T>( order );
 
 		for (auto iter = qfactors.begin(); iter != qfactors.end(); iter++)
 		{
@@ -493,7 +557,7 @@ namespace DigitalFilters::IIR
 			coefficients.push_back( HighPass( Fc, *iter, Fs ) );
 		}
 
-		return coefficients();
+		return coefficients;
 	}
 
 }
\ No newline at end of file
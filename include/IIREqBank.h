@@ -0,0 +1,286 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "Biquad.h"
+#include "IIRDesign.h"
+#include "Instrumentation.h"
+
+// Graphic / parametric EQ bank.
+//
+// EqBankProcessor designs every band with IIR::Design and keeps only the
+// active ones: bypassed bands and gain based bands (PeakEq, shelves) whose
+// |gain| is below flatThresholdDb are dropped from the chain. Coefficients of
+// the active bands are stored contiguously (a0, a1, a2, b1, b2 per band) and
+// their TDF-II state as [band][s1 / s2][channel].
+//
+// Every frame walks the active bands in order; with several channels each
+// band step runs across the channels at once (#pragma omp simd), so the
+// channel values of the frame stay in registers through the whole chain.
+//
+// A band that becomes active again starts from zero state. The processor
+// accumulates the time spent in Process so the cost per channel per band
+// can be monitored.
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	struct EqBandSettings
+	{
+		FilterType type = FilterType::PeakEq;
+		T gain = 0;
+		T Fc = 1000;
+		T Q = 1;
+		bool bypass = false;
+	};
+
+	struct EqBankCost
+	{
+		size_t frames = 0;
+		size_t channels = 0;
+		size_t activeBands = 0;
+		double nanoseconds = 0;
+
+		// Average cost of one band on one channel for one frame.
+		double NanosecondsPerChannelBand() const
+		{
+			const double work = static_cast<double>(frames) * channels * activeBands;
+			return work > 0 ? nanoseconds / work : 0;
+		}
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class EqBankProcessor
+	{
+	public:
+
+		EqBankProcessor( std::span<const EqBandSettings<T>> bands, T Fs, size_t channels = 1,
+			T flatThresholdDb = static_cast<T>(0.01) )
+			: settings( bands.begin(), bands.end() ), Fs( Fs ), channels( channels ),
+			flatThresholdDb( flatThresholdDb ), frame( channels )
+		{
+			if (channels == 0)
+			{
+				throw std::invalid_argument( "channels must be at least 1." );
+			}
+
+			Rebuild();
+		}
+
+		EqBankProcessor( const std::vector<EqBandSettings<T>>& bands, T Fs, size_t channels = 1,
+			T flatThresholdDb = static_cast<T>(0.01) )
+			: EqBankProcessor( std::span<const EqBandSettings<T>>( bands ), Fs, channels, flatThresholdDb )
+		{
+		}
+
+		size_t Bands() const { return settings.size(); }
+		size_t ActiveBands() const { return active.size(); }
+		size_t Channels() const { return channels; }
+
+		const EqBandSettings<T>& Band( size_t index ) const
+		{
+			return settings.at( index );
+		}
+
+		// Redesigns one band; the state of the other active bands is kept.
+		void SetBand( size_t index, const EqBandSettings<T>& band )
+		{
+			settings.at( index ) = band;
+			Rebuild();
+		}
+
+		void Reset()
+		{
+			std::fill( state.begin(), state.end(), T( 0 ) );
+		}
+
+		// Accumulated cost since construction or the last ResetCost.
+		EqBankCost Cost() const
+		{
+			EqBankCost cost = accumulated;
+			cost.channels = channels;
+			cost.activeBands = active.size();
+			return cost;
+		}
+
+		void ResetCost()
+		{
+			accumulated = {};
+		}
+
+		// Mono processing; input and output may be the same buffer.
+		void Process( std::span<const T> input, std::span<T> output )
+		{
+			if (channels != 1)
+			{
+				throw std::invalid_argument( "Use the planar overload for several channels." );
+			}
+			if (input.size() != output.size())
+			{
+				throw std::invalid_argument( "input and output must have the same size." );
+			}
+
+			const T* in = input.data();
+			T* out = output.data();
+			Process( std::span<const T* const>( &in, 1 ), std::span<T* const>( &out, 1 ), input.size() );
+		}
+
+		// Planar processing, one pointer per channel; inputs and outputs may
+		// be the same buffers.
+		void Process( std::span<const T* const> inputs, std::span<T* const> outputs, size_t frames )
+		{
+			if (inputs.size() != channels || outputs.size() != channels)
+			{
+				throw std::invalid_argument( "One input and one output per channel are required." );
+			}
+
+			DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::EqBankProcess, frames * channels, 0 );
+
+			const auto start = std::chrono::steady_clock::now();
+
+			if (channels == 1)
+			{
+				ProcessMono( inputs[0], outputs[0], frames );
+			}
+			else
+			{
+				ProcessChannels( inputs, outputs, frames );
+			}
+
+			accumulated.frames += frames;
+			accumulated.nanoseconds += std::chrono::duration<double, std::nano>(
+				std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+
+		static constexpr size_t Coefficients = 5;
+
+		bool IsActive( const EqBandSettings<T>& band ) const
+		{
+			return !band.bypass && !(UsesGain( band.type ) && std::abs( band.gain ) < flatThresholdDb);
+		}
+
+		void Rebuild()
+		{
+			std::vector<size_t> bands;
+			std::vector<T> newCoefficients;
+			std::vector<T> newState;
+
+			for (size_t b = 0; b < settings.size(); b++)
+			{
+				const EqBandSettings<T>& band = settings[b];
+				if (!IsActive( band ))
+				{
+					continue;
+				}
+
+				const Biquad<T> biquad = Design( band.type, band.gain, band.Fc, band.Q, Fs );
+				newCoefficients.insert( newCoefficients.end(),
+					{ biquad.a0, biquad.a1, biquad.a2, biquad.b1, biquad.b2 } );
+
+				// Carry the state of bands that stay active.
+				const auto previous = std::find( active.begin(), active.end(), b );
+				if (previous != active.end())
+				{
+					const size_t offset = 2 * channels * (previous - active.begin());
+					newState.insert( newState.end(), state.begin() + offset,
+						state.begin() + offset + 2 * channels );
+				}
+				else
+				{
+					newState.insert( newState.end(), 2 * channels, T( 0 ) );
+				}
+
+				bands.push_back( b );
+			}
+
+			active = std::move( bands );
+			coefficients = std::move( newCoefficients );
+			state = std::move( newState );
+		}
+
+		void ProcessMono( const T* input, T* output, size_t frames )
+		{
+			const size_t count = active.size();
+
+			for (size_t f = 0; f < frames; f++)
+			{
+				T x = input[f];
+				const T* c = coefficients.data();
+				T* s = state.data();
+
+				for (size_t b = 0; b < count; b++)
+				{
+					const T y = c[0] * x + s[0];
+					s[0] = c[1] * x - c[3] * y + s[1];
+					s[1] = c[2] * x - c[4] * y;
+					x = y;
+					c += Coefficients;
+					s += 2;
+				}
+
+				output[f] = x;
+			}
+		}
+
+		void ProcessChannels( std::span<const T* const> inputs, std::span<T* const> outputs, size_t frames )
+		{
+			const size_t count = active.size();
+			T* x = frame.data();
+
+			for (size_t f = 0; f < frames; f++)
+			{
+				for (size_t ch = 0; ch < channels; ch++)
+				{
+					x[ch] = inputs[ch][f];
+				}
+
+				const T* c = coefficients.data();
+				T* s1 = state.data();
+
+				for (size_t b = 0; b < count; b++)
+				{
+					const T a0 = c[0], a1 = c[1], a2 = c[2], b1 = c[3], b2 = c[4];
+					T* s2 = s1 + channels;
+
+					#pragma omp simd
+					for (size_t ch = 0; ch < channels; ch++)
+					{
+						const T in = x[ch];
+						const T y = a0 * in + s1[ch];
+						s1[ch] = a1 * in - b1 * y + s2[ch];
+						s2[ch] = a2 * in - b2 * y;
+						x[ch] = y;
+					}
+
+					c += Coefficients;
+					s1 += 2 * channels;
+				}
+
+				for (size_t ch = 0; ch < channels; ch++)
+				{
+					outputs[ch][f] = x[ch];
+				}
+			}
+		}
+
+		std::vector<EqBandSettings<T>> settings;
+		T Fs;
+		size_t channels;
+		T flatThresholdDb;
+
+		// Indices (into settings) of the active bands, in processing order.
+		std::vector<size_t> active;
+		std::vector<T> coefficients;
+		std::vector<T> state;
+		std::vector<T> frame;
+
+		EqBankCost accumulated;
+	};
+}
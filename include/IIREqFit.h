@@ -0,0 +1,571 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include "Biquad.h"
+#include "Constants.h"
+#include "Utils.h"
+#include "IIRDesign.h"
+#include "IIRJacobian.h"
+
+// Automatic EQ fitting.
+//
+// FitEq finds gain, Fc and Q for a cascade of PeakEq bands (optionally with a
+// LowShelfQ first and a HighShelfQ last) whose summed dB response best matches
+// a target curve, in the weighted least squares sense, on the given frequency
+// grid.
+//
+// Every start runs Levenberg-Marquardt on (gain dB, ln Fc, ln Q) per band using
+// the analytic derivatives of the band responses, and clamps the parameters to
+// the option bounds after each step. Starts differ in their initial band
+// placement, drawn from seed + start so a fit is reproducible regardless of
+// thread scheduling. The starts run in parallel (OpenMP) and the one with the
+// lowest error wins (ties go to the lowest start index).
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	struct EqFitBand
+	{
+		// PeakEq, LowShelfQ or HighShelfQ.
+		FilterType type = FilterType::PeakEq;
+		T gain = 0;
+		T Fc = 1000;
+		T Q = 1;
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	struct EqFitOptions
+	{
+		// Total band count, shelves included.
+		int bands = 10;
+		bool lowShelf = true;
+		bool highShelf = true;
+
+		T Fs = 48000;
+
+		// Parameter bounds. maxFc is further limited to 0.45 * Fs.
+		T minFc = 20;
+		T maxFc = 20000;
+		T minQ = static_cast<T>(0.2);
+		T maxQ = 10;
+		T maxGainDb = 18;
+
+		int starts = 16;
+		int maxIterations = 100;
+
+		// A start stops once an accepted step lowers the error by less than
+		// this fraction.
+		T tolerance = static_cast<T>(1e-4);
+
+		unsigned seed = 1;
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	struct EqFitResult
+	{
+		std::vector<EqFitBand<T>> bands;
+
+		// Weighted RMS of (fitted - target) in dB.
+		T rmsErrorDb = 0;
+
+		// Levenberg-Marquardt iterations and index of the winning start.
+		int iterations = 0;
+		int start = 0;
+
+		// Coefficients of the fitted bands.
+		std::vector<Biquad<T>> Biquads( T Fs ) const
+		{
+			std::vector<Biquad<T>> biquads;
+			biquads.reserve( bands.size() );
+
+			for (const auto& band : bands)
+			{
+				biquads.push_back( Design( band.type, band.gain, band.Fc, band.Q, Fs ) );
+			}
+
+			return biquads;
+		}
+	};
+
+	namespace Detail
+	{
+		template <typename T>
+		using EqFitPoint = Eval::Detail::ResponsePoint<T>;
+
+		// Coefficient sensitivities of a band and the parameters needed to
+		// chain them to ln Fc and ln Q.
+		template <typename T>
+		struct EqBandTerms
+		{
+			BiquadSensitivity<T> sensitivity;
+			T Fc;
+			T Q;
+		};
+
+		template <typename T>
+		EqBandTerms<T> MakeEqBandTerms( const EqFitBand<T>& band, T Fs )
+		{
+			return { DesignSensitivity( band.type, band.gain, band.Fc, band.Q, Fs ), band.Fc, band.Q };
+		}
+
+		// dB response of a band at one point. When gradient is not null it
+		// receives the derivatives with respect to gain (dB), ln Fc and ln Q.
+		template <typename T>
+		T EqBandResponse( const EqBandTerms<T>& terms, const EqFitPoint<T>& point, T* gradient )
+		{
+			const T scale = 20 / Constants::ln10<T>();
+			T logGradient[SensitivityParameterCount];
+			const T logMagnitude = Eval::Detail::SectionLogMagnitude( terms.sensitivity, point,
+				gradient ? logGradient : static_cast<T*>(nullptr) );
+
+			if (gradient)
+			{
+				gradient[0] = scale * logGradient[0];
+				gradient[1] = scale * logGradient[1] * terms.Fc;
+				gradient[2] = scale * logGradient[2] * terms.Q;
+			}
+
+			return scale * logMagnitude;
+		}
+
+		template <typename T>
+		struct EqFitProblem
+		{
+			std::vector<EqFitPoint<T>> points;
+			std::span<const T> frequencies;
+			std::span<const T> target;
+			std::vector<T> weights;
+			EqFitOptions<T> options;
+			T maxFc;
+		};
+
+		template <typename T>
+		void ClampBand( EqFitBand<T>& band, const EqFitProblem<T>& problem )
+		{
+			const EqFitOptions<T>& options = problem.options;
+			band.gain = std::clamp( band.gain, -options.maxGainDb, options.maxGainDb );
+			band.Fc = std::clamp( band.Fc, options.minFc, problem.maxFc );
+			band.Q = std::clamp( band.Q, options.minQ, options.maxQ );
+		}
+
+		// Normal equations of one start. jacobian is column major (one
+		// column per parameter) and scaled by sqrt(weight), like residuals.
+		template <typename T>
+		struct EqFitWorkspace
+		{
+			std::vector<T> jtj, jtr;
+			std::vector<T> jacobian, residuals;
+		};
+
+		template <typename T>
+		T Dot( const T* x, const T* y, size_t count )
+		{
+			// Four partial sums break the add dependency chain.
+			T sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				sum0 += x[i] * y[i];
+				sum1 += x[i + 1] * y[i + 1];
+				sum2 += x[i + 2] * y[i + 2];
+				sum3 += x[i + 3] * y[i + 3];
+			}
+			for (; i < count; i++)
+			{
+				sum0 += x[i] * y[i];
+			}
+			return (sum0 + sum1) + (sum2 + sum3);
+		}
+
+		// Weighted sum of squared errors; with a workspace also the
+		// Gauss-Newton normal equations (jtj lower triangle, row major).
+		template <typename T>
+		T EqFitCost( const std::vector<EqFitBand<T>>& bands, const EqFitProblem<T>& problem,
+			EqFitWorkspace<T>* workspace )
+		{
+			const size_t count = bands.size();
+			const size_t parameters = 3 * count;
+			const size_t points = problem.points.size();
+
+			std::vector<EqBandTerms<T>> terms( count );
+			for (size_t b = 0; b < count; b++)
+			{
+				terms[b] = MakeEqBandTerms( bands[b], problem.options.Fs );
+			}
+
+			if (workspace)
+			{
+				workspace->jtj.assign( parameters * parameters, T( 0 ) );
+				workspace->jtr.resize( parameters );
+				workspace->jacobian.resize( parameters * points );
+				workspace->residuals.resize( points );
+			}
+
+			T cost = 0;
+
+			for (size_t i = 0; i < points; i++)
+			{
+				T response = 0;
+				T gradient[3];
+				const T root = std::sqrt( problem.weights[i] );
+
+				for (size_t b = 0; b < count; b++)
+				{
+					response += EqBandResponse( terms[b], problem.points[i],
+						workspace ? gradient : static_cast<T*>(nullptr) );
+
+					if (workspace)
+					{
+						for (size_t p = 0; p < 3; p++)
+						{
+							workspace->jacobian[(3 * b + p) * points + i] = root * gradient[p];
+						}
+					}
+				}
+
+				const T residual = response - problem.target[i];
+				cost += problem.weights[i] * residual * residual;
+
+				if (workspace)
+				{
+					workspace->residuals[i] = root * residual;
+				}
+			}
+
+			if (workspace)
+			{
+				const T* jacobian = workspace->jacobian.data();
+				for (size_t p = 0; p < parameters; p++)
+				{
+					workspace->jtr[p] = Dot( jacobian + p * points, workspace->residuals.data(), points );
+					for (size_t q = 0; q <= p; q++)
+					{
+						workspace->jtj[p * parameters + q] =
+							Dot( jacobian + p * points, jacobian + q * points, points );
+					}
+				}
+			}
+
+			return cost;
+		}
+
+		// Solves (A + lambda * diag(A)) x = -g by Cholesky; false if not
+		// positive definite.
+		template <typename T>
+		bool SolveDamped( const std::vector<T>& jtj, const std::vector<T>& jtr, T lambda,
+			std::vector<T>& step )
+		{
+			const size_t n = jtr.size();
+			std::vector<T> factor( n * n );
+
+			for (size_t p = 0; p < n; p++)
+			{
+				for (size_t q = 0; q <= p; q++)
+				{
+					T value = jtj[p * n + q];
+					if (p == q)
+					{
+						value += lambda * value + std::numeric_limits<T>::epsilon();
+					}
+					for (size_t k = 0; k < q; k++)
+					{
+						value -= factor[p * n + k] * factor[q * n + k];
+					}
+
+					if (p == q)
+					{
+						if (!(value > 0))
+						{
+							return false;
+						}
+						factor[p * n + p] = std::sqrt( value );
+					}
+					else
+					{
+						factor[p * n + q] = value / factor[q * n + q];
+					}
+				}
+			}
+
+			for (size_t p = 0; p < n; p++)
+			{
+				T value = -jtr[p];
+				for (size_t k = 0; k < p; k++)
+				{
+					value -= factor[p * n + k] * step[k];
+				}
+				step[p] = value / factor[p * n + p];
+			}
+			for (size_t p = n; p-- > 0;)
+			{
+				T value = step[p];
+				for (size_t k = p + 1; k < n; k++)
+				{
+					value -= factor[k * n + p] * step[k];
+				}
+				step[p] = value / factor[p * n + p];
+			}
+
+			return true;
+		}
+
+		// Greedy placement: shelves take the mean residual beyond their
+		// corner, then each peak band goes to the largest remaining residual.
+		// Start 0 is deterministic; other starts jitter the shelf corners,
+		// weight the residual peaks randomly and draw Q log-uniformly.
+		template <typename T>
+		std::vector<EqFitBand<T>> InitialBands( const EqFitProblem<T>& problem, int start )
+		{
+			const EqFitOptions<T>& options = problem.options;
+			std::mt19937 generator( options.seed + 7919u * static_cast<unsigned>(start) );
+			std::uniform_real_distribution<T> unit( T( 0 ), T( 1 ) );
+			std::uniform_real_distribution<T> logQ( std::log( T( 0.7 ) ), std::log( T( 4 ) ) );
+
+			const size_t count = problem.points.size();
+			std::vector<T> residual( problem.target.begin(), problem.target.end() );
+			std::vector<EqFitBand<T>> bands( options.bands );
+
+			auto subtract = [&]( const EqFitBand<T>& band )
+			{
+				const EqBandTerms<T> terms = MakeEqBandTerms( band, options.Fs );
+				for (size_t i = 0; i < count; i++)
+				{
+					residual[i] -= EqBandResponse( terms, problem.points[i], static_cast<T*>(nullptr) );
+				}
+			};
+
+			auto shelf = [&]( EqFitBand<T>& band, FilterType type, T Fc )
+			{
+				T sum = 0;
+				size_t inside = 0;
+				for (size_t i = 0; i < count; i++)
+				{
+					if ((type == FilterType::LowShelfQ) == (problem.frequencies[i] < Fc))
+					{
+						sum += residual[i];
+						inside++;
+					}
+				}
+
+				band.type = type;
+				band.Fc = Fc;
+				band.Q = Constants::one_over_sqrt2<T>();
+				band.gain = inside ? sum / inside : T( 0 );
+			};
+
+			int first = 0;
+			int last = options.bands;
+			const T spread = start == 0 ? T( 1 ) : std::exp( unit( generator ) - T( 0.5 ) );
+
+			if (options.lowShelf)
+			{
+				shelf( bands[first], FilterType::LowShelfQ, options.minFc * 5 * spread );
+				ClampBand( bands[first], problem );
+				subtract( bands[first++] );
+			}
+			if (options.highShelf)
+			{
+				shelf( bands[--last], FilterType::HighShelfQ, problem.maxFc / 2 / spread );
+				ClampBand( bands[last], problem );
+				subtract( bands[last] );
+			}
+
+			for (int b = first; b < last; b++)
+			{
+				size_t peak = 0;
+				T best = -1;
+				for (size_t i = 0; i < count; i++)
+				{
+					const T score = std::abs( residual[i] ) * problem.weights[i]
+						* (start == 0 ? T( 1 ) : T( 0.5 ) + unit( generator ));
+					if (score > best)
+					{
+						best = score;
+						peak = i;
+					}
+				}
+
+				EqFitBand<T>& band = bands[b];
+				band.Fc = problem.frequencies[peak];
+				band.Q = start == 0 ? T( 2 ) : std::exp( logQ( generator ) );
+				band.gain = residual[peak];
+				ClampBand( band, problem );
+				subtract( band );
+			}
+
+			// Never exactly 0 dB, where the Fc and Q derivatives vanish.
+			for (auto& band : bands)
+			{
+				if (std::abs( band.gain ) < T( 0.1 ))
+				{
+					band.gain = band.gain < 0 ? T( -0.1 ) : T( 0.1 );
+				}
+			}
+
+			return bands;
+		}
+
+		// One Levenberg-Marquardt run.
+		template <typename T>
+		EqFitResult<T> FitEqFromStart( const EqFitProblem<T>& problem, int start )
+		{
+			std::vector<EqFitBand<T>> bands = InitialBands( problem, start );
+			const size_t parameters = 3 * bands.size();
+
+			EqFitWorkspace<T> workspace;
+			std::vector<T> step( parameters );
+			std::vector<EqFitBand<T>> trial;
+
+			T cost = EqFitCost( bands, problem, &workspace );
+			T lambda = T( 1e-3 );
+			int iteration = 0;
+
+			for (; iteration < problem.options.maxIterations; iteration++)
+			{
+				bool accepted = false;
+
+				while (!accepted && lambda < T( 1e10 ))
+				{
+					if (!SolveDamped( workspace.jtj, workspace.jtr, lambda, step ))
+					{
+						lambda *= 4;
+						continue;
+					}
+
+					trial = bands;
+					for (size_t b = 0; b < bands.size(); b++)
+					{
+						trial[b].gain += step[3 * b];
+						trial[b].Fc *= std::exp( std::clamp( step[3 * b + 1], T( -1 ), T( 1 ) ) );
+						trial[b].Q *= std::exp( std::clamp( step[3 * b + 2], T( -1 ), T( 1 ) ) );
+						ClampBand( trial[b], problem );
+					}
+
+					const T trialCost = EqFitCost( trial, problem,
+						static_cast<EqFitWorkspace<T>*>(nullptr) );
+
+					if (trialCost < cost)
+					{
+						accepted = true;
+						const T improvement = (cost - trialCost) / cost;
+						bands.swap( trial );
+						cost = trialCost;
+						lambda = std::max( lambda * T( 0.3 ), T( 1e-9 ) );
+
+						if (improvement < problem.options.tolerance)
+						{
+							lambda = T( 1e10 );
+						}
+					}
+					else
+					{
+						lambda *= 4;
+					}
+				}
+
+				if (!accepted || lambda >= T( 1e10 ))
+				{
+					break;
+				}
+
+				EqFitCost( bands, problem, &workspace );
+			}
+
+			EqFitResult<T> result;
+			result.bands = std::move( bands );
+			result.rmsErrorDb = cost;
+			result.iterations = iteration;
+			result.start = start;
+			return result;
+		}
+	}
+
+	// Fits options.bands bands to targetDb (dB, one value per frequency in
+	// Hz). weights, when not empty, weight the squared error per point.
+	template <typename T> requires std::is_floating_point_v<T>
+	EqFitResult<T> FitEq( std::span<const T> frequencies, std::span<const T> targetDb,
+		const EqFitOptions<T>& options, std::span<const T> weights = {} )
+	{
+		if (frequencies.empty() || frequencies.size() != targetDb.size())
+		{
+			throw std::invalid_argument( "frequencies and targetDb must have the same non zero size." );
+		}
+		if (!weights.empty() && weights.size() != frequencies.size())
+		{
+			throw std::invalid_argument( "weights must be empty or match frequencies." );
+		}
+		if (options.bands < 1 || options.starts < 1
+			|| options.bands < (options.lowShelf ? 1 : 0) + (options.highShelf ? 1 : 0))
+		{
+			throw std::invalid_argument( "Invalid band or start count." );
+		}
+		if (!(options.minFc > 0) || !(options.minFc < options.maxFc)
+			|| !(options.minQ > 0) || !(options.minQ < options.maxQ) || !(options.maxGainDb > 0))
+		{
+			throw std::invalid_argument( "Invalid fit bounds." );
+		}
+
+		Detail::EqFitProblem<T> problem;
+		problem.frequencies = frequencies;
+		problem.target = targetDb;
+		problem.options = options;
+		problem.maxFc = std::min( options.maxFc, options.Fs * static_cast<T>(0.45) );
+
+		if (!(options.minFc < problem.maxFc))
+		{
+			throw std::invalid_argument( "minFc must be below 0.45 * Fs." );
+		}
+
+		T weightSum = 0;
+		problem.points.resize( frequencies.size() );
+		problem.weights.resize( frequencies.size() );
+		for (size_t i = 0; i < frequencies.size(); i++)
+		{
+			if (!(frequencies[i] > 0) || !(frequencies[i] < options.Fs / 2))
+			{
+				throw std::invalid_argument( "frequencies must be in (0, Fs / 2)." );
+			}
+
+			const T omega = Utils::HzToOmega( frequencies[i] ) / options.Fs;
+			problem.points[i] = Eval::Detail::MakeResponsePoint( omega );
+			problem.weights[i] = weights.empty() ? T( 1 ) : weights[i];
+			if (!(problem.weights[i] >= 0) || !std::isfinite( problem.weights[i] ))
+			{
+				throw std::invalid_argument( "weights must be finite and non negative." );
+			}
+			weightSum += problem.weights[i];
+		}
+		if (!(weightSum > 0))
+		{
+			throw std::invalid_argument( "At least one weight must be positive." );
+		}
+
+		std::vector<EqFitResult<T>> results( options.starts );
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int start = 0; start < options.starts; start++)
+		{
+			results[start] = Detail::FitEqFromStart( problem, start );
+		}
+
+		size_t best = 0;
+		for (size_t start = 1; start < results.size(); start++)
+		{
+			if (results[start].rmsErrorDb < results[best].rmsErrorDb)
+			{
+				best = start;
+			}
+		}
+
+		EqFitResult<T> result = std::move( results[best] );
+		result.rmsErrorDb = std::sqrt( result.rmsErrorDb / weightSum );
+		return result;
+	}
+}
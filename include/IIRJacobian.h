@@ -0,0 +1,594 @@
+#pragma once
+
+#include <type_traits>
+#include <array>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <utility>
+#include <stdexcept>
+#include "Biquad.h"
+#include "Constants.h"
+#include "Utils.h"
+#include "FrequencyResponse.h"
+#include "IIRDesign.h"
+
+// Analytic parameter sensitivities.
+//
+// IIR::DesignSensitivity differentiates the closed-form designers of
+// IIRDesignImpl.h: it returns the normalized coefficients together with their
+// partial derivatives with respect to peakGain (dB), Fc (Hz) and Q.
+//
+// Eval::CalcResponseJacobian chains those through the response of
+// Eval::CalcFreqResponseTrig for a cascade of sections over a frequency grid,
+// and returns the dense Jacobian of magnitude and phase: one row per grid
+// point and three columns (peakGain, Fc, Q) per section.
+//
+// Derivatives are exact up to rounding. At an exact zero of the response the
+// magnitude is not differentiable and the result is not finite.
+
+namespace DigitalFilters::IIR
+{
+	// Column order of a section in the Jacobians below.
+	enum class SensitivityParameter
+	{
+		PeakGain = 0,
+		Fc = 1,
+		Q = 2
+	};
+
+	constexpr size_t SensitivityParameterCount = 3;
+
+	// Partial derivative of the normalized coefficients (b0 is constant).
+	template <typename T> requires std::is_floating_point_v<T>
+	struct BiquadPartial
+	{
+		T a0 = 0, a1 = 0, a2 = 0;
+		T b1 = 0, b2 = 0;
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	struct BiquadSensitivity
+	{
+		Biquad<T> biquad;
+
+		// Indexed by SensitivityParameter. Parameters the filter type does not
+		// use have zero partials.
+		std::array<BiquadPartial<T>, SensitivityParameterCount> partials{};
+
+		const BiquadPartial<T>& Partial( SensitivityParameter parameter ) const
+		{
+			return partials[static_cast<size_t>(parameter)];
+		}
+	};
+
+	namespace Detail
+	{
+		// Unnormalized numerator or denominator of a design as a polynomial in
+		// z^-1, with its partial derivatives with respect to the linear gain V,
+		// the frequency variable (K = tan(pi * Fc / Fs) for the bilinear
+		// designs, exp(...) for the one-pole ones) and Q.
+		template <typename T>
+		struct DesignPolynomial
+		{
+			T value[3]{};
+			T dGain[3]{};
+			T dOmega[3]{};
+			T dQ[3]{};
+		};
+
+		// 1 + s K / Q + K^2, 2 (K^2 - 1), 1 - s K / Q + K^2 with s = 1. This is
+		// the denominator of every Q based design.
+		template <typename T>
+		DesignPolynomial<T> ResonatorPolynomial( T K, T Q )
+		{
+			DesignPolynomial<T> p;
+			const T K2 = K * K;
+
+			p.value[0] = 1 + K / Q + K2;
+			p.value[1] = 2 * (K2 - 1);
+			p.value[2] = 1 - K / Q + K2;
+			p.dOmega[0] = 1 / Q + 2 * K;
+			p.dOmega[1] = 4 * K;
+			p.dOmega[2] = -1 / Q + 2 * K;
+			p.dQ[0] = -K / (Q * Q);
+			p.dQ[2] = K / (Q * Q);
+			return p;
+		}
+
+		// Same as ResonatorPolynomial with Q fixed by the design.
+		template <typename T>
+		DesignPolynomial<T> FixedResonatorPolynomial( T K, T Q )
+		{
+			DesignPolynomial<T> p = ResonatorPolynomial( K, Q );
+			p.dQ[0] = p.dQ[2] = 0;
+			return p;
+		}
+
+		// Numerator of HighShelf and HighShelfQ boosts.
+		template <typename T>
+		DesignPolynomial<T> HighShelfPolynomial( T V, T K )
+		{
+			DesignPolynomial<T> p;
+			const T S = std::sqrt( 2 * V );
+			const T K2 = K * K;
+
+			p.value[0] = V + S * K + K2;
+			p.value[1] = 2 * (K2 - V);
+			p.value[2] = V - S * K + K2;
+			p.dGain[0] = 1 + K / S;
+			p.dGain[1] = -2;
+			p.dGain[2] = 1 - K / S;
+			p.dOmega[0] = S + 2 * K;
+			p.dOmega[1] = 4 * K;
+			p.dOmega[2] = -S + 2 * K;
+			return p;
+		}
+
+		// Numerator of LowShelf boosts.
+		template <typename T>
+		DesignPolynomial<T> LowShelfPolynomial( T V, T K )
+		{
+			DesignPolynomial<T> p;
+			const T S = std::sqrt( 2 * V );
+			const T K2 = K * K;
+
+			p.value[0] = 1 + S * K + V * K2;
+			p.value[1] = 2 * (V * K2 - 1);
+			p.value[2] = 1 - S * K + V * K2;
+			p.dGain[0] = K / S + K2;
+			p.dGain[1] = 2 * K2;
+			p.dGain[2] = -K / S + K2;
+			p.dOmega[0] = S + 2 * V * K;
+			p.dOmega[1] = 4 * V * K;
+			p.dOmega[2] = -S + 2 * V * K;
+			return p;
+		}
+
+		// Numerator of LowShelfQ boosts.
+		template <typename T>
+		DesignPolynomial<T> LowShelfQPolynomial( T V, T K, T Q )
+		{
+			DesignPolynomial<T> p;
+			const T A = std::sqrt( V );
+			const T K2 = K * K;
+
+			p.value[0] = 1 + A * K / Q + V * K2;
+			p.value[1] = 2 * (V * K2 - 1);
+			p.value[2] = 1 - A * K / Q + V * K2;
+			p.dGain[0] = K / (2 * A * Q) + K2;
+			p.dGain[1] = 2 * K2;
+			p.dGain[2] = -K / (2 * A * Q) + K2;
+			p.dOmega[0] = A / Q + 2 * V * K;
+			p.dOmega[1] = 4 * V * K;
+			p.dOmega[2] = -A / Q + 2 * V * K;
+			p.dQ[0] = -A * K / (Q * Q);
+			p.dQ[2] = A * K / (Q * Q);
+			return p;
+		}
+
+		// Numerator of PeakEq boosts.
+		template <typename T>
+		DesignPolynomial<T> PeakPolynomial( T V, T K, T Q )
+		{
+			DesignPolynomial<T> p;
+			const T K2 = K * K;
+
+			p.value[0] = 1 + V * K / Q + K2;
+			p.value[1] = 2 * (K2 - 1);
+			p.value[2] = 1 - V * K / Q + K2;
+			p.dGain[0] = K / Q;
+			p.dGain[2] = -K / Q;
+			p.dOmega[0] = V / Q + 2 * K;
+			p.dOmega[1] = 4 * K;
+			p.dOmega[2] = -V / Q + 2 * K;
+			p.dQ[0] = -V * K / (Q * Q);
+			p.dQ[2] = V * K / (Q * Q);
+			return p;
+		}
+
+		// Polynomial with constant coefficients, e.g. the numerator of
+		// HighPass.
+		template <typename T>
+		DesignPolynomial<T> ConstantPolynomial( T c0, T c1, T c2 )
+		{
+			DesignPolynomial<T> p;
+			p.value[0] = c0;
+			p.value[1] = c1;
+			p.value[2] = c2;
+			return p;
+		}
+
+		// First order polynomial with its frequency variable slopes.
+		template <typename T>
+		DesignPolynomial<T> FirstOrderPolynomial( T value0, T value1, T dOmega0, T dOmega1 )
+		{
+			DesignPolynomial<T> p;
+			p.value[0] = value0;
+			p.value[1] = value1;
+			p.dOmega[0] = dOmega0;
+			p.dOmega[1] = dOmega1;
+			return p;
+		}
+
+		template <typename T>
+		struct DesignPolynomials
+		{
+			DesignPolynomial<T> numerator, denominator;
+
+			// Chain factors to the public parameters.
+			T dGainDb = 0;
+			T dOmegaDFc = 0;
+		};
+
+		template <typename T>
+		DesignPolynomials<T> MakeDesignPolynomials( FilterType type, T peakGain, T Fc, T Q, T Fs )
+		{
+			DesignPolynomials<T> design;
+			DesignPolynomial<T>& n = design.numerator;
+			DesignPolynomial<T>& d = design.denominator;
+
+			const T V = DecibelToLinearGain( peakGain );
+			const T K = PrewarpFrequency( Fc, Fs );
+			const bool cut = peakGain < 0;
+
+			// V = 10^(|g| / 20); the boost branch is taken at g = 0.
+			design.dGainDb = (cut ? -1 : 1) * Constants::ln10<T>() / 20 * V;
+			design.dOmegaDFc = Constants::pi<T>() / Fs * (1 + K * K);
+
+			switch (type)
+			{
+			case FilterType::AllPass1stOrder:
+				n = FirstOrderPolynomial( 1 - K, -(1 + K), T( -1 ), T( -1 ) );
+				d = FirstOrderPolynomial( 1 + K, K - 1, T( 1 ), T( 1 ) );
+				break;
+			case FilterType::AllPassQ:
+				d = ResonatorPolynomial( K, Q );
+				for (int k = 0; k < 3; k++)
+				{
+					n.value[k] = d.value[2 - k];
+					n.dOmega[k] = d.dOmega[2 - k];
+					n.dQ[k] = d.dQ[2 - k];
+				}
+				break;
+			case FilterType::BandPass:
+				d = ResonatorPolynomial( K, Q );
+				n.value[0] = K / Q;
+				n.value[2] = -K / Q;
+				n.dOmega[0] = 1 / Q;
+				n.dOmega[2] = -1 / Q;
+				n.dQ[0] = -K / (Q * Q);
+				n.dQ[2] = K / (Q * Q);
+				break;
+			case FilterType::HighPass:
+				d = ResonatorPolynomial( K, Q );
+				n = ConstantPolynomial( T( 1 ), T( -2 ), T( 1 ) );
+				break;
+			case FilterType::HighPass12dbOct:
+				d = FixedResonatorPolynomial( K, one_over_sqrt2<T>() );
+				n = ConstantPolynomial( T( 1 ), T( -2 ), T( 1 ) );
+				break;
+			case FilterType::HighPass1stOrder:
+				d = FirstOrderPolynomial( K + 1, K - 1, T( 1 ), T( 1 ) );
+				n = ConstantPolynomial( T( 1 ), T( -1 ), T( 0 ) );
+				break;
+			case FilterType::HighShelf:
+				n = HighShelfPolynomial( V, K );
+				d = FixedResonatorPolynomial( K, one_over_sqrt2<T>() );
+				break;
+			case FilterType::HighShelf1stOrder:
+				n = FirstOrderPolynomial( K + V, K - V, T( 1 ), T( 1 ) );
+				n.dGain[0] = 1;
+				n.dGain[1] = -1;
+				d = FirstOrderPolynomial( K + 1, K - 1, T( 1 ), T( 1 ) );
+				break;
+			case FilterType::HighShelfQ:
+				n = HighShelfPolynomial( V, K );
+				d = ResonatorPolynomial( K, Q );
+				break;
+			case FilterType::LowPass:
+				d = ResonatorPolynomial( K, Q );
+				n = ConstantPolynomial( K * K, 2 * K * K, K * K );
+				n.dOmega[0] = n.dOmega[2] = 2 * K;
+				n.dOmega[1] = 4 * K;
+				break;
+			case FilterType::LowPass12dbOct:
+				d = FixedResonatorPolynomial( K, one_over_sqrt2<T>() );
+				n = ConstantPolynomial( K * K, 2 * K * K, K * K );
+				n.dOmega[0] = n.dOmega[2] = 2 * K;
+				n.dOmega[1] = 4 * K;
+				break;
+			case FilterType::LowPass1stOrder:
+				// The designer normalizes by 1 / K + 1; scaling by K gives the
+				// same coefficients.
+				n = FirstOrderPolynomial( K, K, T( 1 ), T( 1 ) );
+				d = FirstOrderPolynomial( K + 1, K - 1, T( 1 ), T( 1 ) );
+				break;
+			case FilterType::LowShelf:
+				n = LowShelfPolynomial( V, K );
+				d = FixedResonatorPolynomial( K, one_over_sqrt2<T>() );
+				break;
+			case FilterType::LowShelf1stOrder:
+				n = FirstOrderPolynomial( K * V + 1, K * V - 1, V, V );
+				n.dGain[0] = n.dGain[1] = K;
+				d = FirstOrderPolynomial( K + 1, K - 1, T( 1 ), T( 1 ) );
+				break;
+			case FilterType::LowShelfQ:
+				n = LowShelfQPolynomial( V, K, Q );
+				d = ResonatorPolynomial( K, Q );
+				break;
+			case FilterType::Notch:
+				d = ResonatorPolynomial( K, Q );
+				n = ConstantPolynomial( 1 + K * K, 2 * (K * K - 1), 1 + K * K );
+				n.dOmega[0] = n.dOmega[2] = 2 * K;
+				n.dOmega[1] = 4 * K;
+				break;
+			case FilterType::OnePoleHighPass:
+			{
+				// e = exp(-2 pi (0.5 - Fc / Fs)): a0 = 1 - e, b1 = e.
+				const T e = Exp( -2 * pi<T>() * (T( 0.5 ) - Fc / Fs) );
+				n = FirstOrderPolynomial( 1 - e, T( 0 ), T( -1 ), T( 0 ) );
+				d = FirstOrderPolynomial( T( 1 ), e, T( 0 ), T( 1 ) );
+				design.dOmegaDFc = 2 * pi<T>() / Fs * e;
+				return design;
+			}
+			case FilterType::OnePoleLowPass:
+			{
+				// e = exp(-2 pi Fc / Fs): a0 = 1 - e, b1 = -e.
+				const T e = Exp( -2 * pi<T>() * (Fc / Fs) );
+				n = FirstOrderPolynomial( 1 - e, T( 0 ), T( -1 ), T( 0 ) );
+				d = FirstOrderPolynomial( T( 1 ), -e, T( 0 ), T( -1 ) );
+				design.dOmegaDFc = -2 * pi<T>() / Fs * e;
+				return design;
+			}
+			case FilterType::PeakEq:
+				n = PeakPolynomial( V, K, Q );
+				d = ResonatorPolynomial( K, Q );
+				break;
+			default:
+				throw std::invalid_argument( "Unknown filter type." );
+			}
+
+			// The shelving and peaking cuts are the inverse of the boost with
+			// the same |gain|.
+			if (cut && UsesGain( type ))
+			{
+				std::swap( n, d );
+			}
+
+			return design;
+		}
+	}
+
+	// Designs a filter like Design and differentiates its normalized
+	// coefficients with respect to peakGain (dB), Fc (Hz) and Q.
+	template <typename T> requires std::is_floating_point_v<T>
+	BiquadSensitivity<T> DesignSensitivity( FilterType type, T peakGain, T Fc, T Q, T Fs )
+	{
+		const Detail::DesignPolynomials<T> design =
+			Detail::MakeDesignPolynomials( type, peakGain, Fc, Q, Fs );
+		const Detail::DesignPolynomial<T>& n = design.numerator;
+		const Detail::DesignPolynomial<T>& d = design.denominator;
+
+		const T norm = 1 / d.value[0];
+		T a[3], b[3];
+		for (int k = 0; k < 3; k++)
+		{
+			a[k] = n.value[k] * norm;
+			b[k] = d.value[k] * norm;
+		}
+
+		BiquadSensitivity<T> sensitivity;
+		sensitivity.biquad = Biquad<T>( a[0], a[1], a[2], b[1], b[2] );
+
+		for (size_t p = 0; p < SensitivityParameterCount; p++)
+		{
+			// Partials of the unnormalized polynomials for this parameter.
+			T dn[3], dd[3];
+			for (int k = 0; k < 3; k++)
+			{
+				switch (static_cast<SensitivityParameter>(p))
+				{
+				case SensitivityParameter::PeakGain:
+					dn[k] = n.dGain[k] * design.dGainDb;
+					dd[k] = d.dGain[k] * design.dGainDb;
+					break;
+				case SensitivityParameter::Fc:
+					dn[k] = n.dOmega[k] * design.dOmegaDFc;
+					dd[k] = d.dOmega[k] * design.dOmegaDFc;
+					break;
+				default:
+					dn[k] = n.dQ[k];
+					dd[k] = d.dQ[k];
+					break;
+				}
+			}
+
+			// d(x / d0) = (dx - (x / d0) dd0) / d0
+			BiquadPartial<T>& partial = sensitivity.partials[p];
+			partial.a0 = (dn[0] - a[0] * dd[0]) * norm;
+			partial.a1 = (dn[1] - a[1] * dd[0]) * norm;
+			partial.a2 = (dn[2] - a[2] * dd[0]) * norm;
+			partial.b1 = (dd[1] - b[1] * dd[0]) * norm;
+			partial.b2 = (dd[2] - b[2] * dd[0]) * norm;
+		}
+
+		return sensitivity;
+	}
+}
+
+namespace DigitalFilters::Eval
+{
+	enum class MagnitudeScale
+	{
+		Linear,
+		Decibels
+	};
+
+	// Response of a cascade on a grid with its derivatives. The Jacobians are
+	// row major: row i is omegas[i], column 3 * s + p is parameter p
+	// (IIR::SensitivityParameter) of section s.
+	template <typename T> requires std::is_floating_point_v<T>
+	struct ResponseJacobian
+	{
+		size_t rows = 0;
+		size_t columns = 0;
+
+		// |H| (or dB, per MagnitudeScale) and phase in radians. The phase is
+		// the sum of the section phases and is not wrapped.
+		std::vector<T> magnitude;
+		std::vector<T> phase;
+
+		std::vector<T> magnitudeJacobian;
+		std::vector<T> phaseJacobian;
+
+		T MagnitudeDerivative( size_t row, size_t column ) const
+		{
+			return magnitudeJacobian[row * columns + column];
+		}
+
+		T PhaseDerivative( size_t row, size_t column ) const
+		{
+			return phaseJacobian[row * columns + column];
+		}
+	};
+
+	namespace Detail
+	{
+		// cos / sin of w and 2w for one grid point.
+		template <typename T>
+		struct ResponsePoint
+		{
+			T c1, s1, c2, s2;
+		};
+
+		template <typename T>
+		ResponsePoint<T> MakeResponsePoint( T omega )
+		{
+			return { std::cos( omega ), std::sin( omega ),
+				std::cos( 2 * omega ), std::sin( 2 * omega ) };
+		}
+
+		// ln|H| of one section at one point, as in CalcFreqResponseTrig. The
+		// optional outputs receive the phase and the derivatives of ln|H| and
+		// of the phase per SensitivityParameter.
+		template <typename T>
+		T SectionLogMagnitude( const IIR::BiquadSensitivity<T>& section,
+			const ResponsePoint<T>& point, T* logMagnitudeGradient,
+			T* phase = nullptr, T* phaseGradient = nullptr )
+		{
+			const Biquad<T>& biquad = section.biquad;
+			const T nRe = biquad.a0 + biquad.a1 * point.c1 + biquad.a2 * point.c2;
+			const T nIm = -(biquad.a1 * point.s1 + biquad.a2 * point.s2);
+			const T dRe = biquad.b0 + biquad.b1 * point.c1 + biquad.b2 * point.c2;
+			const T dIm = -(biquad.b1 * point.s1 + biquad.b2 * point.s2);
+
+			const T nNorm = nRe * nRe + nIm * nIm;
+			const T dNorm = dRe * dRe + dIm * dIm;
+
+			if (phase)
+			{
+				*phase = std::atan2( nIm * dRe - nRe * dIm, nRe * dRe + nIm * dIm );
+			}
+
+			const T logMagnitude = T( 0.5 ) * std::log( nNorm / dNorm );
+
+			if (!logMagnitudeGradient && !phaseGradient)
+			{
+				return logMagnitude;
+			}
+
+			for (size_t p = 0; p < IIR::SensitivityParameterCount; p++)
+			{
+				const IIR::BiquadPartial<T>& partial = section.partials[p];
+				const T dnRe = partial.a0 + partial.a1 * point.c1 + partial.a2 * point.c2;
+				const T dnIm = -(partial.a1 * point.s1 + partial.a2 * point.s2);
+				const T ddRe = partial.b1 * point.c1 + partial.b2 * point.c2;
+				const T ddIm = -(partial.b1 * point.s1 + partial.b2 * point.s2);
+
+				// d ln H = dN / N - dD / D; ln|H| is its real part and the
+				// phase its imaginary part.
+				if (logMagnitudeGradient)
+				{
+					logMagnitudeGradient[p] = (nRe * dnRe + nIm * dnIm) / nNorm
+						- (dRe * ddRe + dIm * ddIm) / dNorm;
+				}
+
+				if (phaseGradient)
+				{
+					phaseGradient[p] = (nRe * dnIm - nIm * dnRe) / nNorm
+						- (dRe * ddIm - dIm * ddRe) / dNorm;
+				}
+			}
+
+			return logMagnitude;
+		}
+	}
+
+	// Evaluates a cascade of sections at each omega (radians per sample) and
+	// the derivatives of its magnitude and phase with respect to the design
+	// parameters of every section.
+	template <typename T> requires std::is_floating_point_v<T>
+	ResponseJacobian<T> CalcResponseJacobian(
+		std::span<const IIR::BiquadSensitivity<T>> sections,
+		std::span<const T> omegas,
+		MagnitudeScale scale = MagnitudeScale::Linear )
+	{
+		constexpr size_t parameters = IIR::SensitivityParameterCount;
+
+		ResponseJacobian<T> jacobian;
+		jacobian.rows = omegas.size();
+		jacobian.columns = parameters * sections.size();
+		jacobian.magnitude.resize( jacobian.rows );
+		jacobian.phase.resize( jacobian.rows );
+		jacobian.magnitudeJacobian.resize( jacobian.rows * jacobian.columns );
+		jacobian.phaseJacobian.resize( jacobian.rows * jacobian.columns );
+
+		const T decibels = 20 / Constants::ln10<T>();
+
+		for (size_t i = 0; i < jacobian.rows; i++)
+		{
+			const Detail::ResponsePoint<T> point = Detail::MakeResponsePoint( omegas[i] );
+			T* magnitudeRow = jacobian.magnitudeJacobian.data() + i * jacobian.columns;
+			T* phaseRow = jacobian.phaseJacobian.data() + i * jacobian.columns;
+
+			T logMagnitude = 0;
+			T phase = 0;
+
+			for (size_t s = 0; s < sections.size(); s++)
+			{
+				T sectionPhase;
+				logMagnitude += Detail::SectionLogMagnitude( sections[s], point,
+					magnitudeRow + parameters * s, &sectionPhase, phaseRow + parameters * s );
+				phase += sectionPhase;
+			}
+
+			// The row holds d ln|H|; |H| only depends on a section through
+			// that section's factor.
+			const T factor = scale == MagnitudeScale::Decibels ?
+				decibels : std::exp( logMagnitude );
+
+			for (size_t c = 0; c < jacobian.columns; c++)
+			{
+				magnitudeRow[c] *= factor;
+			}
+
+			jacobian.magnitude[i] = scale == MagnitudeScale::Decibels ?
+				decibels * logMagnitude : std::exp( logMagnitude );
+			jacobian.phase[i] = phase;
+		}
+
+		return jacobian;
+	}
+
+	// Single filter convenience overload.
+	template <typename T> requires std::is_floating_point_v<T>
+	ResponseJacobian<T> CalcResponseJacobian(
+		const IIR::BiquadSensitivity<T>& section,
+		std::span<const T> omegas,
+		MagnitudeScale scale = MagnitudeScale::Linear )
+	{
+		return CalcResponseJacobian( std::span<const IIR::BiquadSensitivity<T>>( &section, 1 ),
+			omegas, scale );
+	}
+}
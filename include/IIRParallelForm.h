@@ -0,0 +1,361 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include "Biquad.h"
+#include "Instrumentation.h"
+
+// Cascade to parallel form conversion.
+//
+// A cascade H(z) = prod_k Nk(z) / Dk(z) is rewritten as the partial fraction
+// sum
+//
+//     H(z) = sum_k (c0k + c1k z^-1) / Dk(z)  +  sum_j fj z^-j
+//
+// where every branch keeps the denominator Dk of section k and the FIR direct
+// term only appears when the numerator degree reaches the denominator degree.
+// Residues are evaluated in long double from the section poles, the FIR term
+// comes from dividing the expanded numerator by the expanded denominator.
+//
+// Partial fractions need distinct poles: cascades with repeated poles (e.g.
+// Linkwitz-Riley, two identical sections or critically damped sections) are
+// rejected.
+//
+// ParallelProcessor runs the branches side by side in transposed direct
+// form II; the branch loop has no dependency between iterations, so it is
+// vectorized across branches (#pragma omp simd).
+
+namespace DigitalFilters::IIR
+{
+	template <typename T> requires std::is_floating_point_v<T>
+	struct ParallelForm
+	{
+		// Branches (c0 + c1 z^-1) / (1 + d1 z^-1 + d2 z^-2), structure of
+		// arrays. First order branches have c1 = d2 = 0.
+		std::vector<T> c0, c1, d1, d2;
+
+		// Direct term f0 + f1 z^-1 + ..., empty when there is none.
+		std::vector<T> fir;
+
+		size_t Branches() const { return c0.size(); }
+
+		// H(e^jw) of the parallel form.
+		std::complex<T> Response( T omega ) const
+		{
+			const std::complex<T> z1 = std::polar( T( 1 ), -omega );
+			const std::complex<T> z2 = z1 * z1;
+			std::complex<T> sum = 0;
+
+			for (size_t k = 0; k < Branches(); k++)
+			{
+				sum += (c0[k] + c1[k] * z1) / (T( 1 ) + d1[k] * z1 + d2[k] * z2);
+			}
+
+			std::complex<T> delay = 1;
+			for (T f : fir)
+			{
+				sum += f * delay;
+				delay *= z1;
+			}
+
+			return sum;
+		}
+	};
+
+	namespace Detail
+	{
+		using ParallelWork = long double;
+		using ParallelComplex = std::complex<ParallelWork>;
+
+		// Polynomial in z^-1, lowest power first, trailing zeros removed.
+		inline std::vector<ParallelWork> TrimPolynomial( std::vector<ParallelWork> p )
+		{
+			while (p.size() > 1 && p.back() == 0)
+			{
+				p.pop_back();
+			}
+			return p;
+		}
+
+		inline std::vector<ParallelWork> MultiplyPolynomials(
+			const std::vector<ParallelWork>& x, const std::vector<ParallelWork>& y )
+		{
+			std::vector<ParallelWork> product( x.size() + y.size() - 1, 0 );
+			for (size_t i = 0; i < x.size(); i++)
+			{
+				for (size_t j = 0; j < y.size(); j++)
+				{
+					product[i + j] += x[i] * y[j];
+				}
+			}
+			return product;
+		}
+
+		// Polynomial part of numerator / denominator, dividing from the
+		// highest power of z^-1 (the proper remainder is not needed: its
+		// partial fractions share the residues of the full ratio).
+		inline std::vector<ParallelWork> PolynomialQuotient(
+			std::vector<ParallelWork> numerator, const std::vector<ParallelWork>& denominator )
+		{
+			if (numerator.size() < denominator.size())
+			{
+				return {};
+			}
+
+			const size_t degree = denominator.size() - 1;
+			std::vector<ParallelWork> quotient( numerator.size() - degree, 0 );
+
+			for (size_t k = numerator.size(); k-- > degree; )
+			{
+				const ParallelWork factor = numerator[k] / denominator[degree];
+				quotient[k - degree] = factor;
+				for (size_t j = 0; j <= degree; j++)
+				{
+					numerator[k - degree + j] -= factor * denominator[j];
+				}
+			}
+
+			return quotient;
+		}
+
+		// Value of c0 + c1 z^-1 + c2 z^-2 at z.
+		inline ParallelComplex EvaluateSection( ParallelWork c0, ParallelWork c1, ParallelWork c2,
+			const ParallelComplex& z )
+		{
+			const ParallelComplex inverse = ParallelWork( 1 ) / z;
+			return c0 + inverse * (c1 + inverse * c2);
+		}
+
+		struct SectionPoles
+		{
+			ParallelComplex p, q;
+			int count = 0;
+		};
+
+		// Poles of 1 + b1 z^-1 + b2 z^-2, i.e. roots of z^2 + b1 z + b2
+		// without the trivial ones at the origin.
+		inline SectionPoles PolesOf( ParallelWork b1, ParallelWork b2 )
+		{
+			SectionPoles poles;
+
+			if (b2 != 0)
+			{
+				const ParallelComplex root = std::sqrt( ParallelComplex( b1 * b1 - 4 * b2 ) );
+				poles.p = (-b1 + root) / ParallelWork( 2 );
+				poles.q = (-b1 - root) / ParallelWork( 2 );
+				poles.count = 2;
+			}
+			else if (b1 != 0)
+			{
+				poles.p = -b1;
+				poles.count = 1;
+			}
+
+			return poles;
+		}
+	}
+
+	// Converts a cascade of biquads (b0 = 1) to parallel form. Throws
+	// std::invalid_argument when two poles coincide (relative distance below
+	// poleTolerance).
+	template <typename T> requires std::is_floating_point_v<T>
+	ParallelForm<T> ToParallelForm( std::span<const Biquad<T>> cascade, T poleTolerance = T( 1e-6 ) )
+	{
+		using Detail::ParallelWork;
+		using Detail::ParallelComplex;
+
+		const size_t count = cascade.size();
+		std::vector<ParallelWork> a( count * 3 ), b( count * 3 );
+		std::vector<Detail::SectionPoles> poles( count );
+
+		for (size_t k = 0; k < count; k++)
+		{
+			const Biquad<T>& section = cascade[k];
+			if (section.b0 != 1)
+			{
+				throw std::invalid_argument( "Sections must be normalized (b0 = 1)." );
+			}
+
+			a[3 * k] = section.a0;
+			a[3 * k + 1] = section.a1;
+			a[3 * k + 2] = section.a2;
+			b[3 * k] = 1;
+			b[3 * k + 1] = section.b1;
+			b[3 * k + 2] = section.b2;
+			poles[k] = Detail::PolesOf( b[3 * k + 1], b[3 * k + 2] );
+		}
+
+		// Distinct poles check.
+		std::vector<ParallelComplex> all;
+		for (const auto& sectionPoles : poles)
+		{
+			if (sectionPoles.count > 0) all.push_back( sectionPoles.p );
+			if (sectionPoles.count > 1) all.push_back( sectionPoles.q );
+		}
+		for (size_t i = 0; i < all.size(); i++)
+		{
+			for (size_t j = i + 1; j < all.size(); j++)
+			{
+				const ParallelWork scale = std::max<ParallelWork>( 1, std::abs( all[i] ) );
+				if (std::abs( all[i] - all[j] ) < poleTolerance * scale)
+				{
+					throw std::invalid_argument( "Parallel form requires distinct poles." );
+				}
+			}
+		}
+
+		// Residue of H at pole p of section k: (1 - p z^-1) H(z) at z = p.
+		auto residue = [&]( size_t k, const ParallelComplex& p, const ParallelComplex* other )
+		{
+			ParallelComplex value = 1;
+			for (size_t j = 0; j < count; j++)
+			{
+				value *= Detail::EvaluateSection( a[3 * j], a[3 * j + 1], a[3 * j + 2], p );
+				if (j != k)
+				{
+					value /= Detail::EvaluateSection( b[3 * j], b[3 * j + 1], b[3 * j + 2], p );
+				}
+			}
+			if (other)
+			{
+				value /= ParallelWork( 1 ) - *other / p;
+			}
+			return value;
+		};
+
+		ParallelForm<T> form;
+
+		for (size_t k = 0; k < count; k++)
+		{
+			const Detail::SectionPoles& sectionPoles = poles[k];
+			if (sectionPoles.count == 0)
+			{
+				continue;
+			}
+
+			ParallelWork c0, c1;
+
+			if (sectionPoles.count == 1)
+			{
+				c0 = residue( k, sectionPoles.p, nullptr ).real();
+				c1 = 0;
+			}
+			else
+			{
+				// rp / (1 - p z^-1) + rq / (1 - q z^-1) over Dk.
+				const ParallelComplex rp = residue( k, sectionPoles.p, &sectionPoles.q );
+				const ParallelComplex rq = residue( k, sectionPoles.q, &sectionPoles.p );
+				c0 = (rp + rq).real();
+				c1 = -(rp * sectionPoles.q + rq * sectionPoles.p).real();
+			}
+
+			form.c0.push_back( static_cast<T>(c0) );
+			form.c1.push_back( static_cast<T>(c1) );
+			form.d1.push_back( static_cast<T>(b[3 * k + 1]) );
+			form.d2.push_back( static_cast<T>(b[3 * k + 2]) );
+		}
+
+		std::vector<ParallelWork> numerator{ 1 }, denominator{ 1 };
+		for (size_t k = 0; k < count; k++)
+		{
+			numerator = Detail::MultiplyPolynomials( numerator,
+				{ a[3 * k], a[3 * k + 1], a[3 * k + 2] } );
+			denominator = Detail::MultiplyPolynomials( denominator,
+				{ b[3 * k], b[3 * k + 1], b[3 * k + 2] } );
+		}
+
+		for (ParallelWork f : Detail::PolynomialQuotient(
+			Detail::TrimPolynomial( numerator ), Detail::TrimPolynomial( denominator ) ))
+		{
+			form.fir.push_back( static_cast<T>(f) );
+		}
+
+		return form;
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class ParallelProcessor
+	{
+	public:
+
+		explicit ParallelProcessor( ParallelForm<T> form )
+			: form( std::move( form ) ),
+			s1( this->form.Branches(), T( 0 ) ),
+			s2( this->form.Branches(), T( 0 ) ),
+			history( this->form.fir.size(), T( 0 ) )
+		{
+		}
+
+		const ParallelForm<T>& Form() const { return form; }
+
+		void Reset()
+		{
+			std::fill( s1.begin(), s1.end(), T( 0 ) );
+			std::fill( s2.begin(), s2.end(), T( 0 ) );
+			std::fill( history.begin(), history.end(), T( 0 ) );
+		}
+
+		T Process( T x )
+		{
+			const size_t branches = form.Branches();
+			const T* c0 = form.c0.data();
+			const T* c1 = form.c1.data();
+			const T* d1 = form.d1.data();
+			const T* d2 = form.d2.data();
+			T* state1 = s1.data();
+			T* state2 = s2.data();
+
+			T sum = 0;
+
+			#pragma omp simd reduction(+:sum)
+			for (size_t k = 0; k < branches; k++)
+			{
+				const T y = c0[k] * x + state1[k];
+				state1[k] = c1[k] * x - d1[k] * y + state2[k];
+				state2[k] = -d2[k] * y;
+				sum += y;
+			}
+
+			// FIR direct term; history[0] is the current input.
+			if (!history.empty())
+			{
+				std::copy_backward( history.begin(), history.end() - 1, history.end() );
+				history[0] = x;
+				for (size_t j = 0; j < history.size(); j++)
+				{
+					sum += form.fir[j] * history[j];
+				}
+			}
+
+			return sum;
+		}
+
+		// input and output may be the same buffer.
+		void Process( std::span<const T> input, std::span<T> output )
+		{
+			if (input.size() != output.size())
+			{
+				throw std::invalid_argument( "input and output must have the same size." );
+			}
+
+			DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::ParallelFormProcess, input.size(), 0 );
+
+			for (size_t i = 0; i < input.size(); i++)
+			{
+				output[i] = Process( input[i] );
+			}
+		}
+
+	private:
+
+		ParallelForm<T> form;
+		std::vector<T> s1, s2;
+		std::vector<T> history;
+	};
+}
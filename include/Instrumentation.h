@@ -0,0 +1,314 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "Parallel.h"
+
+// Opt-in instrumentation of the library hot paths.
+//
+// Define DIGITALFILTERS_INSTRUMENTATION (for the library and for the code
+// including the headers) to count, per kernel: calls, points evaluated, wall
+// time, per thread busy time of the parallel loops (and their imbalance) and
+// bytes allocated for results. Without it the DIGITALFILTERS_INSTRUMENT_*
+// macros expand to nothing and their arguments are not evaluated, so the
+// instrumented functions compile to the same code as before.
+//
+// Counters are global relaxed atomics, read with TakeSnapshot(). A Sink set with
+// SetSink receives one CallRecord per instrumented call, on the calling
+// thread, after the call completes. The counters and the sink live in
+// DigitalFiltersLib (Instrumentation.cpp), so a DLL build and the
+// application share them.
+//
+// Kernels use the macros as
+//
+//     DIGITALFILTERS_INSTRUMENT_CALL( call, Kernel::FrequencyResponse, points, bytes );
+//     Parallel::For( points, options, [&]( size_t begin, size_t end )
+//     {
+//         DIGITALFILTERS_INSTRUMENT_THREAD( call );
+//         for (...)
+//     } );
+//
+// (the busy time of every chunk is added to the thread running it).
+
+namespace DigitalFilters::Instrumentation
+{
+#if defined(DIGITALFILTERS_INSTRUMENTATION)
+	constexpr bool Enabled = true;
+#else
+	constexpr bool Enabled = false;
+#endif
+
+	enum class Kernel : int
+	{
+		EvalBicuad,
+		EvalBicuadTrig,
+		FrequencyResponse,
+		FrequencyResponseTrig,
+		CascadeProcess,
+		FixedCascadeProcess,
+		ParallelFormProcess,
+		EqBankProcess,
+		CrossoverProcess,
+		GoertzelProcess,
+		Count
+	};
+
+	constexpr size_t KernelCount = static_cast<size_t>(Kernel::Count);
+
+	constexpr const char* KernelName( Kernel kernel )
+	{
+		constexpr const char* names[KernelCount] = {
+			"EvalBicuad", "EvalBicuadTrig", "FrequencyResponse", "FrequencyResponseTrig",
+			"CascadeProcess", "FixedCascadeProcess", "ParallelFormProcess", "EqBankProcess",
+			"CrossoverProcess", "GoertzelProcess" };
+		return kernel < Kernel::Count ? names[static_cast<int>(kernel)] : "Unknown";
+	}
+
+	// One instrumented call.
+	struct CallRecord
+	{
+		Kernel kernel = Kernel::Count;
+		uint64_t points = 0;
+		uint64_t bytesAllocated = 0;
+		uint64_t wallNanoseconds = 0;
+
+		// Parallel loops only (threads = 0 otherwise): busy time summed over
+		// threads and of the slowest thread.
+		uint32_t threads = 0;
+		uint64_t threadNanoseconds = 0;
+		uint64_t maxThreadNanoseconds = 0;
+	};
+
+	// Totals of one kernel.
+	struct KernelStats
+	{
+		uint64_t calls = 0;
+		uint64_t points = 0;
+		uint64_t bytesAllocated = 0;
+		uint64_t wallNanoseconds = 0;
+
+		uint64_t parallelCalls = 0;
+		uint64_t threadNanoseconds = 0;
+
+		// Sums over the parallel calls of the slowest and of the mean thread
+		// busy time.
+		uint64_t maxThreadNanoseconds = 0;
+		uint64_t meanThreadNanoseconds = 0;
+
+		double NanosecondsPerPoint() const
+		{
+			return points > 0 ? static_cast<double>(wallNanoseconds) / points : 0;
+		}
+
+		// Slowest / mean thread time of the parallel loops: 1 is perfectly
+		// balanced, 0 when there was no parallel call.
+		double Imbalance() const
+		{
+			return meanThreadNanoseconds > 0
+				? static_cast<double>(maxThreadNanoseconds) / meanThreadNanoseconds : 0;
+		}
+	};
+
+	using Snapshot = std::array<KernelStats, KernelCount>;
+
+	class Sink
+	{
+	public:
+
+		virtual ~Sink() = default;
+		virtual void Record( const CallRecord& record ) = 0;
+	};
+
+	namespace Detail
+	{
+		struct KernelCounters
+		{
+			std::atomic<uint64_t> calls{ 0 };
+			std::atomic<uint64_t> points{ 0 };
+			std::atomic<uint64_t> bytesAllocated{ 0 };
+			std::atomic<uint64_t> wallNanoseconds{ 0 };
+			std::atomic<uint64_t> parallelCalls{ 0 };
+			std::atomic<uint64_t> threadNanoseconds{ 0 };
+			std::atomic<uint64_t> maxThreadNanoseconds{ 0 };
+			std::atomic<uint64_t> meanThreadNanoseconds{ 0 };
+		};
+
+		// One set of counters and one sink per process, defined in the
+		// library rather than inline here: each module including this header
+		// would otherwise get its own copy.
+		DIGITALFILTERS_MODULE_LIB std::array<KernelCounters, KernelCount>& Counters();
+		DIGITALFILTERS_MODULE_LIB std::atomic<Sink*>& SinkSlot();
+
+		inline uint64_t Now()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		inline void Add( std::atomic<uint64_t>& counter, uint64_t value )
+		{
+			counter.fetch_add( value, std::memory_order_relaxed );
+		}
+
+		inline void Record( const CallRecord& record )
+		{
+			KernelCounters& c = Counters()[static_cast<size_t>(record.kernel)];
+			Add( c.calls, 1 );
+			Add( c.points, record.points );
+			Add( c.bytesAllocated, record.bytesAllocated );
+			Add( c.wallNanoseconds, record.wallNanoseconds );
+
+			if (record.threads > 0)
+			{
+				Add( c.parallelCalls, 1 );
+				Add( c.threadNanoseconds, record.threadNanoseconds );
+				Add( c.maxThreadNanoseconds, record.maxThreadNanoseconds );
+				Add( c.meanThreadNanoseconds, record.threadNanoseconds / record.threads );
+			}
+
+			if (Sink* current = SinkSlot().load( std::memory_order_acquire ))
+			{
+				current->Record( record );
+			}
+		}
+	}
+
+	// Replaces the sink (nullptr removes it). The sink must outlive the
+	// instrumented calls running while it is set.
+	inline void SetSink( Sink* sink )
+	{
+		Detail::SinkSlot().store( sink, std::memory_order_release );
+	}
+
+	inline KernelStats Stats( Kernel kernel )
+	{
+		const Detail::KernelCounters& c = Detail::Counters()[static_cast<size_t>(kernel)];
+		KernelStats stats;
+		stats.calls = c.calls.load( std::memory_order_relaxed );
+		stats.points = c.points.load( std::memory_order_relaxed );
+		stats.bytesAllocated = c.bytesAllocated.load( std::memory_order_relaxed );
+		stats.wallNanoseconds = c.wallNanoseconds.load( std::memory_order_relaxed );
+		stats.parallelCalls = c.parallelCalls.load( std::memory_order_relaxed );
+		stats.threadNanoseconds = c.threadNanoseconds.load( std::memory_order_relaxed );
+		stats.maxThreadNanoseconds = c.maxThreadNanoseconds.load( std::memory_order_relaxed );
+		stats.meanThreadNanoseconds = c.meanThreadNanoseconds.load( std::memory_order_relaxed );
+		return stats;
+	}
+
+	// Totals of every kernel (all zero when instrumentation is compiled out).
+	inline Snapshot TakeSnapshot()
+	{
+		Snapshot snapshot;
+		for (size_t k = 0; k < KernelCount; k++)
+		{
+			snapshot[k] = Stats( static_cast<Kernel>(k) );
+		}
+		return snapshot;
+	}
+
+	inline void Reset()
+	{
+		for (Detail::KernelCounters& c : Detail::Counters())
+		{
+			for (std::atomic<uint64_t>* counter : { &c.calls, &c.points, &c.bytesAllocated,
+				&c.wallNanoseconds, &c.parallelCalls, &c.threadNanoseconds,
+				&c.maxThreadNanoseconds, &c.meanThreadNanoseconds })
+			{
+				counter->store( 0, std::memory_order_relaxed );
+			}
+		}
+	}
+
+	// Times one call; records it when destroyed.
+	class CallScope
+	{
+	public:
+
+		// Busy time of up to MaxThreads threads is tracked separately.
+		static constexpr size_t MaxThreads = 256;
+
+		CallScope( Kernel kernel, uint64_t points, uint64_t bytesAllocated = 0 )
+			: start( Detail::Now() )
+		{
+			record.kernel = kernel;
+			record.points = points;
+			record.bytesAllocated = bytesAllocated;
+		}
+
+		CallScope( const CallScope& ) = delete;
+		CallScope& operator=( const CallScope& ) = delete;
+
+		~CallScope()
+		{
+			record.wallNanoseconds = Detail::Now() - start;
+
+			for (size_t t = 0; t < MaxThreads; t++)
+			{
+				const uint64_t busy = threadBusy[t].load( std::memory_order_relaxed );
+				if (busy > 0)
+				{
+					record.threads++;
+					record.threadNanoseconds += busy;
+					record.maxThreadNanoseconds = std::max( record.maxThreadNanoseconds, busy );
+				}
+			}
+
+			Detail::Record( record );
+		}
+
+		void AddThreadTime( size_t thread, uint64_t nanoseconds )
+		{
+			threadBusy[thread % MaxThreads].fetch_add( std::max<uint64_t>( nanoseconds, 1 ),
+				std::memory_order_relaxed );
+		}
+
+	private:
+
+		CallRecord record;
+		uint64_t start;
+		std::array<std::atomic<uint64_t>, MaxThreads> threadBusy{};
+	};
+
+	// Times the calling thread inside a parallel region of a CallScope.
+	class ThreadScope
+	{
+	public:
+
+		explicit ThreadScope( CallScope& call )
+			: call( call ), start( Detail::Now() )
+		{
+		}
+
+		ThreadScope( const ThreadScope& ) = delete;
+		ThreadScope& operator=( const ThreadScope& ) = delete;
+
+		~ThreadScope()
+		{
+			call.AddThreadTime( ThreadIndex(), Detail::Now() - start );
+		}
+
+	private:
+
+		static size_t ThreadIndex()
+		{
+			return Parallel::WorkerIndex();
+		}
+
+		CallScope& call;
+		uint64_t start;
+	};
+}
+
+#if defined(DIGITALFILTERS_INSTRUMENTATION)
+#define DIGITALFILTERS_INSTRUMENT_CALL( name, kernel, points, bytes ) \
+	::DigitalFilters::Instrumentation::CallScope name( \
+		::DigitalFilters::Instrumentation::kernel, static_cast<uint64_t>(points), static_cast<uint64_t>(bytes) )
+#define DIGITALFILTERS_INSTRUMENT_THREAD( name ) \
+	::DigitalFilters::Instrumentation::ThreadScope name##Thread( name )
+#else
+#define DIGITALFILTERS_INSTRUMENT_CALL( name, kernel, points, bytes )
+#define DIGITALFILTERS_INSTRUMENT_THREAD( name )
+#endif
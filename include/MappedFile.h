@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <filesystem>
+#include <system_error>
+#include <stdexcept>
+#include "../DigitalFiltersLib/DigitalFiltersModuleExport.h"
+
+// Memory mapped files.
+//
+// A MappedFile is an open file; Map( offset, length ) maps a window of it
+// as a MappedView, so a file larger than the address space budget can be
+// written or read one window at a time. Views of a read-write file write
+// through to the file (Flush() forces it); views of a read-only file are
+// read-only. System errors throw std::system_error.
+//
+// The system calls are in DigitalFiltersLib (MappedFile.cpp), so the OS
+// headers stay out of this one; programs using it link the library.
+
+namespace DigitalFilters
+{
+	namespace Detail
+	{
+		// A file descriptor, or a HANDLE on Windows.
+		using FileHandle = intptr_t;
+		constexpr FileHandle InvalidFileHandle = -1;
+
+		// Opens (create: creates or truncates) path and stores its size.
+		DIGITALFILTERS_MODULE_LIB FileHandle OpenFile( const std::filesystem::path& path, bool writable,
+			bool create, uint64_t& size );
+		DIGITALFILTERS_MODULE_LIB void ResizeFile( FileHandle handle, uint64_t size );
+		DIGITALFILTERS_MODULE_LIB void CloseFile( FileHandle handle );
+
+		// Maps length bytes from start, a multiple of MapGranularity().
+		DIGITALFILTERS_MODULE_LIB void* MapFile( FileHandle handle, bool writable, uint64_t start, size_t length );
+		DIGITALFILTERS_MODULE_LIB void FlushMapping( void* base, size_t length );
+		DIGITALFILTERS_MODULE_LIB void UnmapFile( void* base, size_t length );
+		DIGITALFILTERS_MODULE_LIB uint64_t MapGranularity();
+	}
+
+	class MappedView
+	{
+	public:
+
+		MappedView() = default;
+
+		MappedView( MappedView&& other ) noexcept
+			: base( std::exchange( other.base, nullptr ) ), mappedLength( std::exchange( other.mappedLength, 0 ) ),
+			bytes( std::exchange( other.bytes, nullptr ) ), length( std::exchange( other.length, 0 ) )
+		{
+		}
+
+		MappedView& operator=( MappedView&& other ) noexcept
+		{
+			if (this != &other)
+			{
+				Unmap();
+				base = std::exchange( other.base, nullptr );
+				mappedLength = std::exchange( other.mappedLength, 0 );
+				bytes = std::exchange( other.bytes, nullptr );
+				length = std::exchange( other.length, 0 );
+			}
+			return *this;
+		}
+
+		MappedView( const MappedView& ) = delete;
+		MappedView& operator=( const MappedView& ) = delete;
+
+		~MappedView()
+		{
+			Unmap();
+		}
+
+		std::byte* data() { return bytes; }
+		const std::byte* data() const { return bytes; }
+		size_t size() const { return length; }
+
+		// Writes the modified pages back to the file.
+		void Flush()
+		{
+			if (base == nullptr)
+			{
+				return;
+			}
+			Detail::FlushMapping( base, mappedLength );
+		}
+
+	private:
+
+		friend class MappedFile;
+
+		MappedView( void* base, size_t mappedLength, size_t skip, size_t length )
+			: base( base ), mappedLength( mappedLength ), bytes( static_cast<std::byte*>(base) + skip ),
+			length( length )
+		{
+		}
+
+		void Unmap()
+		{
+			if (base == nullptr)
+			{
+				return;
+			}
+			Detail::UnmapFile( base, mappedLength );
+			base = nullptr;
+		}
+
+		// The mapping starts at an allocation granularity boundary, up to
+		// skip bytes before the requested window.
+		void* base = nullptr;
+		size_t mappedLength = 0;
+		std::byte* bytes = nullptr;
+		size_t length = 0;
+	};
+
+	class MappedFile
+	{
+	public:
+
+		// Creates (or truncates) the file with size bytes, for reading and
+		// writing.
+		static MappedFile Create( const std::filesystem::path& path, uint64_t size )
+		{
+			MappedFile file( path, true, true );
+			file.Resize( size );
+			return file;
+		}
+
+		static MappedFile Open( const std::filesystem::path& path, bool writable = false )
+		{
+			return MappedFile( path, writable, false );
+		}
+
+		MappedFile( MappedFile&& other ) noexcept
+			: handle( std::exchange( other.handle, Detail::InvalidFileHandle ) ), writable( other.writable ),
+			fileSize( other.fileSize )
+		{
+		}
+
+		MappedFile& operator=( MappedFile&& other ) noexcept
+		{
+			if (this != &other)
+			{
+				Close();
+				handle = std::exchange( other.handle, Detail::InvalidFileHandle );
+				writable = other.writable;
+				fileSize = other.fileSize;
+			}
+			return *this;
+		}
+
+		MappedFile( const MappedFile& ) = delete;
+		MappedFile& operator=( const MappedFile& ) = delete;
+
+		~MappedFile()
+		{
+			Close();
+		}
+
+		uint64_t Size() const { return fileSize; }
+
+		bool Writable() const { return writable; }
+
+		// Maps bytes offset .. offset + length - 1 (length 0: to the end).
+		MappedView Map( uint64_t offset = 0, uint64_t length = 0 ) const
+		{
+			if (offset > fileSize || length > fileSize - offset)
+			{
+				throw std::out_of_range( "Mapped window outside the file." );
+			}
+			if (length == 0)
+			{
+				length = fileSize - offset;
+			}
+			if (length == 0)
+			{
+				return MappedView();
+			}
+
+			const uint64_t start = offset - offset % Granularity();
+			const size_t skip = static_cast<size_t>(offset - start);
+			const size_t mappedLength = static_cast<size_t>(length) + skip;
+
+			void* base = Detail::MapFile( handle, writable, start, mappedLength );
+			return MappedView( base, mappedLength, skip, static_cast<size_t>(length) );
+		}
+
+		// Offsets of mapped windows are rounded down to a multiple of this.
+		static uint64_t Granularity()
+		{
+			return Detail::MapGranularity();
+		}
+
+	private:
+
+		MappedFile( const std::filesystem::path& path, bool writable, bool create )
+			: writable( writable )
+		{
+			handle = Detail::OpenFile( path, writable, create, fileSize );
+		}
+
+		void Resize( uint64_t size )
+		{
+			Detail::ResizeFile( handle, size );
+			fileSize = size;
+		}
+
+		void Close()
+		{
+			if (handle == Detail::InvalidFileHandle)
+			{
+				return;
+			}
+			Detail::CloseFile( handle );
+			handle = Detail::InvalidFileHandle;
+		}
+
+		Detail::FileHandle handle = Detail::InvalidFileHandle;
+		bool writable = false;
+		uint64_t fileSize = 0;
+	};
+}
@@ -0,0 +1,479 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+#include <span>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+#include <stdexcept>
+#include "Biquad.h"
+
+// Multirate stages: decimation and interpolation that only compute the
+// samples that are kept.
+//
+// PolyphaseDecimator / PolyphaseInterpolator run an FIR low pass (taps from
+// LowPassTaps or any other design) at the low rate. The decimator evaluates
+// one dot product per output, i.e. taps / factor multiplies per input sample;
+// the interpolator splits the taps into factor phases and evaluates each
+// phase on the input samples only, without the inserted zeros.
+//
+// HalfbandDecimator / HalfbandInterpolator are the polyphase IIR halfband
+// (factor 2):
+//
+//     H(z) = 0.5 * (A0(z^2) + z^-1 A1(z^2))
+//
+// where A0 and A1 are chains of first order allpass sections. Both chains run
+// at the low rate, one on each input phase. The coefficients come from
+// HalfbandCoefficients (elliptic halfband design); sections are stored as
+// Biquad<T> (a + z^-1) / (1 + a z^-1), the AllPass1stOrder form with
+// a2 = b2 = 0. Chain several halfbands for factors 4, 8...
+//
+// All the Process functions keep their state between calls, so a stream can
+// be processed in blocks of any size.
+
+namespace DigitalFilters::Multirate
+{
+	namespace Detail
+	{
+		// Delay line stored twice so the last N samples are always a
+		// contiguous window, oldest first.
+		template <typename T> requires std::is_floating_point_v<T>
+		class DelayLine
+		{
+		public:
+
+			explicit DelayLine( size_t length )
+				: samples( 2 * length, T( 0 ) ), length( length )
+			{
+			}
+
+			void Push( T x )
+			{
+				samples[position] = x;
+				samples[position + length] = x;
+				position = position + 1 == length ? 0 : position + 1;
+			}
+
+			const T* Window() const
+			{
+				return samples.data() + position;
+			}
+
+			void Reset()
+			{
+				std::fill( samples.begin(), samples.end(), T( 0 ) );
+				position = 0;
+			}
+
+		private:
+
+			std::vector<T> samples;
+			size_t length;
+			size_t position = 0;
+		};
+
+		template <typename T>
+		inline T Dot( const T* x, const T* y, size_t count )
+		{
+			T sum = 0;
+
+			#pragma omp simd reduction(+:sum)
+			for (size_t i = 0; i < count; i++)
+			{
+				sum += x[i] * y[i];
+			}
+
+			return sum;
+		}
+
+		// Chain of first order allpass sections, transposed direct form II.
+		template <typename T>
+		inline T ProcessAllPassChain( const std::vector<Biquad<T>>& sections, T* state, T x )
+		{
+			for (size_t k = 0; k < sections.size(); k++)
+			{
+				const T y = sections[k].a0 * x + state[k];
+				state[k] = sections[k].a1 * x - sections[k].b1 * y;
+				x = y;
+			}
+
+			return x;
+		}
+
+		inline void CheckFactor( size_t factor )
+		{
+			if (factor == 0)
+			{
+				throw std::invalid_argument( "factor must be at least 1." );
+			}
+		}
+
+		// Terms of the elliptic halfband design (theta function series).
+		inline double HalfbandNumerator( double q, int order, int c )
+		{
+			double sum = 0, term;
+			int i = 0;
+			do
+			{
+				term = std::pow( q, i * (i + 1) ) * std::sin( (2 * i + 1) * c * std::numbers::pi / order );
+				sum += i % 2 == 0 ? term : -term;
+				i++;
+			} while (std::abs( term ) > 1e-100);
+
+			return sum;
+		}
+
+		inline double HalfbandDenominator( double q, int order, int c )
+		{
+			double sum = 0, term;
+			int i = 1;
+			do
+			{
+				term = std::pow( q, i * i ) * std::cos( 2 * i * c * std::numbers::pi / order );
+				sum += i % 2 == 0 ? term : -term;
+				i++;
+			} while (std::abs( term ) > 1e-100);
+
+			return sum;
+		}
+	}
+
+	// FIR low pass, Blackman windowed sinc with unity DC gain. cutoff is the
+	// -6 dB frequency in Hz.
+	template <typename T> requires std::is_floating_point_v<T>
+	std::vector<T> LowPassTaps( size_t count, T cutoff, T Fs )
+	{
+		if (count == 0 || !(cutoff > 0 && cutoff < Fs / 2))
+		{
+			throw std::invalid_argument( "Invalid low pass taps design." );
+		}
+
+		std::vector<T> taps( count );
+		const double center = (count - 1) / 2.0;
+		const double fc = static_cast<double>(cutoff) / Fs;
+		double sum = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const double t = i - center;
+			const double sinc = t == 0 ? 2 * fc : std::sin( 2 * std::numbers::pi * fc * t ) / (std::numbers::pi * t);
+			const double phase = count > 1 ? 2 * std::numbers::pi * i / (count - 1) : 0;
+			const double window = 0.42 - 0.5 * std::cos( phase ) + 0.08 * std::cos( 2 * phase );
+			taps[i] = static_cast<T>(sinc * window);
+			sum += sinc * window;
+		}
+
+		for (T& tap : taps)
+		{
+			tap = static_cast<T>(tap / sum);
+		}
+
+		return taps;
+	}
+
+	// Allpass coefficients of an elliptic halfband with count sections in
+	// total (filter order 2 * count + 1). transition is the width of the
+	// transition band relative to Fs, centered on Fs / 4 (0 < transition <
+	// 0.5). More sections or a wider transition give more stopband
+	// attenuation.
+	template <typename T> requires std::is_floating_point_v<T>
+	std::vector<T> HalfbandCoefficients( size_t count, T transition )
+	{
+		if (count == 0 || !(transition > 0 && transition < T( 0.5 )))
+		{
+			throw std::invalid_argument( "Invalid halfband design." );
+		}
+
+		double k = std::tan( (1 - 2 * static_cast<double>(transition)) * std::numbers::pi / 4 );
+		k *= k;
+		const double root = std::pow( 1 - k * k, 0.25 );
+		const double e = 0.5 * (1 - root) / (1 + root);
+		const double e4 = e * e * e * e;
+		const double q = e * (1 + e4 * (2 + e4 * (15 + 150 * e4)));
+
+		const int order = static_cast<int>(2 * count + 1);
+		std::vector<T> coefficients( count );
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const int c = static_cast<int>(i) + 1;
+			const double w = Detail::HalfbandNumerator( q, order, c ) * std::pow( q, 0.25 ) /
+				(Detail::HalfbandDenominator( q, order, c ) + 0.5);
+			const double w2 = w * w;
+			const double x = std::sqrt( (1 - w2 * k) * (1 - w2 / k) ) / (1 + w2);
+			coefficients[i] = static_cast<T>((1 - x) / (1 + x));
+		}
+
+		return coefficients;
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class PolyphaseDecimator
+	{
+	public:
+
+		PolyphaseDecimator( std::span<const T> taps, size_t factor )
+			: reversed( taps.rbegin(), taps.rend() ), history( taps.size() ), factor( factor )
+		{
+			Detail::CheckFactor( factor );
+			if (taps.empty())
+			{
+				throw std::invalid_argument( "At least one tap is required." );
+			}
+		}
+
+		PolyphaseDecimator( const std::vector<T>& taps, size_t factor )
+			: PolyphaseDecimator( std::span<const T>( taps ), factor )
+		{
+		}
+
+		size_t Factor() const { return factor; }
+
+		// Outputs produced by the next Process call for inputSize samples.
+		size_t OutputSize( size_t inputSize ) const
+		{
+			return (phase + inputSize) / factor;
+		}
+
+		void Reset()
+		{
+			history.Reset();
+			phase = 0;
+		}
+
+		// Keeps the filter output at the last sample of every group of factor
+		// inputs. output needs OutputSize( input.size() ) samples; returns the
+		// number written.
+		size_t Process( std::span<const T> input, std::span<T> output )
+		{
+			const size_t count = OutputSize( input.size() );
+			if (output.size() < count)
+			{
+				throw std::invalid_argument( "output is too small." );
+			}
+
+			size_t written = 0;
+
+			for (T x : input)
+			{
+				history.Push( x );
+				if (++phase == factor)
+				{
+					output[written++] = Detail::Dot( history.Window(), reversed.data(), reversed.size() );
+					phase = 0;
+				}
+			}
+
+			return written;
+		}
+
+	private:
+
+		std::vector<T> reversed;
+		Detail::DelayLine<T> history;
+		size_t factor;
+		size_t phase = 0;
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class PolyphaseInterpolator
+	{
+	public:
+
+		// The taps are designed at the high rate with unity DC gain; the
+		// interpolator applies the factor gain lost by the zero insertion.
+		PolyphaseInterpolator( std::span<const T> taps, size_t factor )
+			: factor( factor ), length( (taps.size() + factor - 1) / std::max<size_t>( factor, 1 ) ),
+			phases( factor * length, T( 0 ) ), history( length )
+		{
+			Detail::CheckFactor( factor );
+			if (taps.empty())
+			{
+				throw std::invalid_argument( "At least one tap is required." );
+			}
+
+			// Phase p holds taps p, p + factor, ... reversed to match the
+			// history window.
+			for (size_t i = 0; i < taps.size(); i++)
+			{
+				const size_t p = i % factor, j = i / factor;
+				phases[p * length + length - 1 - j] = taps[i] * static_cast<T>(factor);
+			}
+		}
+
+		PolyphaseInterpolator( const std::vector<T>& taps, size_t factor )
+			: PolyphaseInterpolator( std::span<const T>( taps ), factor )
+		{
+		}
+
+		size_t Factor() const { return factor; }
+
+		void Reset()
+		{
+			history.Reset();
+		}
+
+		// output needs input.size() * Factor() samples.
+		void Process( std::span<const T> input, std::span<T> output )
+		{
+			if (output.size() != input.size() * factor)
+			{
+				throw std::invalid_argument( "output must have Factor() samples per input sample." );
+			}
+
+			T* out = output.data();
+
+			for (T x : input)
+			{
+				history.Push( x );
+				for (size_t p = 0; p < factor; p++)
+				{
+					*out++ = Detail::Dot( history.Window(), phases.data() + p * length, length );
+				}
+			}
+		}
+
+	private:
+
+		size_t factor;
+		size_t length;
+		std::vector<T> phases;
+		Detail::DelayLine<T> history;
+	};
+
+	namespace Detail
+	{
+		// Even coefficients go to the first path, odd ones to the second.
+		template <typename T> requires std::is_floating_point_v<T>
+		std::vector<Biquad<T>> HalfbandPath( std::span<const T> coefficients, size_t first )
+		{
+			std::vector<Biquad<T>> sections;
+			for (size_t i = first; i < coefficients.size(); i += 2)
+			{
+				sections.emplace_back( coefficients[i], T( 1 ), T( 0 ), coefficients[i], T( 0 ) );
+			}
+			return sections;
+		}
+	}
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class HalfbandDecimator
+	{
+	public:
+
+		explicit HalfbandDecimator( std::span<const T> coefficients )
+			: path0( Detail::HalfbandPath( coefficients, 0 ) ),
+			path1( Detail::HalfbandPath( coefficients, 1 ) ),
+			state0( path0.size(), T( 0 ) ), state1( path1.size(), T( 0 ) )
+		{
+			if (coefficients.empty())
+			{
+				throw std::invalid_argument( "At least one coefficient is required." );
+			}
+		}
+
+		explicit HalfbandDecimator( const std::vector<T>& coefficients )
+			: HalfbandDecimator( std::span<const T>( coefficients ) )
+		{
+		}
+
+		size_t OutputSize( size_t inputSize ) const
+		{
+			return (pending + inputSize) / 2;
+		}
+
+		void Reset()
+		{
+			std::fill( state0.begin(), state0.end(), T( 0 ) );
+			std::fill( state1.begin(), state1.end(), T( 0 ) );
+			pending = 0;
+		}
+
+		// Keeps the halfband output at every second input sample. output
+		// needs OutputSize( input.size() ) samples; returns the number written.
+		size_t Process( std::span<const T> input, std::span<T> output )
+		{
+			const size_t count = OutputSize( input.size() );
+			if (output.size() < count)
+			{
+				throw std::invalid_argument( "output is too small." );
+			}
+
+			size_t written = 0;
+
+			for (T x : input)
+			{
+				if (pending == 0)
+				{
+					even = x;
+					pending = 1;
+					continue;
+				}
+
+				// 0.5 * (A0 on the odd phase + A1 on the delayed even phase).
+				const T y0 = Detail::ProcessAllPassChain( path0, state0.data(), x );
+				const T y1 = Detail::ProcessAllPassChain( path1, state1.data(), even );
+				output[written++] = T( 0.5 ) * (y0 + y1);
+				pending = 0;
+			}
+
+			return written;
+		}
+
+	private:
+
+		std::vector<Biquad<T>> path0, path1;
+		std::vector<T> state0, state1;
+		T even = 0;
+		size_t pending = 0;
+	};
+
+	template <typename T> requires std::is_floating_point_v<T>
+	class HalfbandInterpolator
+	{
+	public:
+
+		explicit HalfbandInterpolator( std::span<const T> coefficients )
+			: path0( Detail::HalfbandPath( coefficients, 0 ) ),
+			path1( Detail::HalfbandPath( coefficients, 1 ) ),
+			state0( path0.size(), T( 0 ) ), state1( path1.size(), T( 0 ) )
+		{
+			if (coefficients.empty())
+			{
+				throw std::invalid_argument( "At least one coefficient is required." );
+			}
+		}
+
+		explicit HalfbandInterpolator( const std::vector<T>& coefficients )
+			: HalfbandInterpolator( std::span<const T>( coefficients ) )
+		{
+		}
+
+		void Reset()
+		{
+			std::fill( state0.begin(), state0.end(), T( 0 ) );
+			std::fill( state1.begin(), state1.end(), T( 0 ) );
+		}
+
+		// output needs 2 * input.size() samples.
+		void Process( std::span<const T> input, std::span<T> output )
+		{
+			if (output.size() != 2 * input.size())
+			{
+				throw std::invalid_argument( "output must have two samples per input sample." );
+			}
+
+			for (size_t i = 0; i < input.size(); i++)
+			{
+				output[2 * i] = Detail::ProcessAllPassChain( path0, state0.data(), input[i] );
+				output[2 * i + 1] = Detail::ProcessAllPassChain( path1, state1.data(), input[i] );
+			}
+		}
+
+	private:
+
+		std::vector<Biquad<T>> path0, path1;
+		std::vector<T> state0, state1;
+	};
+}
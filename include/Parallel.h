@@ -0,0 +1,430 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "../DigitalFiltersLib/DigitalFiltersModuleExport.h"
+
+// Parallel loops with a selectable backend.
+//
+// Parallel::For( count, options, body ) splits [0, count) into chunks of
+// options.grain indices and calls body( begin, end ) for every chunk on one of
+// options.threads threads, with
+//   - Backend::OpenMP: an OpenMP team, each thread running a contiguous run
+//     of chunks (a static schedule);
+//   - Backend::ThreadPool: the persistent work stealing ThreadPool. Every
+//     participant starts with the same contiguous run of chunks as with
+//     OpenMP and, once done, steals single chunks from the back of the others;
+//   - Backend::Serial: the calling thread.
+// A range of a single chunk, and any For called from inside another one, runs
+// on the calling thread. Built without OpenMP, Backend::OpenMP uses the pool.
+//
+// Since both parallel backends hand the same contiguous runs to the same
+// participants, a Buffer allocated with the options later used to fill it is
+// first touched, page by page, by the thread that will write it, so on NUMA
+// machines its pages live on that thread's node. Thread placement itself
+// comes from pinThreads for the pool and from OMP_PROC_BIND / OMP_PLACES for
+// OpenMP. The pinning call itself lives in DigitalFiltersLib (Parallel.cpp),
+// which keeps the OS headers out of this one; programs using the pool link
+// the library.
+//
+// The default options, the shared pool and the worker index of the calling
+// thread are defined once in the library as well, so in a DLL build the
+// application and the DLL see the same settings and share one pool.
+//
+// Bodies must not throw.
+
+namespace DigitalFilters::Parallel
+{
+	enum class Backend
+	{
+		OpenMP,
+		ThreadPool,
+		Serial
+	};
+
+	constexpr size_t DefaultGrain = 4096;
+
+	struct Options
+	{
+		Backend backend = Backend::OpenMP;
+
+		// Threads to use (the calling thread included), 0 for all of the
+		// backend: omp_get_max_threads() or the pool size.
+		size_t threads = 0;
+
+		// Indices per chunk, 0 for DefaultGrain.
+		size_t grain = 0;
+
+		// ThreadPool only: pin pool thread i to logical CPU i. A pinned thread
+		// stays pinned for the life of the pool.
+		bool pinThreads = false;
+	};
+
+	class ThreadPool;
+
+	namespace Detail
+	{
+		constexpr size_t NotAWorker = ~size_t( 0 );
+
+		// Index of the calling thread in the running pool job, NotAWorker
+		// outside of one.
+		DIGITALFILTERS_MODULE_LIB size_t& PoolWorker();
+
+		DIGITALFILTERS_MODULE_LIB ThreadPool& SharedPool();
+
+		// Chunks [first, last) of participant p out of participants.
+		constexpr std::pair<size_t, size_t> Partition( size_t chunks, size_t participants, size_t p )
+		{
+			return { chunks * p / participants, chunks * (p + 1) / participants };
+		}
+
+		// Pins the calling thread to logical CPU cpu (modulo the CPU count);
+		// false where not supported.
+		DIGITALFILTERS_MODULE_LIB bool PinCurrentThread( size_t cpu );
+	}
+
+	// Options used by the library functions that do not take any.
+	DIGITALFILTERS_MODULE_LIB Options DefaultOptions();
+
+	DIGITALFILTERS_MODULE_LIB void SetDefaultOptions( const Options& options );
+
+	// Index of the calling thread in the running For (0 outside of one).
+	inline size_t WorkerIndex()
+	{
+		if (const size_t worker = Detail::PoolWorker(); worker != Detail::NotAWorker)
+		{
+			return worker;
+		}
+#if defined(_OPENMP)
+		return static_cast<size_t>(omp_get_thread_num());
+#else
+		return 0;
+#endif
+	}
+
+	// Persistent threads running one job at a time. The thread calling Run
+	// takes part as participant 0.
+	class ThreadPool
+	{
+	public:
+
+		// threads: participants, the calling thread included.
+		explicit ThreadPool( size_t threads = std::max( 1u, std::thread::hardware_concurrency() ) )
+			: queues( new Queue[std::max<size_t>( threads, 1 )] )
+		{
+			for (size_t worker = 1; worker < threads; worker++)
+			{
+				workers.emplace_back( [this, worker] { Loop( worker ); } );
+			}
+		}
+
+		ThreadPool( const ThreadPool& ) = delete;
+		ThreadPool& operator=( const ThreadPool& ) = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock( mutex );
+				stop = true;
+			}
+			wake.notify_all();
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		size_t Size() const { return workers.size() + 1; }
+
+		// Pool shared by Parallel::For, one thread per logical CPU.
+		static ThreadPool& Instance()
+		{
+			return Detail::SharedPool();
+		}
+
+		// Calls chunk( c ) for every c in [0, chunks) on up to participants
+		// threads and returns when all are done. Runs on the calling thread
+		// when called from a pool thread or while another job is running.
+		void Run( size_t chunks, size_t participants, bool pin, const std::function<void( size_t )>& chunk )
+		{
+			participants = std::min( { participants, Size(), chunks } );
+
+			std::unique_lock<std::mutex> running( runMutex, std::try_to_lock );
+			if (participants <= 1 || !running.owns_lock() || Detail::PoolWorker() != Detail::NotAWorker)
+			{
+				for (size_t c = 0; c < chunks; c++)
+				{
+					chunk( c );
+				}
+				return;
+			}
+
+			for (size_t p = 0; p < participants; p++)
+			{
+				const auto [first, last] = Detail::Partition( chunks, participants, p );
+				queues[p].range.store( Pack( first, last ), std::memory_order_relaxed );
+			}
+
+			{
+				std::lock_guard<std::mutex> lock( mutex );
+				job = &chunk;
+				jobParticipants = participants;
+				pending = participants - 1;
+				pinWorkers = pin;
+				generation++;
+			}
+			wake.notify_all();
+
+			Detail::PoolWorker() = 0;
+			Work( 0 );
+			Detail::PoolWorker() = Detail::NotAWorker;
+
+			std::unique_lock<std::mutex> lock( mutex );
+			finished.wait( lock, [this] { return pending == 0; } );
+			job = nullptr;
+		}
+
+	private:
+
+		// Chunks [begin, end) still queued, packed as begin << 32 | end.
+		struct alignas(64) Queue
+		{
+			std::atomic<uint64_t> range{ 0 };
+		};
+
+		static uint64_t Pack( size_t begin, size_t end )
+		{
+			return (static_cast<uint64_t>(begin) << 32) | static_cast<uint64_t>(end);
+		}
+
+		// The owner takes from the front, thieves from the back.
+		bool Take( size_t queue, bool front, size_t& chunk )
+		{
+			std::atomic<uint64_t>& range = queues[queue].range;
+			uint64_t current = range.load( std::memory_order_relaxed );
+			while (true)
+			{
+				const size_t begin = static_cast<size_t>(current >> 32);
+				const size_t end = static_cast<size_t>(current & 0xFFFFFFFFu);
+				if (begin >= end)
+				{
+					return false;
+				}
+				const uint64_t next = front ? Pack( begin + 1, end ) : Pack( begin, end - 1 );
+				if (range.compare_exchange_weak( current, next, std::memory_order_acq_rel ))
+				{
+					chunk = front ? begin : end - 1;
+					return true;
+				}
+			}
+		}
+
+		void Work( size_t participant )
+		{
+			const std::function<void( size_t )>& body = *job;
+			size_t chunk;
+
+			while (Take( participant, true, chunk ))
+			{
+				body( chunk );
+			}
+
+			for (size_t k = 1; k < jobParticipants; k++)
+			{
+				const size_t victim = (participant + k) % jobParticipants;
+				while (Take( victim, false, chunk ))
+				{
+					body( chunk );
+				}
+			}
+		}
+
+		void Loop( size_t worker )
+		{
+			Detail::PoolWorker() = worker;
+			uint64_t seen = 0;
+			bool pinned = false;
+
+			while (true)
+			{
+				std::unique_lock<std::mutex> lock( mutex );
+				wake.wait( lock, [&] { return stop || generation != seen; } );
+				if (stop)
+				{
+					return;
+				}
+				seen = generation;
+				if (worker >= jobParticipants)
+				{
+					continue;
+				}
+				const bool pin = pinWorkers;
+				lock.unlock();
+
+				if (pin && !pinned)
+				{
+					pinned = Detail::PinCurrentThread( worker );
+				}
+				Work( worker );
+
+				lock.lock();
+				if (--pending == 0)
+				{
+					finished.notify_one();
+				}
+			}
+		}
+
+		std::unique_ptr<Queue[]> queues;
+		std::vector<std::thread> workers;
+
+		std::mutex runMutex;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable finished;
+
+		const std::function<void( size_t )>* job = nullptr;
+		size_t jobParticipants = 0;
+		size_t pending = 0;
+		bool pinWorkers = false;
+		uint64_t generation = 0;
+		bool stop = false;
+	};
+
+	template <typename Body>
+	void For( size_t count, const Options& options, Body&& body )
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		// Chunk indices must fit the 32 bit halves of a pool queue.
+		constexpr size_t MaxChunks = 0x7FFFFFFF;
+		const size_t grain = std::max( options.grain > 0 ? options.grain : DefaultGrain,
+			(count + MaxChunks - 1) / MaxChunks );
+		const size_t chunks = (count + grain - 1) / grain;
+
+		auto chunk = [&]( size_t c )
+		{
+			body( c * grain, std::min( count, (c + 1) * grain ) );
+		};
+
+		if (options.backend == Backend::Serial || chunks == 1)
+		{
+			for (size_t c = 0; c < chunks; c++)
+			{
+				chunk( c );
+			}
+			return;
+		}
+
+#if defined(_OPENMP)
+		if (options.backend == Backend::OpenMP)
+		{
+			const size_t threads = std::min( chunks, options.threads > 0
+				? options.threads : static_cast<size_t>(omp_get_max_threads()) );
+
+			if (threads <= 1 || omp_in_parallel() || Detail::PoolWorker() != Detail::NotAWorker)
+			{
+				for (size_t c = 0; c < chunks; c++)
+				{
+					chunk( c );
+				}
+				return;
+			}
+
+			#pragma omp parallel num_threads( static_cast<int>(threads) )
+			{
+				const auto [first, last] = Detail::Partition( chunks,
+					static_cast<size_t>(omp_get_num_threads()), static_cast<size_t>(omp_get_thread_num()) );
+				for (size_t c = first; c < last; c++)
+				{
+					chunk( c );
+				}
+			}
+			return;
+		}
+#endif
+
+		ThreadPool& pool = ThreadPool::Instance();
+		pool.Run( chunks, options.threads > 0 ? options.threads : pool.Size(), options.pinThreads, chunk );
+	}
+
+	template <typename Body>
+	void For( size_t count, Body&& body )
+	{
+		For( count, DefaultOptions(), std::forward<Body>( body ) );
+	}
+
+	// Page aligned, value initialized array whose elements are first touched
+	// by the thread For( size(), options, ... ) hands them to.
+	template <typename T> requires std::is_trivially_destructible_v<T>
+	class Buffer
+	{
+	public:
+
+		static constexpr size_t Alignment = 4096;
+
+		Buffer() = default;
+
+		explicit Buffer( size_t count, const Options& options = DefaultOptions() )
+			: storage( static_cast<T*>(::operator new[]( std::max<size_t>( count, 1 ) * sizeof( T ),
+				std::align_val_t( Alignment ) )) ),
+			count( count )
+		{
+			T* data = storage.get();
+			For( count, options, [data]( size_t begin, size_t end )
+				{
+					for (size_t i = begin; i < end; i++)
+					{
+						new (data + i) T();
+					}
+				} );
+		}
+
+		T* data() { return storage.get(); }
+		const T* data() const { return storage.get(); }
+		size_t size() const { return count; }
+
+		T& operator[]( size_t index ) { return storage.get()[index]; }
+		const T& operator[]( size_t index ) const { return storage.get()[index]; }
+
+		T* begin() { return data(); }
+		T* end() { return data() + count; }
+		const T* begin() const { return data(); }
+		const T* end() const { return data() + count; }
+
+		operator std::span<T>() { return { data(), count }; }
+		operator std::span<const T>() const { return { data(), count }; }
+
+	private:
+
+		struct AlignedDelete
+		{
+			void operator()( T* data ) const
+			{
+				::operator delete[]( data, std::align_val_t( Alignment ) );
+			}
+		};
+
+		std::unique_ptr<T[], AlignedDelete> storage;
+		size_t count = 0;
+	};
+}
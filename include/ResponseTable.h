@@ -0,0 +1,429 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include "Biquad.h"
+#include "Evaluator.h"
+#include "Utils.h"
+#include "Parallel.h"
+#include "MappedFile.h"
+
+// Response tables: the frequency response of many filters on one frequency
+// grid, evaluated straight into a memory mapped file.
+//
+// Write() maps the output a window of settings.windowBytes at a time and
+// fills each window with Parallel::For (tiles of options.grain points), so
+// the memory used stays bounded whatever the table size; the written pages
+// are left to the system page cache. Table opens a file zero-copy: its
+// spans point into the mapping.
+//
+// File layout (native byte order, every array 4096 byte aligned):
+//
+//   offset 0                  Header (128 bytes, below)
+//   frequenciesOffset         double frequencies[frequencyCount] (Hz)
+//   coefficientsOffset        double coefficients[filterCount]
+//                                 [numeratorLength + denominatorLength]
+//                             (numerator then denominator, zero padded)
+//   dataOffset                Layout::Complex:
+//                                 double response[filterCount][frequencyCount][2]
+//                                 (real, imaginary: std::complex<double>)
+//                             Layout::MagnitudePhase:
+//                                 double magnitude[filterCount][frequencyCount]
+//   phaseOffset               Layout::MagnitudePhase only:
+//                                 double phase[filterCount][frequencyCount] (rad)
+//
+// The header is written last, so an interrupted Write leaves a file that
+// does not open.
+
+namespace DigitalFilters::ResponseTable
+{
+	enum class Layout : uint32_t
+	{
+		// Interleaved real and imaginary parts.
+		Complex = 0,
+		// Structure of arrays: all the magnitudes, then all the phases.
+		MagnitudePhase = 1
+	};
+
+	constexpr std::array<char, 8> Magic = { 'D', 'F', 'R', 'E', 'S', 'P', 'T', 'B' };
+	constexpr uint32_t Version = 1;
+	constexpr uint32_t ByteOrderMark = 0x01020304;
+	constexpr uint64_t ArrayAlignment = 4096;
+
+	struct Header
+	{
+		std::array<char, 8> magic;
+		uint32_t version;
+		// ByteOrderMark in the writer's byte order.
+		uint32_t byteOrder;
+		Layout layout;
+		uint32_t reserved0;
+		uint64_t filterCount;
+		uint64_t frequencyCount;
+		uint64_t numeratorLength;
+		uint64_t denominatorLength;
+		double fs;
+		uint64_t frequenciesOffset;
+		uint64_t coefficientsOffset;
+		uint64_t dataOffset;
+		uint64_t phaseOffset;
+		uint64_t fileSize;
+		std::array<uint64_t, 3> reserved1;
+	};
+
+	static_assert(sizeof( Header ) == 128 && std::is_trivially_copyable_v<Header>);
+
+	// Filters of one table, all with the same (zero padded) coefficient
+	// counts.
+	class FilterSet
+	{
+	public:
+
+		explicit FilterSet( size_t numeratorLength = 3, size_t denominatorLength = 3 )
+			: numeratorLength( numeratorLength ), denominatorLength( denominatorLength )
+		{
+			if (numeratorLength == 0 || denominatorLength == 0)
+			{
+				throw std::invalid_argument( "Coefficient counts must be positive." );
+			}
+		}
+
+		void Add( std::span<const double> zeros, std::span<const double> poles )
+		{
+			if (zeros.size() > numeratorLength || poles.size() > denominatorLength)
+			{
+				throw std::invalid_argument( "Filter longer than the set coefficient counts." );
+			}
+			const size_t first = coefficients.size();
+			coefficients.resize( first + numeratorLength + denominatorLength, 0.0 );
+			std::copy( zeros.begin(), zeros.end(), coefficients.begin() + first );
+			std::copy( poles.begin(), poles.end(), coefficients.begin() + first + numeratorLength );
+		}
+
+		void Add( const Biquad<double>& biquad )
+		{
+			const std::array<double, 3> numerator = biquad.Numerator();
+			const std::array<double, 3> denominator = biquad.Denominator();
+			Add( numerator, denominator );
+		}
+
+		size_t Size() const { return coefficients.size() / Stride(); }
+		size_t NumeratorLength() const { return numeratorLength; }
+		size_t DenominatorLength() const { return denominatorLength; }
+
+		std::span<const double> Numerator( size_t filter ) const
+		{
+			return std::span<const double>( coefficients ).subspan( filter * Stride(), numeratorLength );
+		}
+
+		std::span<const double> Denominator( size_t filter ) const
+		{
+			return std::span<const double>( coefficients ).subspan( filter * Stride() + numeratorLength,
+				denominatorLength );
+		}
+
+		std::span<const double> Coefficients() const { return coefficients; }
+
+	private:
+
+		size_t Stride() const { return numeratorLength + denominatorLength; }
+
+		size_t numeratorLength;
+		size_t denominatorLength;
+		std::vector<double> coefficients;
+	};
+
+	struct WriteSettings
+	{
+		Layout layout = Layout::Complex;
+
+		// Bytes of results mapped at once (over all the arrays written).
+		uint64_t windowBytes = uint64_t( 256 ) << 20;
+
+		Parallel::Options options = Parallel::DefaultOptions();
+	};
+
+	namespace Detail
+	{
+		constexpr uint64_t AlignUp( uint64_t value )
+		{
+			return (value + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+		}
+
+		// Header of a table, offsets included.
+		inline Header MakeHeader( uint64_t filterCount, uint64_t frequencyCount, uint64_t numeratorLength,
+			uint64_t denominatorLength, double fs, Layout layout )
+		{
+			Header header{};
+			header.magic = Magic;
+			header.version = Version;
+			header.byteOrder = ByteOrderMark;
+			header.layout = layout;
+			header.filterCount = filterCount;
+			header.frequencyCount = frequencyCount;
+			header.numeratorLength = numeratorLength;
+			header.denominatorLength = denominatorLength;
+			header.fs = fs;
+
+			const uint64_t points = header.filterCount * header.frequencyCount;
+			header.frequenciesOffset = AlignUp( sizeof( Header ) );
+			header.coefficientsOffset = AlignUp( header.frequenciesOffset + frequencyCount * sizeof( double ) );
+			header.dataOffset = AlignUp( header.coefficientsOffset
+				+ filterCount * (numeratorLength + denominatorLength) * sizeof( double ) );
+			if (layout == Layout::Complex)
+			{
+				header.fileSize = header.dataOffset + points * sizeof( std::complex<double> );
+			}
+			else
+			{
+				header.phaseOffset = AlignUp( header.dataOffset + points * sizeof( double ) );
+				header.fileSize = header.phaseOffset + points * sizeof( double );
+			}
+			return header;
+		}
+
+		inline void Copy( const MappedFile& file, uint64_t offset, std::span<const double> values )
+		{
+			if (values.empty())
+			{
+				return;
+			}
+			MappedView view = file.Map( offset, values.size_bytes() );
+			std::memcpy( view.data(), values.data(), values.size_bytes() );
+		}
+
+		template <typename T>
+		std::span<T> Values( MappedView& view, size_t count )
+		{
+			return std::span<T>( reinterpret_cast<T*>(view.data()), count );
+		}
+	}
+
+	// Evaluates every filter at every frequency into a new file at path.
+	inline void Write( const std::filesystem::path& path, const FilterSet& filters,
+		std::span<const double> freqs, double fs, const WriteSettings& settings = {} )
+	{
+		if (settings.windowBytes == 0)
+		{
+			throw std::invalid_argument( "windowBytes must be positive." );
+		}
+
+		const Header header = Detail::MakeHeader( filters.Size(), freqs.size(), filters.NumeratorLength(),
+			filters.DenominatorLength(), fs, settings.layout );
+		MappedFile file = MappedFile::Create( path, header.fileSize );
+
+		Detail::Copy( file, header.frequenciesOffset, freqs );
+		Detail::Copy( file, header.coefficientsOffset, filters.Coefficients() );
+
+		std::vector<double> omegas( freqs.size() );
+		for (size_t i = 0; i < freqs.size(); i++)
+		{
+			omegas[i] = Utils::HzToOmega( freqs[i] ) / fs;
+		}
+
+		const uint64_t points = header.filterCount * header.frequencyCount;
+		const uint64_t windowPoints = std::max<uint64_t>( 1, settings.windowBytes / sizeof( std::complex<double> ) );
+		const size_t frequencyCount = freqs.size();
+
+		for (uint64_t first = 0; first < points; first += windowPoints)
+		{
+			const size_t count = static_cast<size_t>(std::min( windowPoints, points - first ));
+
+			// Calls tile( point, filter, frequency, end ) for the runs of
+			// points of one filter in [begin, end) of the window.
+			auto forTiles = [&]( auto tile )
+			{
+				Parallel::For( count, settings.options, [&]( size_t begin, size_t end )
+				{
+					for (size_t point = begin; point < end;)
+					{
+						const uint64_t index = first + point;
+						const size_t filter = static_cast<size_t>(index / frequencyCount);
+						const size_t frequency = static_cast<size_t>(index % frequencyCount);
+						const size_t runEnd = std::min( end, point + (frequencyCount - frequency) );
+						tile( point, filter, frequency, runEnd );
+						point = runEnd;
+					}
+				} );
+			};
+
+			if (settings.layout == Layout::Complex)
+			{
+				MappedView view = file.Map( header.dataOffset + first * sizeof( std::complex<double> ),
+					count * sizeof( std::complex<double> ) );
+				const std::span<std::complex<double>> out = Detail::Values<std::complex<double>>( view, count );
+
+				forTiles( [&]( size_t point, size_t filter, size_t frequency, size_t end )
+				{
+					const std::span<const double> zeros = filters.Numerator( filter );
+					const std::span<const double> poles = filters.Denominator( filter );
+					for (; point < end; point++, frequency++)
+					{
+						out[point] = Eval::CalcFreqResponse( zeros, poles, omegas[frequency] );
+					}
+				} );
+			}
+			else
+			{
+				MappedView magnitudeView = file.Map( header.dataOffset + first * sizeof( double ),
+					count * sizeof( double ) );
+				MappedView phaseView = file.Map( header.phaseOffset + first * sizeof( double ),
+					count * sizeof( double ) );
+				const std::span<double> magnitude = Detail::Values<double>( magnitudeView, count );
+				const std::span<double> phase = Detail::Values<double>( phaseView, count );
+
+				forTiles( [&]( size_t point, size_t filter, size_t frequency, size_t end )
+				{
+					const std::span<const double> zeros = filters.Numerator( filter );
+					const std::span<const double> poles = filters.Denominator( filter );
+					for (; point < end; point++, frequency++)
+					{
+						const FrequencyResponse<double> response =
+							Eval::CalcFreqResponseTrig( zeros, poles, omegas[frequency] );
+						magnitude[point] = response.magnitude;
+						phase[point] = response.phase;
+					}
+				} );
+			}
+		}
+
+		MappedView headerView = file.Map( 0, sizeof( Header ) );
+		std::memcpy( headerView.data(), &header, sizeof( Header ) );
+		headerView.Flush();
+	}
+
+	// A response table opened read-only; the spans point into the mapping and
+	// are valid for the life of the Table.
+	class Table
+	{
+	public:
+
+		explicit Table( const std::filesystem::path& path )
+			: file( MappedFile::Open( path ) )
+		{
+			if (file.Size() < sizeof( Header ))
+			{
+				throw std::runtime_error( "Not a response table: " + path.string() );
+			}
+			view = file.Map();
+			std::memcpy( &header, view.data(), sizeof( Header ) );
+
+			if (header.magic != Magic)
+			{
+				throw std::runtime_error( "Not a response table: " + path.string() );
+			}
+			if (header.byteOrder != ByteOrderMark)
+			{
+				throw std::runtime_error( "Response table written with another byte order: " + path.string() );
+			}
+			if (header.version != Version)
+			{
+				throw std::runtime_error( "Unsupported response table version: " + path.string() );
+			}
+
+			// Counts small enough for the offsets not to overflow, and the
+			// offsets those of a table written with them.
+			const uint64_t limit = file.Size() / sizeof( double );
+			const bool plausible = header.layout <= Layout::MagnitudePhase
+				&& header.frequencyCount <= limit && header.numeratorLength <= limit
+				&& header.denominatorLength <= limit
+				&& (header.filterCount == 0 || header.filterCount <= limit
+					/ std::max<uint64_t>( 1, std::max( header.frequencyCount,
+						header.numeratorLength + header.denominatorLength ) ));
+			const Header expected = plausible ? Detail::MakeHeader( header.filterCount, header.frequencyCount,
+				header.numeratorLength, header.denominatorLength, header.fs, header.layout ) : Header{};
+			if (!plausible || std::memcmp( &expected, &header, sizeof( Header ) ) != 0
+				|| header.fileSize != file.Size())
+			{
+				throw std::runtime_error( "Corrupt response table: " + path.string() );
+			}
+		}
+
+		const Header& GetHeader() const { return header; }
+		Layout GetLayout() const { return header.layout; }
+		size_t FilterCount() const { return static_cast<size_t>(header.filterCount); }
+		size_t FrequencyCount() const { return static_cast<size_t>(header.frequencyCount); }
+		double Fs() const { return header.fs; }
+
+		std::span<const double> Frequencies() const
+		{
+			return Array<double>( header.frequenciesOffset, FrequencyCount() );
+		}
+
+		std::span<const double> Numerator( size_t filter ) const
+		{
+			return Coefficients( filter ).first( static_cast<size_t>(header.numeratorLength) );
+		}
+
+		std::span<const double> Denominator( size_t filter ) const
+		{
+			return Coefficients( filter ).last( static_cast<size_t>(header.denominatorLength) );
+		}
+
+		// Layout::Complex: the response of filter at every frequency.
+		std::span<const std::complex<double>> Response( size_t filter ) const
+		{
+			Expect( Layout::Complex, filter );
+			return Array<std::complex<double>>( header.dataOffset
+				+ filter * header.frequencyCount * sizeof( std::complex<double> ), FrequencyCount() );
+		}
+
+		// Layout::MagnitudePhase: the magnitudes of filter.
+		std::span<const double> Magnitude( size_t filter ) const
+		{
+			Expect( Layout::MagnitudePhase, filter );
+			return Array<double>( header.dataOffset + filter * header.frequencyCount * sizeof( double ),
+				FrequencyCount() );
+		}
+
+		// Layout::MagnitudePhase: the phases of filter.
+		std::span<const double> Phase( size_t filter ) const
+		{
+			Expect( Layout::MagnitudePhase, filter );
+			return Array<double>( header.phaseOffset + filter * header.frequencyCount * sizeof( double ),
+				FrequencyCount() );
+		}
+
+	private:
+
+		template <typename T>
+		std::span<const T> Array( uint64_t offset, size_t count ) const
+		{
+			return std::span<const T>( reinterpret_cast<const T*>(view.data() + offset), count );
+		}
+
+		std::span<const double> Coefficients( size_t filter ) const
+		{
+			if (filter >= FilterCount())
+			{
+				throw std::out_of_range( "Filter index out of range." );
+			}
+			const size_t stride = static_cast<size_t>(header.numeratorLength + header.denominatorLength);
+			return Array<double>( header.coefficientsOffset + filter * stride * sizeof( double ), stride );
+		}
+
+		void Expect( Layout layout, size_t filter ) const
+		{
+			if (header.layout != layout)
+			{
+				throw std::invalid_argument( "The table has another layout." );
+			}
+			if (filter >= FilterCount())
+			{
+				throw std::out_of_range( "Filter index out of range." );
+			}
+		}
+
+		MappedFile file;
+		MappedView view;
+		Header header{};
+	};
+}
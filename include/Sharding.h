@@ -0,0 +1,377 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+#include <limits>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include "Datasets.h"
+#include "MappedFile.h"
+#include "ResponseTable.h"
+
+// Sharding of response table jobs across processes (or machines).
+//
+// A Job (filters, frequency grid as a Datasets::Dataset, sample rate and
+// layout) is split into shards, each a rectangle of the table: a range of
+// filters when there are at least as many filters as shards, otherwise a
+// range of frequencies. A Shard is evaluated on its own, for instance by
+// another process reading it with LoadShard, into a response table of its
+// filters on its part of the grid. Merge checks that every shard file holds
+// exactly the filters and frequencies of its shard and copies them into the
+// table of the whole job, which is then identical to ResponseTable::Write
+// of the job in one process (Value i of a dataset does not depend on the
+// range it is generated with).
+//
+// Jobs and shards are saved as short text files:
+//
+//   DigitalFiltersJob 1
+//   fs 48000
+//   layout 0                      (ResponseTable::Layout)
+//   grid 3 10 24000 0 100000      (distribution, a, b, seed, size)
+//   filters 2 3 3                 (count, numerator and denominator lengths)
+//   <coefficients of filter 0>    (numerator then denominator)
+//   <coefficients of filter 1>
+//   shard 1 4 0 2 50000 100000    (shards only: index, count, filters
+//                                  [first, last), frequencies [first, last))
+//
+// with numbers written with enough digits to read back exactly.
+
+namespace DigitalFilters::Sharding
+{
+	struct Job
+	{
+		ResponseTable::FilterSet filters;
+		Datasets::Dataset grid;
+		double fs = 48000;
+		ResponseTable::Layout layout = ResponseTable::Layout::Complex;
+	};
+
+	struct Shard
+	{
+		Job job;
+		size_t index = 0;
+		size_t count = 1;
+		size_t firstFilter = 0;
+		size_t lastFilter = 0;
+		size_t firstFrequency = 0;
+		size_t lastFrequency = 0;
+
+		// The filters of the shard.
+		ResponseTable::FilterSet Filters() const
+		{
+			ResponseTable::FilterSet filters( job.filters.NumeratorLength(), job.filters.DenominatorLength() );
+			for (size_t f = firstFilter; f < lastFilter; f++)
+			{
+				filters.Add( job.filters.Numerator( f ), job.filters.Denominator( f ) );
+			}
+			return filters;
+		}
+
+		// The frequencies of the shard.
+		std::vector<double> Frequencies() const
+		{
+			std::vector<double> frequencies( lastFrequency - firstFrequency );
+			Datasets::Fill<double>( job.grid, firstFrequency, frequencies );
+			return frequencies;
+		}
+	};
+
+	// Splits job into count shards of as equal sizes as possible.
+	inline std::vector<Shard> Split( const Job& job, size_t count )
+	{
+		if (count == 0)
+		{
+			throw std::invalid_argument( "The shard count must be positive." );
+		}
+
+		const size_t filters = job.filters.Size();
+		const size_t frequencies = job.grid.size;
+		const bool byFilter = filters >= count;
+		const size_t extent = byFilter ? filters : frequencies;
+
+		std::vector<Shard> shards( count );
+		for (size_t s = 0; s < count; s++)
+		{
+			Shard& shard = shards[s];
+			shard.job = job;
+			shard.index = s;
+			shard.count = count;
+
+			const size_t first = extent * s / count, last = extent * (s + 1) / count;
+			shard.firstFilter = byFilter ? first : 0;
+			shard.lastFilter = byFilter ? last : filters;
+			shard.firstFrequency = byFilter ? 0 : first;
+			shard.lastFrequency = byFilter ? frequencies : last;
+		}
+		return shards;
+	}
+
+	// Evaluates shard into a response table at output.
+	inline void Run( const Shard& shard, const std::filesystem::path& output,
+		const ResponseTable::WriteSettings& settings = {} )
+	{
+		ResponseTable::WriteSettings shardSettings = settings;
+		shardSettings.layout = shard.job.layout;
+		ResponseTable::Write( output, shard.Filters(), shard.Frequencies(), shard.job.fs, shardSettings );
+	}
+
+	namespace Detail
+	{
+		constexpr const char* Signature = "DigitalFiltersJob";
+		constexpr int FormatVersion = 1;
+
+		inline void SaveJob( std::ostream& out, const Job& job )
+		{
+			out.precision( std::numeric_limits<double>::max_digits10 );
+			out << Signature << ' ' << FormatVersion << '\n'
+				<< "fs " << job.fs << '\n'
+				<< "layout " << static_cast<uint32_t>(job.layout) << '\n'
+				<< "grid " << static_cast<int>(job.grid.distribution) << ' ' << job.grid.a << ' ' << job.grid.b
+				<< ' ' << job.grid.seed << ' ' << job.grid.size << '\n'
+				<< "filters " << job.filters.Size() << ' ' << job.filters.NumeratorLength() << ' '
+				<< job.filters.DenominatorLength() << '\n';
+
+			for (size_t f = 0; f < job.filters.Size(); f++)
+			{
+				const char* separator = "";
+				for (std::span<const double> part : { job.filters.Numerator( f ), job.filters.Denominator( f ) })
+				{
+					for (double coefficient : part)
+					{
+						out << separator << coefficient;
+						separator = " ";
+					}
+				}
+				out << '\n';
+			}
+		}
+
+		inline void Expect( std::istream& in, const char* key )
+		{
+			std::string word;
+			if (!(in >> word) || word != key)
+			{
+				throw std::runtime_error( std::string( "Bad job descriptor: expected " ) + key + "." );
+			}
+		}
+
+		template <typename T>
+		T Read( std::istream& in )
+		{
+			T value{};
+			if (!(in >> value))
+			{
+				throw std::runtime_error( "Bad job descriptor: unreadable value." );
+			}
+			return value;
+		}
+
+		inline Job LoadJob( std::istream& in )
+		{
+			Expect( in, Signature );
+			if (Read<int>( in ) != FormatVersion)
+			{
+				throw std::runtime_error( "Bad job descriptor: unsupported version." );
+			}
+
+			Job job;
+			Expect( in, "fs" );
+			job.fs = Read<double>( in );
+			Expect( in, "layout" );
+			const uint32_t layout = Read<uint32_t>( in );
+			if (layout > static_cast<uint32_t>(ResponseTable::Layout::MagnitudePhase))
+			{
+				throw std::runtime_error( "Bad job descriptor: unknown layout." );
+			}
+			job.layout = static_cast<ResponseTable::Layout>(layout);
+
+			Expect( in, "grid" );
+			const int distribution = Read<int>( in );
+			if (distribution < 0 || distribution > static_cast<int>(Datasets::Distribution::LogSweep))
+			{
+				throw std::runtime_error( "Bad job descriptor: unknown grid distribution." );
+			}
+			job.grid.distribution = static_cast<Datasets::Distribution>(distribution);
+			job.grid.a = Read<double>( in );
+			job.grid.b = Read<double>( in );
+			job.grid.seed = Read<uint64_t>( in );
+			job.grid.size = Read<size_t>( in );
+
+			Expect( in, "filters" );
+			const size_t count = Read<size_t>( in );
+			const size_t numeratorLength = Read<size_t>( in );
+			const size_t denominatorLength = Read<size_t>( in );
+			job.filters = ResponseTable::FilterSet( numeratorLength, denominatorLength );
+
+			std::vector<double> zeros( numeratorLength ), poles( denominatorLength );
+			for (size_t f = 0; f < count; f++)
+			{
+				for (double& coefficient : zeros)
+				{
+					coefficient = Read<double>( in );
+				}
+				for (double& coefficient : poles)
+				{
+					coefficient = Read<double>( in );
+				}
+				job.filters.Add( zeros, poles );
+			}
+			return job;
+		}
+
+		inline std::ofstream OpenOutput( const std::filesystem::path& path )
+		{
+			std::ofstream out( path );
+			if (!out)
+			{
+				throw std::runtime_error( "Cannot write " + path.string() );
+			}
+			return out;
+		}
+
+		inline std::ifstream OpenInput( const std::filesystem::path& path )
+		{
+			std::ifstream in( path );
+			if (!in)
+			{
+				throw std::runtime_error( "Cannot read " + path.string() );
+			}
+			return in;
+		}
+
+		// Copies bytes of source to offset of target, mapping at most
+		// windowBytes of the target at once.
+		inline void Copy( const std::byte* source, uint64_t bytes, const MappedFile& target, uint64_t offset,
+			uint64_t windowBytes )
+		{
+			for (uint64_t done = 0; done < bytes; done += windowBytes)
+			{
+				const uint64_t length = std::min( windowBytes, bytes - done );
+				MappedView view = target.Map( offset + done, length );
+				std::memcpy( view.data(), source + done, static_cast<size_t>(length) );
+			}
+		}
+	}
+
+	inline void Save( const Job& job, const std::filesystem::path& path )
+	{
+		std::ofstream out = Detail::OpenOutput( path );
+		Detail::SaveJob( out, job );
+	}
+
+	inline void Save( const Shard& shard, const std::filesystem::path& path )
+	{
+		std::ofstream out = Detail::OpenOutput( path );
+		Detail::SaveJob( out, shard.job );
+		out << "shard " << shard.index << ' ' << shard.count << ' ' << shard.firstFilter << ' '
+			<< shard.lastFilter << ' ' << shard.firstFrequency << ' ' << shard.lastFrequency << '\n';
+	}
+
+	inline Job LoadJob( const std::filesystem::path& path )
+	{
+		std::ifstream in = Detail::OpenInput( path );
+		return Detail::LoadJob( in );
+	}
+
+	inline Shard LoadShard( const std::filesystem::path& path )
+	{
+		std::ifstream in = Detail::OpenInput( path );
+		Shard shard;
+		shard.job = Detail::LoadJob( in );
+		Detail::Expect( in, "shard" );
+		shard.index = Detail::Read<size_t>( in );
+		shard.count = Detail::Read<size_t>( in );
+		shard.firstFilter = Detail::Read<size_t>( in );
+		shard.lastFilter = Detail::Read<size_t>( in );
+		shard.firstFrequency = Detail::Read<size_t>( in );
+		shard.lastFrequency = Detail::Read<size_t>( in );
+
+		if (shard.index >= shard.count || shard.firstFilter > shard.lastFilter
+			|| shard.lastFilter > shard.job.filters.Size() || shard.firstFrequency > shard.lastFrequency
+			|| shard.lastFrequency > shard.job.grid.size)
+		{
+			throw std::runtime_error( "Bad shard descriptor: ranges outside the job." );
+		}
+		return shard;
+	}
+
+	// Checks that shardFiles[i] is the output of shard i of Split( job,
+	// shardFiles.size() ) and merges them into the table of job at output.
+	// Throws std::runtime_error naming the first shard file that does not
+	// match.
+	inline void Merge( const Job& job, std::span<const std::filesystem::path> shardFiles,
+		const std::filesystem::path& output, uint64_t windowBytes = uint64_t( 64 ) << 20 )
+	{
+		if (windowBytes == 0)
+		{
+			throw std::invalid_argument( "windowBytes must be positive." );
+		}
+
+		const std::vector<Shard> shards = Split( job, shardFiles.size() );
+		const std::vector<double> frequencies = Datasets::Generate<double>( job.grid );
+		const ResponseTable::Header header = ResponseTable::Detail::MakeHeader( job.filters.Size(),
+			frequencies.size(), job.filters.NumeratorLength(), job.filters.DenominatorLength(), job.fs,
+			job.layout );
+
+		MappedFile file = MappedFile::Create( output, header.fileSize );
+		Detail::Copy( reinterpret_cast<const std::byte*>(frequencies.data()), frequencies.size() * sizeof( double ), file,
+			header.frequenciesOffset, windowBytes );
+		Detail::Copy( reinterpret_cast<const std::byte*>(job.filters.Coefficients().data()),
+			job.filters.Coefficients().size() * sizeof( double ), file, header.coefficientsOffset, windowBytes );
+
+		const uint64_t frequencyCount = frequencies.size();
+		for (size_t s = 0; s < shards.size(); s++)
+		{
+			const Shard& shard = shards[s];
+			const ResponseTable::Table table( shardFiles[s] );
+			const std::string name = shardFiles[s].string();
+
+			const std::span<const double> shardFrequencies = std::span<const double>( frequencies )
+				.subspan( shard.firstFrequency, shard.lastFrequency - shard.firstFrequency );
+			bool matches = table.GetLayout() == job.layout && table.Fs() == job.fs
+				&& table.FilterCount() == shard.lastFilter - shard.firstFilter
+				&& table.GetHeader().numeratorLength == job.filters.NumeratorLength()
+				&& table.GetHeader().denominatorLength == job.filters.DenominatorLength()
+				&& std::ranges::equal( table.Frequencies(), shardFrequencies );
+			for (size_t f = 0; matches && f < table.FilterCount(); f++)
+			{
+				matches = std::ranges::equal( table.Numerator( f ), job.filters.Numerator( shard.firstFilter + f ) )
+					&& std::ranges::equal( table.Denominator( f ), job.filters.Denominator( shard.firstFilter + f ) );
+			}
+			if (!matches)
+			{
+				throw std::runtime_error( "Shard file " + name + " is not the output of shard "
+					+ std::to_string( s ) + " of " + std::to_string( shards.size() ) + "." );
+			}
+
+			// Row segments of the shard, into every array of the layout.
+			for (size_t f = 0; f < table.FilterCount(); f++)
+			{
+				const uint64_t first = (shard.firstFilter + f) * frequencyCount + shard.firstFrequency;
+				if (job.layout == ResponseTable::Layout::Complex)
+				{
+					const std::span<const std::byte> row = std::as_bytes( table.Response( f ) );
+					Detail::Copy( row.data(), row.size(), file,
+						header.dataOffset + first * sizeof( std::complex<double> ), windowBytes );
+				}
+				else
+				{
+					const std::span<const std::byte> magnitude = std::as_bytes( table.Magnitude( f ) );
+					const std::span<const std::byte> phase = std::as_bytes( table.Phase( f ) );
+					Detail::Copy( magnitude.data(), magnitude.size(), file,
+						header.dataOffset + first * sizeof( double ), windowBytes );
+					Detail::Copy( phase.data(), phase.size(), file,
+						header.phaseOffset + first * sizeof( double ), windowBytes );
+				}
+			}
+		}
+
+		MappedView headerView = file.Map( 0, sizeof( ResponseTable::Header ) );
+		std::memcpy( headerView.data(), &header, sizeof( ResponseTable::Header ) );
+		headerView.Flush();
+	}
+}
@@ -1,15 +1,464 @@
 #pragma once
 #include <type_traits>
 #include <complex>
+#include <cmath>
+#include <limits>
+#include "Constants.h"
 
 namespace DigitalFilters::Utils
 {
+		namespace Detail
+		{
+			// Series based implementations used when a design function is
+			// evaluated in a constant expression. The standard <cmath> functions
+			// are not usable at compile time, so these trade speed for being
+			// constexpr while staying within a few ULP of the library versions.
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprAbs( T x )
+			{
+				return x < static_cast<T>(0) ? -x : x;
+			}
+
+			// Splits a constant into three parts of digits/2 bits each, so that
+			// k * hi and k * mid are exact for the small k of a range reduction
+			// (Cody-Waite).
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr void ConstexprSplitConstant( long double value,
+				T& hi, T& mid, T& lo )
+			{
+				constexpr int bits = std::numeric_limits<T>::digits / 2;
+
+				auto truncate = []( long double v ) constexpr
+				{
+					if (v == 0)
+					{
+						return v;
+					}
+
+					long double scale = 1;
+					long double magnitude = v < 0 ? -v : v;
+					while (magnitude * scale < (1LL << bits))
+					{
+						scale *= 2;
+					}
+					while (magnitude * scale >= (2LL << bits))
+					{
+						scale /= 2;
+					}
+					return static_cast<long double>(
+						static_cast<long long>(v * scale) ) / scale;
+				};
+
+				const long double hiPart = truncate( value );
+				const long double midPart = truncate( value - hiPart );
+
+				hi = static_cast<T>(hiPart);
+				mid = static_cast<T>(midPart);
+				lo = static_cast<T>(value - hiPart - midPart);
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprSqrt( T x )
+			{
+				if (x != x || x < static_cast<T>(0))
+				{
+					return std::numeric_limits<T>::quiet_NaN();
+				}
+
+				if (x == static_cast<T>(0) || x == std::numeric_limits<T>::infinity())
+				{
+					return x;
+				}
+
+				// Reduce x to [0.25, 4] scaling by exact powers of two.
+				T scale = 1;
+				while (x > static_cast<T>(65536))
+				{
+					x /= static_cast<T>(65536);
+					scale *= static_cast<T>(256);
+				}
+				while (x > static_cast<T>(4))
+				{
+					x /= static_cast<T>(4);
+					scale *= static_cast<T>(2);
+				}
+				while (x < static_cast<T>(1) / static_cast<T>(65536))
+				{
+					x *= static_cast<T>(65536);
+					scale /= static_cast<T>(256);
+				}
+				while (x < static_cast<T>(0.25))
+				{
+					x *= static_cast<T>(4);
+					scale /= static_cast<T>(2);
+				}
+
+				// Newton-Raphson, quadratic convergence from 1 on [0.25, 4].
+				T root = 1;
+				for (int idx = 0; idx < 8; idx++)
+				{
+					root = (root + x / root) / static_cast<T>(2);
+				}
+
+				return root * scale;
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprExp( T x )
+			{
+				if (x != x)
+				{
+					return x;
+				}
+
+				if (x > static_cast<T>(std::numeric_limits<T>::max_exponent)
+					* Constants::ln2<T>())
+				{
+					return std::numeric_limits<T>::infinity();
+				}
+
+				if (x < static_cast<T>(std::numeric_limits<T>::min_exponent
+					- std::numeric_limits<T>::digits) * Constants::ln2<T>())
+				{
+					return static_cast<T>(0);
+				}
+
+				// x = k * ln2 + r, |r| <= ln2 / 2.
+				T ln2Hi = 0, ln2Mid = 0, ln2Lo = 0;
+				ConstexprSplitConstant( Constants::ln2_ld, ln2Hi, ln2Mid, ln2Lo );
+
+				T kReal = x * Constants::log2e<T>();
+				long long k = static_cast<long long>(
+					kReal < 0 ? kReal - static_cast<T>(0.5) : kReal + static_cast<T>(0.5) );
+
+				const T kT = static_cast<T>(k);
+				T r = ((x - kT * ln2Hi) - kT * ln2Mid) - kT * ln2Lo;
+
+				T sum = 1;
+				T term = 1;
+				for (int n = 1; n < 40; n++)
+				{
+					term *= r / static_cast<T>(n);
+					sum += term;
+					if (ConstexprAbs( term ) <= std::numeric_limits<T>::epsilon()
+						* ConstexprAbs( sum ) / 4)
+					{
+						break;
+					}
+				}
+
+				for (; k > 0; k--)
+				{
+					sum *= static_cast<T>(2);
+				}
+				for (; k < 0; k++)
+				{
+					sum /= static_cast<T>(2);
+				}
+
+				return sum;
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprLog( T x )
+			{
+				if (x != x || x < static_cast<T>(0))
+				{
+					return std::numeric_limits<T>::quiet_NaN();
+				}
+
+				if (x == static_cast<T>(0))
+				{
+					return -std::numeric_limits<T>::infinity();
+				}
+
+				if (x == std::numeric_limits<T>::infinity())
+				{
+					return x;
+				}
+
+				// x = m * 2^k, m in [1/sqrt2, sqrt2].
+				long long k = 0;
+				while (x > static_cast<T>(65536))
+				{
+					x /= static_cast<T>(65536);
+					k += 16;
+				}
+				while (x < static_cast<T>(1) / static_cast<T>(65536))
+				{
+					x *= static_cast<T>(65536);
+					k -= 16;
+				}
+				while (x > Constants::sqrt2<T>())
+				{
+					x /= static_cast<T>(2);
+					k++;
+				}
+				while (x < Constants::one_over_sqrt2<T>())
+				{
+					x *= static_cast<T>(2);
+					k--;
+				}
+
+				// log(m) = 2 * atanh(s), s = (m - 1) / (m + 1), |s| < 0.172.
+				const T s = (x - static_cast<T>(1)) / (x + static_cast<T>(1));
+				const T s2 = s * s;
+				T power = s;
+				T sum = 0;
+				for (int n = 1; n < 80; n += 2)
+				{
+					T term = power / static_cast<T>(n);
+					sum += term;
+					if (ConstexprAbs( term ) <= std::numeric_limits<T>::epsilon()
+						* ConstexprAbs( sum ) / 4)
+					{
+						break;
+					}
+					power *= s2;
+				}
+
+				T ln2Hi = 0, ln2Mid = 0, ln2Lo = 0;
+				ConstexprSplitConstant( Constants::ln2_ld, ln2Hi, ln2Mid, ln2Lo );
+
+				const T kT = static_cast<T>(k);
+				return kT * ln2Hi
+					+ (kT * ln2Mid + (static_cast<T>(2) * sum + kT * ln2Lo));
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprPow( T base, T exponent )
+			{
+				if (exponent == static_cast<T>(0))
+				{
+					return static_cast<T>(1);
+				}
+
+				if (base == static_cast<T>(0))
+				{
+					return exponent > static_cast<T>(0)
+						? static_cast<T>(0)
+						: std::numeric_limits<T>::infinity();
+				}
+
+				if (base < static_cast<T>(0))
+				{
+					const long long integral = static_cast<long long>(exponent);
+					if (static_cast<T>(integral) != exponent)
+					{
+						return std::numeric_limits<T>::quiet_NaN();
+					}
+
+					const T magnitude = ConstexprExp( exponent * ConstexprLog( -base ) );
+					return (integral & 1) ? -magnitude : magnitude;
+				}
+
+				return ConstexprExp( exponent * ConstexprLog( base ) );
+			}
+
+			// Reduces x to r in [-pi/4, pi/4] and returns the quadrant
+			// (x = r + quadrant * pi/2).
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr int ConstexprReduceQuadrant( T x, T& r )
+			{
+				T piOver2Hi = 0, piOver2Mid = 0, piOver2Lo = 0;
+				ConstexprSplitConstant( Constants::pi_ld / 2,
+					piOver2Hi, piOver2Mid, piOver2Lo );
+
+				T kReal = x * static_cast<T>(2) * Constants::one_over_pi<T>();
+				long long k = static_cast<long long>(
+					kReal < 0 ? kReal - static_cast<T>(0.5) : kReal + static_cast<T>(0.5) );
+
+				const T kT = static_cast<T>(k);
+				r = ((x - kT * piOver2Hi) - kT * piOver2Mid) - kT * piOver2Lo;
+
+				return static_cast<int>(((k % 4) + 4) % 4);
+			}
+
+			// Taylor series for sin(r) and cos(r), |r| <= pi/4.
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr void ConstexprSinCosKernel( T r, T& sinR, T& cosR )
+			{
+				const T r2 = r * r;
+
+				T term = r;
+				sinR = r;
+				for (int n = 2; n < 40; n += 2)
+				{
+					term *= -r2 / static_cast<T>(n * (n + 1));
+					sinR += term;
+				}
+
+				term = 1;
+				cosR = 1;
+				for (int n = 1; n < 40; n += 2)
+				{
+					term *= -r2 / static_cast<T>(n * (n + 1));
+					cosR += term;
+				}
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprSin( T x )
+			{
+				T r = 0, s = 0, c = 0;
+				int quadrant = ConstexprReduceQuadrant( x, r );
+				ConstexprSinCosKernel( r, s, c );
+
+				switch (quadrant)
+				{
+				case 0: return s;
+				case 1: return c;
+				case 2: return -s;
+				default: return -c;
+				}
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprCos( T x )
+			{
+				T r = 0, s = 0, c = 0;
+				int quadrant = ConstexprReduceQuadrant( x, r );
+				ConstexprSinCosKernel( r, s, c );
+
+				switch (quadrant)
+				{
+				case 0: return c;
+				case 1: return -s;
+				case 2: return -c;
+				default: return s;
+				}
+			}
+
+			template <typename T>
+				requires std::is_floating_point_v<T>
+			constexpr T ConstexprTan( T x )
+			{
+				T r = 0, s = 0, c = 0;
+				int quadrant = ConstexprReduceQuadrant( x, r );
+				ConstexprSinCosKernel( r, s, c );
+
+				return (quadrant & 1) ? -c / s : s / c;
+			}
+		}
+
+		// Math wrappers usable from constant expressions. At runtime they forward
+		// to <cmath>, so non-constexpr callers get bit identical results. The
+		// constant path is evaluated in long double and rounded once to T.
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Abs( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return Detail::ConstexprAbs( x );
+			}
+			return std::abs( x );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Sqrt( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprSqrt( static_cast<long double>(x) ) );
+			}
+			return std::sqrt( x );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Exp( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprExp( static_cast<long double>(x) ) );
+			}
+			return std::exp( x );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Log10( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprLog( static_cast<long double>(x) )
+					* Constants::log10e<long double>() );
+			}
+			return std::log10( x );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Pow( T base, T exponent )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprPow( static_cast<long double>(base),
+						static_cast<long double>(exponent) ) );
+			}
+			return std::pow( base, exponent );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Sin( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprSin( static_cast<long double>(x) ) );
+			}
+			return std::sin( x );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Cos( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprCos( static_cast<long double>(x) ) );
+			}
+			return std::cos( x );
+		}
+
+		template <typename T>
+			requires std::is_floating_point_v<T>
+		constexpr T Tan( T x )
+		{
+			if (std::is_constant_evaluated())
+			{
+				return static_cast<T>(
+					Detail::ConstexprTan( static_cast<long double>(x) ) );
+			}
+			return std::tan( x );
+		}
+
 		template <typename T>
 			requires std::is_floating_point_v<T>
 		constexpr  T DecibelToLinearGain( T dB )
 		{
-			return std::pow( static_cast <T>(10.0),
-				std::abs( dB ) / static_cast <T>(20.0) );
+			return Pow( static_cast <T>(10.0),
+				Abs( dB ) / static_cast <T>(20.0) );
 		}
 
 		// Pre-warps the cutoff frequency for analog to digital filter transform
@@ -18,7 +467,7 @@ namespace DigitalFilters::Utils
 			requires std::is_floating_point_v<T>
 		constexpr T PrewarpFrequency( T cutoffFrequencyHz, T samplingFrequencyHz )
 		{
-			return std::tan(
+			return Tan(
 				Constants::pi<T>() * cutoffFrequencyHz / samplingFrequencyHz
 			);
 		}
@@ -28,7 +477,7 @@ namespace DigitalFilters::Utils
 			requires std::is_floating_point_v<T>
 		constexpr T GainTodB( T magnitude )
 		{
-			return static_cast<T>(20.0) * std::log10( magnitude );
+			return static_cast<T>(20.0) * Log10( magnitude );
 		}
 
 		// Converts a frequency from Hertz (Hz) to angular frequency (omega, ?)